@@ -0,0 +1,495 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "global.h"
+#include "allpass.h"
+#include "bitcrusher.h"
+#include "comb.h"
+#include "decimator.h"
+#include "filter.h"
+#include "limiter.h"
+#include "paramids.h"
+#include "pluginstate.h"
+#include "processmodel.h"
+#include "reverbprocess.h"
+#include "kernels/kernels.h"
+#include <chrono>
+#include <functional>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace Igorski;
+
+/**
+ * fogpad_bench measures the processing cost (in nanoseconds per sample, where a sample is a
+ * single value of a single channel) of each DSP unit and of the complete ReverbProcess, for a
+ * range of block sizes and channel amounts. The results are written to stdout as JSON.
+ *
+ * Each measurement is warmed up and then repeated in batches until a minimum duration has
+ * elapsed, reporting both the mean and the fastest batch (the latter being less susceptible
+ * to interference by other processes).
+ */
+
+static const int BLOCK_SIZES[]  = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+static const int CHANNELS[]     = { 1, 2, 6 };
+static const int MAX_BLOCK_SIZE = 4096;
+static const int WARMUP_BLOCKS  = 16;
+
+struct Result {
+    std::string unit;
+    std::string mode;
+    const char* precision;
+    int blockSize;
+    int channels;
+    double nsPerSample;
+    double bestNsPerSample;
+    long blocks;
+};
+
+struct Settings {
+    double minTimeMs = 25.0;
+    std::string filter;
+    std::string isa;
+};
+
+static Settings settings;
+static std::vector<Result> results;
+static volatile float sink; // prevents the measured output from being optimized away
+
+// signal buffers, filled with noise so no processing path runs on silence (e.g. denormals)
+
+static std::vector<float>  floatMemory;
+static std::vector<double> doubleMemory;
+
+static void fillNoise()
+{
+    floatMemory.resize(( size_t ) VST::MAX_CHANNELS * MAX_BLOCK_SIZE * 2 );
+    doubleMemory.resize( floatMemory.size() );
+
+    srand( 1 );
+    for ( size_t i = 0; i < floatMemory.size(); ++i ) {
+        floatMemory[ i ]  = ( float ) rand() / RAND_MAX - .5f;
+        doubleMemory[ i ] = floatMemory[ i ];
+    }
+}
+
+template <typename SampleType>
+static void getBuffers( std::vector<SampleType>& memory, SampleType** in, SampleType** out )
+{
+    for ( int c = 0; c < VST::MAX_CHANNELS; ++c ) {
+        in [ c ] = &memory[( size_t ) c * MAX_BLOCK_SIZE ];
+        out[ c ] = &memory[( size_t )( VST::MAX_CHANNELS + c ) * MAX_BLOCK_SIZE ];
+    }
+}
+
+static bool isSelected( const std::string& unit )
+{
+    return settings.filter.empty() || unit.find( settings.filter ) != std::string::npos;
+}
+
+// invokes given function (processing a single block) repeatedly and records its cost per sample
+
+static void measure( const std::string& unit, const std::string& mode, const char* precision,
+                     int blockSize, int channels, const std::function<void()>& processBlock )
+{
+    typedef std::chrono::steady_clock Clock;
+
+    for ( int i = 0; i < WARMUP_BLOCKS; ++i )
+        processBlock();
+
+    // batches span roughly a millisecond of processing so the clock overhead is negligible
+
+    long batchSize = std::max( 1L, ( long )( 65536 / ( blockSize * channels )));
+    long blocks    = 0;
+    double totalNs = 0.0;
+    double bestNs  = 1e300;
+
+    while ( totalNs < settings.minTimeMs * 1e6 )
+    {
+        auto start = Clock::now();
+
+        for ( long i = 0; i < batchSize; ++i )
+            processBlock();
+
+        double elapsed = std::chrono::duration<double, std::nano>( Clock::now() - start ).count();
+
+        totalNs += elapsed;
+        blocks  += batchSize;
+        bestNs   = std::min( bestNs, elapsed / batchSize );
+    }
+    double samplesPerBlock = ( double ) blockSize * channels;
+
+    results.push_back({ unit, mode, precision, blockSize, channels,
+                        totalNs / ( blocks * samplesPerBlock ), bestNs / samplesPerBlock, blocks });
+
+    fprintf( stderr, "%-14s %-10s %-6s block %4d channels %d: %8.3f ns/sample\n",
+             unit.c_str(), mode.c_str(), precision, blockSize, channels, results.back().nsPerSample );
+}
+
+/* unit benchmarks */
+
+static void benchCombs()
+{
+    if ( !isSelected( "comb" ))
+        return;
+
+    float* in[ VST::MAX_CHANNELS ], *out[ VST::MAX_CHANNELS ];
+    getBuffers( floatMemory, in, out );
+
+    for ( int channels : CHANNELS ) {
+        std::vector<Comb> combs( channels );
+        std::vector<std::vector<float>> memory( channels, std::vector<float>( VST::COMB_TUNINGS[ 0 ], 0.f ));
+
+        for ( int c = 0; c < channels; ++c ) {
+            combs[ c ].setBuffer( memory[ c ].data(), VST::COMB_TUNINGS[ 0 ] );
+            combs[ c ].setFeedback( .84f );
+            combs[ c ].setDamp( .2f );
+        }
+        for ( int blockSize : BLOCK_SIZES ) {
+            measure( "comb", "default", "float", blockSize, channels, [&]() {
+                for ( int c = 0; c < channels; ++c ) {
+                    for ( int i = 0; i < blockSize; ++i )
+                        out[ c ][ i ] = combs[ c ].process( in[ c ][ i ] );
+                }
+                sink = out[ 0 ][ 0 ];
+            });
+        }
+    }
+}
+
+static void benchAllPasses()
+{
+    if ( !isSelected( "allpass" ))
+        return;
+
+    float* in[ VST::MAX_CHANNELS ], *out[ VST::MAX_CHANNELS ];
+    getBuffers( floatMemory, in, out );
+
+    for ( int channels : CHANNELS ) {
+        std::vector<AllPass> allPasses( channels );
+        std::vector<std::vector<float>> memory( channels, std::vector<float>( VST::ALLPASS_TUNINGS[ 0 ], 0.f ));
+
+        for ( int c = 0; c < channels; ++c ) {
+            allPasses[ c ].setBuffer( memory[ c ].data(), VST::ALLPASS_TUNINGS[ 0 ] );
+            allPasses[ c ].setFeedback( .5f );
+        }
+        for ( int blockSize : BLOCK_SIZES ) {
+            measure( "allpass", "default", "float", blockSize, channels, [&]() {
+                for ( int c = 0; c < channels; ++c ) {
+                    for ( int i = 0; i < blockSize; ++i )
+                        out[ c ][ i ] = allPasses[ c ].process( in[ c ][ i ] );
+                }
+                sink = out[ 0 ][ 0 ];
+            });
+        }
+    }
+}
+
+// the reverb tank: the parallel combs followed by the serial allpasses (as in ReverbProcess::processBlock)
+
+static void benchTank()
+{
+    if ( !isSelected( "tank" ))
+        return;
+
+    float* in[ VST::MAX_CHANNELS ], *out[ VST::MAX_CHANNELS ];
+    getBuffers( floatMemory, in, out );
+
+    for ( int channels : CHANNELS ) {
+        std::vector<Comb> combs( channels * VST::NUM_COMBS );
+        std::vector<AllPass> allPasses( channels * VST::NUM_ALLPASSES );
+        std::vector<Comb*> combList;
+        std::vector<AllPass*> allPassList;
+        std::vector<std::vector<float>> memory;
+
+        for ( int c = 0; c < channels; ++c ) {
+            for ( int i = 0; i < VST::NUM_COMBS; ++i ) {
+                memory.emplace_back( VST::COMB_TUNINGS[ i ], 0.f );
+                combs[ c * VST::NUM_COMBS + i ].setBuffer( memory.back().data(), VST::COMB_TUNINGS[ i ] );
+                combs[ c * VST::NUM_COMBS + i ].setFeedback( .84f );
+                combs[ c * VST::NUM_COMBS + i ].setDamp( .2f );
+                combList.push_back( &combs[ c * VST::NUM_COMBS + i ] );
+            }
+            for ( int i = 0; i < VST::NUM_ALLPASSES; ++i ) {
+                memory.emplace_back( VST::ALLPASS_TUNINGS[ i ], 0.f );
+                allPasses[ c * VST::NUM_ALLPASSES + i ].setBuffer( memory.back().data(), VST::ALLPASS_TUNINGS[ i ] );
+                allPasses[ c * VST::NUM_ALLPASSES + i ].setFeedback( .5f );
+                allPassList.push_back( &allPasses[ c * VST::NUM_ALLPASSES + i ] );
+            }
+        }
+        for ( int blockSize : BLOCK_SIZES ) {
+            measure( "tank", "default", "float", blockSize, channels, [&]() {
+                for ( int c = 0; c < channels; ++c ) {
+                    for ( int i = 0; i < blockSize; ++i )
+                        out[ c ][ i ] = in[ c ][ i ] * .015f;
+
+                    Kernels::tank( &combList[ c * VST::NUM_COMBS ], &allPassList[ c * VST::NUM_ALLPASSES ], out[ c ], blockSize );
+                }
+                sink = out[ 0 ][ 0 ];
+            });
+        }
+    }
+}
+
+static void benchFilter()
+{
+    if ( !isSelected( "filter" ))
+        return;
+
+    float* in[ VST::MAX_CHANNELS ], *out[ VST::MAX_CHANNELS ];
+    getBuffers( floatMemory, in, out );
+
+    std::vector<float> lfoBuffer( MAX_BLOCK_SIZE );
+
+    const char* modes[] = { "static", "lfo", "lfo-eco" };
+
+    for ( int m = 0; m < 3; ++m ) {
+        for ( int channels : CHANNELS ) {
+            Filter filter;
+            filter.updateProperties( .5f, .5f, m == 0 ? 0.f : .5f, .5f );
+            filter.setQuality( m == 2 ? VST::QUALITY_ECO : VST::QUALITY_HIGH );
+
+            for ( int blockSize : BLOCK_SIZES ) {
+                measure( "filter", modes[ m ], "float", blockSize, channels, [&]() {
+                    filter.renderLFO( lfoBuffer.data(), blockSize );
+
+                    // the filter processes in place, process a copy so the input remains unaltered
+
+                    for ( int c = 0; c < channels; ++c ) {
+                        memcpy( out[ c ], in[ c ], blockSize * sizeof( float ));
+                        filter.process( out[ c ], blockSize, c );
+                    }
+                    sink = out[ 0 ][ 0 ];
+                });
+            }
+        }
+    }
+}
+
+static void benchBitCrusher()
+{
+    if ( !isSelected( "bitcrusher" ))
+        return;
+
+    float* in[ VST::MAX_CHANNELS ], *out[ VST::MAX_CHANNELS ];
+    getBuffers( floatMemory, in, out );
+
+    std::vector<float> lfoBuffer( MAX_BLOCK_SIZE );
+
+    const char* modes[] = { "static", "lfo" };
+
+    for ( int m = 0; m < 2; ++m ) {
+        for ( int channels : CHANNELS ) {
+            BitCrusher bitCrusher( .5f, .5f, .5f );
+            bitCrusher.setLFO( m == 0 ? 0.f : .3f, .5f );
+
+            for ( int blockSize : BLOCK_SIZES ) {
+                measure( "bitcrusher", modes[ m ], "float", blockSize, channels, [&]() {
+                    bitCrusher.renderLFO( lfoBuffer.data(), blockSize );
+
+                    for ( int c = 0; c < channels; ++c ) {
+                        memcpy( out[ c ], in[ c ], blockSize * sizeof( float ));
+                        bitCrusher.process( out[ c ], blockSize );
+                    }
+                    sink = out[ 0 ][ 0 ];
+                });
+            }
+        }
+    }
+}
+
+static void benchDecimator()
+{
+    if ( !isSelected( "decimator" ))
+        return;
+
+    float* in[ VST::MAX_CHANNELS ], *out[ VST::MAX_CHANNELS ];
+    getBuffers( floatMemory, in, out );
+
+    std::vector<int> holdIndices( MAX_BLOCK_SIZE );
+
+    for ( int channels : CHANNELS ) {
+        Decimator decimator( 16, .5f );
+
+        for ( int blockSize : BLOCK_SIZES ) {
+            measure( "decimator", "default", "float", blockSize, channels, [&]() {
+                decimator.prepare( holdIndices.data(), blockSize );
+
+                for ( int c = 0; c < channels; ++c ) {
+                    memcpy( out[ c ], in[ c ], blockSize * sizeof( float ));
+                    decimator.process( out[ c ], blockSize, c );
+                }
+                sink = out[ 0 ][ 0 ];
+            });
+        }
+    }
+}
+
+static void benchLimiter()
+{
+    if ( !isSelected( "limiter" ))
+        return;
+
+    float* in[ VST::MAX_CHANNELS ], *out[ VST::MAX_CHANNELS ];
+    getBuffers( floatMemory, in, out );
+
+    const char* modes[] = { "default", "lookahead" };
+
+    for ( int m = 0; m < 2; ++m ) {
+        for ( int channels : CHANNELS ) {
+            Limiter limiter( 10.f, 500.f, .6f );
+            limiter.setLookahead( m == 1 );
+
+            for ( int blockSize : BLOCK_SIZES ) {
+                measure( "limiter", modes[ m ], "float", blockSize, channels, [&]() {
+                    for ( int c = 0; c < channels; ++c )
+                        memcpy( out[ c ], in[ c ], blockSize * sizeof( float ));
+
+                    limiter.process<float>( out, blockSize, channels );
+                    sink = out[ 0 ][ 0 ];
+                });
+            }
+        }
+    }
+}
+
+// the complete process (using the default parameters of the plugin) in regular,
+// freeze and drift (altered playback rate, reading from the record buffer) modes
+
+template <typename SampleType>
+static void benchReverbProcess( std::vector<SampleType>& memory, const char* precision )
+{
+    if ( !isSelected( "reverbprocess" ))
+        return;
+
+    SampleType* in[ VST::MAX_CHANNELS ], *out[ VST::MAX_CHANNELS ];
+    getBuffers( memory, in, out );
+
+    const char* modes[] = { "default", "freeze", "drift" };
+
+    for ( int m = 0; m < 3; ++m ) {
+        for ( int channels : CHANNELS ) {
+            PluginState state;
+            state.setValue( kReverbFreezeId, m == 1 ? 1.f : 0.f );
+            state.setValue( kReverbPlaybackRateId, m == 2 ? .3f : .5f );
+
+            ReverbProcess process( channels, MAX_BLOCK_SIZE );
+            ProcessModel::apply( &process, state, VST::QUALITY_HIGH );
+
+            for ( int blockSize : BLOCK_SIZES ) {
+                measure( "reverbprocess", modes[ m ], precision, blockSize, channels, [&]() {
+                    process.process<SampleType>( in, out, channels, channels, blockSize );
+                    sink = ( float ) out[ 0 ][ 0 ];
+                });
+            }
+        }
+    }
+}
+
+// selects the kernels of given instruction set (the best supported when empty)
+
+static bool selectKernels( const std::string& name )
+{
+    if ( name.empty() ) {
+        Kernels::select();
+        return true;
+    }
+    int isa = 0;
+    while ( isa < Kernels::ISA_AMOUNT && name != Kernels::ISA_NAMES[ isa ] )
+        ++isa;
+
+    if ( isa < Kernels::ISA_AMOUNT && Kernels::select(( Kernels::ISA ) isa ))
+        return true;
+
+    fprintf( stderr, "instruction set \"%s\" is not supported\n", name.c_str() );
+    return false;
+}
+
+static void writeJSON()
+{
+    printf( "{\n" );
+    printf( "  \"benchmark\": \"fogpad_bench\",\n" );
+    printf( "  \"sample_rate\": %.0f,\n", VST::SAMPLE_RATE );
+    printf( "  \"kernels\": \"%s\",\n", Kernels::ISA_NAMES[ Kernels::getSelected() ] );
+    printf( "  \"min_time_ms\": %.1f,\n", settings.minTimeMs );
+    printf( "  \"results\": [\n" );
+
+    for ( size_t i = 0; i < results.size(); ++i ) {
+        const Result& result = results[ i ];
+        printf( "    { \"unit\": \"%s\", \"mode\": \"%s\", \"precision\": \"%s\", \"block_size\": %d, \"channels\": %d, "
+                "\"ns_per_sample\": %.4f, \"best_ns_per_sample\": %.4f, \"blocks\": %ld }%s\n",
+                result.unit.c_str(), result.mode.c_str(), result.precision, result.blockSize, result.channels,
+                result.nsPerSample, result.bestNsPerSample, result.blocks, ( i + 1 < results.size() ) ? "," : "" );
+    }
+    printf( "  ]\n}\n" );
+}
+
+int main( int argc, char** argv )
+{
+    for ( int i = 1; i < argc; ++i )
+    {
+        std::string argument = argv[ i ];
+        bool hasValue = ( i + 1 ) < argc;
+
+        if ( argument == "--filter" && hasValue )
+            settings.filter = argv[ ++i ];
+        else if ( argument == "--min-time" && hasValue )
+            settings.minTimeMs = std::max( 0.1, atof( argv[ ++i ] ));
+        else if ( argument == "--isa" && hasValue )
+            settings.isa = argv[ ++i ];
+        else {
+            fprintf( stderr,
+                "usage: fogpad_bench [--filter <unit>] [--min-time <ms>] [--isa <name>]\n\n"
+                "  --filter <unit>   only measures the units containing given name (comb, allpass, tank,\n"
+                "                    filter, bitcrusher, decimator, limiter, reverbprocess)\n"
+                "  --min-time <ms>   minimum duration of each measurement (default %.f)\n"
+                "  --isa <name>      measures the kernels of given instruction set (baseline, avx2 or avx512)\n"
+                "                    instead of the best instruction set supported by the CPU\n",
+                settings.minTimeMs
+            );
+            return 1;
+        }
+    }
+
+    if ( !selectKernels( settings.isa ))
+        return 1;
+
+    VST::SAMPLE_RATE = 44100.f;
+    fillNoise();
+
+    benchCombs();
+    benchAllPasses();
+    benchTank();
+    benchFilter();
+    benchBitCrusher();
+    benchDecimator();
+    benchLimiter();
+    benchReverbProcess<float>( floatMemory, "float" );
+    benchReverbProcess<double>( doubleMemory, "double" );
+
+    writeJSON();
+
+    return 0;
+}
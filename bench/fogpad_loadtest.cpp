@@ -0,0 +1,411 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "global.h"
+#include "paramids.h"
+#include "pluginstate.h"
+#include "processmodel.h"
+#include "reverbprocess.h"
+#include "kernels/kernels.h"
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace Igorski;
+
+/**
+ * fogpad_loadtest measures how the processing scales with the amount of plugin instances in
+ * a session. For each amount, the instances (each configured with different parameters and
+ * processing their own buffers) are processed round-robin, as a host would for each block.
+ * Reported are the throughput, the heap memory of each instance, the worst-case duration of
+ * a round (which has to complete within the duration of a block) and of a single instance
+ * block, and (where the platform allows) the L1 data and last level cache misses per frame.
+ * The results are written to stdout as JSON.
+ */
+
+static const int DEFAULT_BLOCK_SIZE   = 128;
+static const float DEFAULT_SECONDS    = 1.f;
+static const float SAMPLE_RATE        = 48000.f;
+static const int ALLOCATED_CHANNELS   = 6; // as allocated by FogPad::setupProcessing()
+static const int PROCESSED_CHANNELS   = 2;
+static const int WARMUP_ROUNDS        = 8;
+static const int DEFAULT_INSTANCES[]  = { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512 };
+
+// heap memory is measured by counting the allocations made while constructing an instance
+
+static size_t allocatedBytes = 0;
+
+void* operator new( size_t size )
+{
+    allocatedBytes += size;
+
+    void* pointer = malloc( size == 0 ? 1 : size );
+    if ( pointer == nullptr )
+        throw std::bad_alloc();
+
+    return pointer;
+}
+
+void* operator new[]( size_t size )
+{
+    return operator new( size );
+}
+
+void operator delete( void* pointer ) noexcept             { free( pointer ); }
+void operator delete[]( void* pointer ) noexcept           { free( pointer ); }
+void operator delete( void* pointer, size_t ) noexcept     { free( pointer ); }
+void operator delete[]( void* pointer, size_t ) noexcept   { free( pointer ); }
+
+/* cache miss counters */
+
+class CacheCounters {
+    public:
+        enum Counter {
+            L1D_MISSES = 0,
+            LLC_MISSES,
+            COUNTER_AMOUNT
+        };
+
+        CacheCounters()
+        {
+            for ( int i = 0; i < COUNTER_AMOUNT; ++i )
+                _descriptors[ i ] = -1;
+#ifdef __linux__
+            const uint64_t caches[ COUNTER_AMOUNT ] = { PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_LL };
+
+            for ( int i = 0; i < COUNTER_AMOUNT; ++i ) {
+                perf_event_attr attributes;
+                memset( &attributes, 0, sizeof( attributes ));
+
+                attributes.type           = PERF_TYPE_HW_CACHE;
+                attributes.size           = sizeof( attributes );
+                attributes.config         = caches[ i ] | ( PERF_COUNT_HW_CACHE_OP_READ << 8 ) |
+                                            ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 );
+                attributes.disabled       = 1;
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv     = 1;
+
+                _descriptors[ i ] = ( int ) syscall( __NR_perf_event_open, &attributes, 0, -1, -1, 0 );
+            }
+#endif
+        }
+
+        ~CacheCounters()
+        {
+#ifdef __linux__
+            for ( int i = 0; i < COUNTER_AMOUNT; ++i ) {
+                if ( _descriptors[ i ] >= 0 )
+                    close( _descriptors[ i ] );
+            }
+#endif
+        }
+
+        bool isAvailable( Counter counter ) const
+        {
+            return _descriptors[ counter ] >= 0;
+        }
+
+        void start()
+        {
+#ifdef __linux__
+            for ( int i = 0; i < COUNTER_AMOUNT; ++i ) {
+                if ( _descriptors[ i ] >= 0 ) {
+                    ioctl( _descriptors[ i ], PERF_EVENT_IOC_RESET, 0 );
+                    ioctl( _descriptors[ i ], PERF_EVENT_IOC_ENABLE, 0 );
+                }
+            }
+#endif
+        }
+
+        void stop()
+        {
+#ifdef __linux__
+            for ( int i = 0; i < COUNTER_AMOUNT; ++i ) {
+                if ( _descriptors[ i ] >= 0 )
+                    ioctl( _descriptors[ i ], PERF_EVENT_IOC_DISABLE, 0 );
+            }
+#endif
+        }
+
+        uint64_t read( Counter counter ) const
+        {
+            uint64_t value = 0;
+#ifdef __linux__
+            if ( _descriptors[ counter ] < 0 || ::read( _descriptors[ counter ], &value, sizeof( value )) != sizeof( value ))
+                return 0;
+#endif
+            return value;
+        }
+
+    private:
+        int _descriptors[ COUNTER_AMOUNT ];
+};
+
+/* load test */
+
+struct Instance {
+    ReverbProcess* process;
+    std::vector<float> memory; // the input and output buffers
+    float* in [ PROCESSED_CHANNELS ];
+    float* out[ PROCESSED_CHANNELS ];
+};
+
+struct Result {
+    int instances;
+    size_t memoryPerInstance;
+    double realtimeFactor;   // the amount of seconds of audio (of all instances) processed per second
+    double meanRoundUs;
+    double maxRoundUs;
+    double budgetUs;         // the duration of a block, in which a round has to complete
+    double maxInstanceUs;    // the longest duration of a single instance block
+    double l1dMissesPerFrame;
+    double llcMissesPerFrame;
+};
+
+struct Options {
+    int blockSize  = DEFAULT_BLOCK_SIZE;
+    float seconds  = DEFAULT_SECONDS;
+    std::vector<int> instances;
+};
+
+static uint32_t seed = 1;
+
+static inline float randomValue()
+{
+    seed = seed * 1664525u + 1013904223u;
+    return ( float )( seed >> 8 ) / 16777215.f;
+}
+
+// configures given process with random parameters (except for the bypass, as a bypassed
+// instance stops processing once its tail has faded out)
+
+static void randomize( ReverbProcess* process )
+{
+    const uint32_t parameters[] = {
+        kReverbSizeId, kReverbWidthId, kReverbDryMixId, kReverbWetMixId, kReverbFreezeId,
+        kReverbPlaybackRateId, kBitResolutionId, kBitResolutionChainId, kLFOBitResolutionId,
+        kLFOBitResolutionDepthId, kDecimatorId, kFilterCutoffId, kFilterResonanceId, kLFOFilterId,
+        kLFOFilterDepthId, kLFOFilterShapeId, kLFOBitResolutionShapeId, kLimiterLookaheadId
+    };
+    PluginState state;
+
+    for ( uint32_t paramId : parameters )
+        state.setValue( paramId, randomValue() );
+
+    // realtime processing defaults to the eco quality tier (see FogPad::getQuality())
+
+    ProcessModel::apply( process, state, VST::QUALITY_ECO );
+}
+
+static Result run( int amount, const Options& options )
+{
+    Result result;
+    result.instances = amount;
+
+    std::vector<Instance> instances( amount );
+
+    size_t before = allocatedBytes;
+
+    for ( Instance& instance : instances )
+        instance.process = new ReverbProcess( ALLOCATED_CHANNELS, options.blockSize );
+
+    result.memoryPerInstance = ( allocatedBytes - before ) / amount;
+
+    for ( Instance& instance : instances )
+    {
+        randomize( instance.process );
+
+        instance.memory.resize(( size_t ) PROCESSED_CHANNELS * 2 * options.blockSize );
+
+        for ( int c = 0; c < PROCESSED_CHANNELS; ++c ) {
+            instance.in [ c ] = &instance.memory[( size_t ) c * options.blockSize ];
+            instance.out[ c ] = &instance.memory[( size_t )( PROCESSED_CHANNELS + c ) * options.blockSize ];
+        }
+        for ( float& sample : instance.memory )
+            sample = randomValue() - .5f;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    typedef std::chrono::duration<double, std::micro> Microseconds;
+
+    int rounds = std::max( 1, ( int )( options.seconds * SAMPLE_RATE / options.blockSize ));
+    CacheCounters counters;
+
+    double totalUs       = 0.0;
+    result.maxRoundUs    = 0.0;
+    result.maxInstanceUs = 0.0;
+    result.budgetUs      = options.blockSize / SAMPLE_RATE * 1e6;
+
+    for ( int round = -WARMUP_ROUNDS; round < rounds; ++round )
+    {
+        if ( round == 0 )
+            counters.start();
+
+        Clock::time_point roundStart = Clock::now();
+        Clock::time_point blockStart = roundStart;
+
+        for ( Instance& instance : instances )
+        {
+            instance.process->process<float>( instance.in, instance.out, PROCESSED_CHANNELS, PROCESSED_CHANNELS,
+                                              options.blockSize );
+
+            Clock::time_point blockEnd = Clock::now();
+
+            if ( round >= 0 )
+                result.maxInstanceUs = std::max( result.maxInstanceUs, Microseconds( blockEnd - blockStart ).count() );
+
+            blockStart = blockEnd;
+        }
+
+        if ( round >= 0 ) {
+            double roundUs = Microseconds( blockStart - roundStart ).count();
+            totalUs += roundUs;
+            result.maxRoundUs = std::max( result.maxRoundUs, roundUs );
+        }
+    }
+    counters.stop();
+
+    double frames = ( double ) rounds * options.blockSize * amount;
+
+    result.meanRoundUs    = totalUs / rounds;
+    result.realtimeFactor = ( frames / SAMPLE_RATE ) / ( totalUs * 1e-6 );
+
+    result.l1dMissesPerFrame = counters.isAvailable( CacheCounters::L1D_MISSES ) ? counters.read( CacheCounters::L1D_MISSES ) / frames : -1.0;
+    result.llcMissesPerFrame = counters.isAvailable( CacheCounters::LLC_MISSES ) ? counters.read( CacheCounters::LLC_MISSES ) / frames : -1.0;
+
+    for ( Instance& instance : instances )
+        delete instance.process;
+
+    fprintf( stderr, "%4d instances: %8.1fx realtime, round %8.1f us (max %8.1f us, budget %.1f us), %zu bytes per instance\n",
+             amount, result.realtimeFactor, result.meanRoundUs, result.maxRoundUs, result.budgetUs, result.memoryPerInstance );
+
+    return result;
+}
+
+// unavailable counters are written as null
+
+static void writeCounter( const char* name, double value, const char* separator )
+{
+    if ( value < 0.0 )
+        printf( "\"%s\": null%s", name, separator );
+    else
+        printf( "\"%s\": %.4f%s", name, value, separator );
+}
+
+static void writeJSON( const Options& options, const std::vector<Result>& results )
+{
+    printf( "{\n" );
+    printf( "  \"benchmark\": \"fogpad_loadtest\",\n" );
+    printf( "  \"sample_rate\": %.0f,\n", SAMPLE_RATE );
+    printf( "  \"kernels\": \"%s\",\n", Kernels::ISA_NAMES[ Kernels::getSelected() ] );
+    printf( "  \"block_size\": %d,\n", options.blockSize );
+    printf( "  \"channels\": %d,\n", PROCESSED_CHANNELS );
+    printf( "  \"seconds\": %.2f,\n", options.seconds );
+    printf( "  \"results\": [\n" );
+
+    for ( size_t i = 0; i < results.size(); ++i ) {
+        const Result& result = results[ i ];
+        printf( "    { \"instances\": %d, \"memory_per_instance_bytes\": %zu, \"total_memory_bytes\": %zu, "
+                "\"realtime_factor\": %.2f, \"mean_round_us\": %.2f, \"max_round_us\": %.2f, \"budget_us\": %.2f, "
+                "\"max_round_load\": %.4f, \"max_instance_block_us\": %.2f, ",
+                result.instances, result.memoryPerInstance, result.memoryPerInstance * result.instances,
+                result.realtimeFactor, result.meanRoundUs, result.maxRoundUs, result.budgetUs,
+                result.maxRoundUs / result.budgetUs, result.maxInstanceUs );
+
+        writeCounter( "l1d_misses_per_frame", result.l1dMissesPerFrame, ", " );
+        writeCounter( "llc_misses_per_frame", result.llcMissesPerFrame, "" );
+
+        printf( " }%s\n", ( i + 1 < results.size() ) ? "," : "" );
+    }
+    printf( "  ]\n}\n" );
+}
+
+static bool parseInstances( const char* value, std::vector<int>& instances )
+{
+    char* end;
+
+    while ( *value != '\0' ) {
+        long amount = strtol( value, &end, 10 );
+
+        if ( end == value || amount < 1 || amount > 4096 )
+            return false;
+
+        instances.push_back(( int ) amount );
+        value = ( *end == ',' ) ? end + 1 : end;
+    }
+    return !instances.empty();
+}
+
+int main( int argc, char** argv )
+{
+    Options options;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        std::string argument = argv[ i ];
+        bool hasValue = ( i + 1 ) < argc;
+
+        if ( argument == "--instances" && hasValue && parseInstances( argv[ ++i ], options.instances ))
+            continue;
+        else if ( argument == "--block" && hasValue )
+            options.blockSize = std::max( 1, atoi( argv[ ++i ] ));
+        else if ( argument == "--seconds" && hasValue )
+            options.seconds = std::max( .01f, ( float ) atof( argv[ ++i ] ));
+        else {
+            fprintf( stderr,
+                "usage: fogpad_loadtest [--instances <amount,...>] [--block <frames>] [--seconds <seconds>]\n\n"
+                "  --instances <list>  comma separated amounts of instances (default 1,2,4 ... 512)\n"
+                "  --block <frames>    the block size (default %d)\n"
+                "  --seconds <value>   duration of the processed audio per instance (default %.1f)\n",
+                DEFAULT_BLOCK_SIZE, DEFAULT_SECONDS
+            );
+            return 1;
+        }
+    }
+
+    if ( options.instances.empty() )
+        options.instances.assign( std::begin( DEFAULT_INSTANCES ), std::end( DEFAULT_INSTANCES ));
+
+    VST::SAMPLE_RATE = SAMPLE_RATE;
+
+    Kernels::select();
+
+    std::vector<Result> results;
+
+    for ( int amount : options.instances )
+        results.push_back( run( amount, options ));
+
+    writeJSON( options, results );
+
+    return 0;
+}
@@ -26,31 +26,31 @@
 
  AllPass::AllPass()
  {
-     _bufIndex = 0;
+     _state.index = 0;
      setFeedback( 0.5f );
  }
 
  void AllPass::setBuffer( float *buf, int size )
  {
-     _buffer  = buf;
-     _bufSize = size;
+     _state.buffer = buf;
+     _state.size   = size;
  }
 
  void AllPass::mute()
  {
-     for ( int i = 0; i < _bufSize; i++ ) {
-         _buffer[ i ] = 0;
+     for ( int i = 0; i < _state.size; i++ ) {
+         _state.buffer[ i ] = 0;
      }
  }
 
  float AllPass::getFeedback()
  {
-     return _feedback;
+     return _state.feedback;
  }
 
  void AllPass::setFeedback( float val )
  {
-     _feedback = val;
+     _state.feedback = val;
  }
 
  }
@@ -26,37 +26,43 @@
 #include "global.h"
 #include "calc.h"
 
-using namespace Steinberg;
-
 namespace Igorski {
 class AllPass
 {
     public:
+        // the state of the filter, this is shared with the block
+        // processing kernels of the reverb tank (see kernels/kernels.h)
+
+        struct State {
+            float  feedback;
+            float* buffer;
+            int size;
+            int index;
+        };
+
         AllPass();
         void setBuffer( float *buf, int size );
         inline float process( float input )
         {
             float output;
-            float bufout = _buffer[ _bufIndex ];
+            float bufout = _state.buffer[ _state.index ];
             undenormalise( bufout );
 
             output = -input + bufout;
-            _buffer[ _bufIndex ] = input + ( bufout * _feedback );
+            _state.buffer[ _state.index ] = input + ( bufout * _state.feedback );
 
-            if ( ++_bufIndex >= _bufSize ) {
-                _bufIndex = 0;
+            if ( ++_state.index >= _state.size ) {
+                _state.index = 0;
             }
             return output;
         }
         void mute();
         float getFeedback();
         void setFeedback( float val );
+        State* getState() { return &_state; }
 
     private:
-        float  _feedback;
-        float* _buffer;
-        int _bufSize;
-        int _bufIndex;
+        State _state;
 };
 }
 #endif
@@ -21,7 +21,10 @@
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "audiobuffer.h"
+#include "simd.h"
 #include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 AudioBuffer::AudioBuffer( int aAmountOfChannels, int aBufferSize )
@@ -30,31 +33,38 @@ AudioBuffer::AudioBuffer( int aAmountOfChannels, int aBufferSize )
     amountOfChannels = aAmountOfChannels;
     bufferSize       = aBufferSize;
 
-    // create silent buffers for each channel
+    // pad each channel to a multiple of the alignment
 
-    _buffers = new std::vector<float*>( amountOfChannels );
+    const int samplesPerAlignment = ALIGNMENT / sizeof( float );
+    _stride = (( aBufferSize + samplesPerAlignment - 1 ) / samplesPerAlignment ) * samplesPerAlignment;
 
-    // fill buffers with silence
+    // create a single allocation for all channels, over-allocating
+    // so the start of the data can be aligned
 
-    for ( int i = 0; i < amountOfChannels; ++i ) {
-        _buffers->at( i ) = new float[ aBufferSize ];
-        memset( _buffers->at( i ), 0, aBufferSize * sizeof( float )); // zero bits should equal 0.f
-    }
+    size_t size = ( size_t ) amountOfChannels * _stride * sizeof( float );
+    _memory     = malloc( size + ALIGNMENT );
+    _data       = ( float* )((( uintptr_t ) _memory + ALIGNMENT - 1 ) & ~(( uintptr_t ) ALIGNMENT - 1 ));
+
+    // fill buffers (and padding) with silence, zero bits should equal 0.f
+
+    memset( _data, 0, size );
 }
 
 AudioBuffer::~AudioBuffer()
 {
-    while ( !_buffers->empty()) {
-        delete[] _buffers->back(), _buffers->pop_back();
-    }
-    delete _buffers;
+    free( _memory );
 }
 
 /* public methods */
 
 float* AudioBuffer::getBufferForChannel( int aChannelNum )
 {
-    return _buffers->at( aChannelNum );
+    return _data + ( aChannelNum * _stride );
+}
+
+int AudioBuffer::getStride()
+{
+    return _stride;
 }
 
 int AudioBuffer::mergeBuffers( AudioBuffer* aBuffer, int aReadOffset, int aWriteOffset, float aMixVolume )
@@ -75,6 +85,10 @@ int AudioBuffer::mergeBuffers( AudioBuffer* aBuffer, int aReadOffset, int aWrite
     int maxWriteOffset = aWriteOffset + writeLength;
     int c;
 
+#ifdef FOGPAD_SSE2
+    const __m128 volume = _mm_set1_ps( aMixVolume );
+#endif
+
     for ( c = 0; c < amountOfChannels; ++c )
     {
         if ( c > maxSourceChannel )
@@ -83,17 +97,37 @@ int AudioBuffer::mergeBuffers( AudioBuffer* aBuffer, int aReadOffset, int aWrite
         float* srcBuffer    = aBuffer->getBufferForChannel( c );
         float* targetBuffer = getBufferForChannel( c );
 
-        for ( int i = aWriteOffset, r = aReadOffset; i < maxWriteOffset; ++i, ++r )
+        int i = aWriteOffset;
+        int r = aReadOffset;
+
+        // mix in contiguous segments, each ending at the end of the
+        // write range or at the end of the source buffer
+
+        while ( i < maxWriteOffset )
         {
             if ( r >= sourceLength )
             {
-                if ( aBuffer->loopeable )
+                if ( aBuffer->loopeable && sourceLength > 0 )
                     r = 0;
                 else
                     break;
             }
-            targetBuffer[ i ] += ( srcBuffer[ r ] * aMixVolume );
-            ++writtenSamples;
+            int length = std::min( maxWriteOffset - i, sourceLength - r );
+
+            float* target       = targetBuffer + i;
+            const float* source = srcBuffer + r;
+            int j = 0;
+
+#ifdef FOGPAD_SSE2
+            for ( ; j + 4 <= length; j += 4 )
+                _mm_storeu_ps( target + j, _mm_add_ps( _mm_loadu_ps( target + j ), _mm_mul_ps( _mm_loadu_ps( source + j ), volume )));
+#endif
+            for ( ; j < length; ++j )
+                target[ j ] += ( source[ j ] * aMixVolume );
+
+            i += length;
+            r += length;
+            writtenSamples += length;
         }
     }
     // return the amount of samples written (per buffer)
@@ -106,32 +140,56 @@ int AudioBuffer::mergeBuffers( AudioBuffer* aBuffer, int aReadOffset, int aWrite
  */
 void AudioBuffer::silenceBuffers()
 {
-    // use mem set to quickly erase existing buffer contents, zero bits should equal 0.f
-    for ( int i = 0; i < amountOfChannels; ++i )
-        memset( getBufferForChannel( i ), 0, bufferSize * sizeof( float ));
+    // the channels are contiguous and can thus be erased at once, zero bits should equal 0.f
+    memset( _data, 0, ( size_t ) amountOfChannels * _stride * sizeof( float ));
 }
 
 void AudioBuffer::adjustBufferVolumes( float amp )
 {
-    for ( int i = 0; i < amountOfChannels; ++i )
-    {
-        float* buffer = getBufferForChannel( i );
+    // as the padding is silent, all channels can be processed as a single
+    // aligned buffer (in multiples of the alignment)
 
-        for ( int j = 0; j < bufferSize; ++j )
-            buffer[ j ] *= amp;
-    }
+    int length = amountOfChannels * _stride;
+    int i = 0;
+
+#ifdef FOGPAD_SSE2
+    const __m128 volume = _mm_set1_ps( amp );
+
+    for ( ; i + 4 <= length; i += 4 )
+        _mm_store_ps( _data + i, _mm_mul_ps( _mm_load_ps( _data + i ), volume ));
+#endif
+    for ( ; i < length; ++i )
+        _data[ i ] *= amp;
 }
 
 bool AudioBuffer::isSilent()
 {
-    for ( int i = 0; i < amountOfChannels; ++i )
+    // OR the bits of all (absolute) sample values, the result is only zero when all samples
+    // equal 0.f or -0.f. The result is checked per alignment block, exiting on the first sound
+
+    int length = amountOfChannels * _stride;
+    int i = 0;
+
+#ifdef FOGPAD_SSE2
+    const __m128i signMask = _mm_set1_epi32( 0x7fffffff );
+    const __m128i zero     = _mm_setzero_si128();
+
+    for ( ; i + 16 <= length; i += 16 )
     {
-        float* buffer = getBufferForChannel( i );
-        for ( int j = 0; j < bufferSize; ++j )
-        {
-            if ( buffer[ j ] != 0.f )
-                return false;
-        }
+        __m128i bits = _mm_or_si128(
+            _mm_or_si128( _mm_load_si128(( const __m128i* )( _data + i )),      _mm_load_si128(( const __m128i* )( _data + i + 4 ))),
+            _mm_or_si128( _mm_load_si128(( const __m128i* )( _data + i + 8 )),  _mm_load_si128(( const __m128i* )( _data + i + 12 )))
+        );
+        bits = _mm_and_si128( bits, signMask );
+
+        if ( _mm_movemask_epi8( _mm_cmpeq_epi32( bits, zero )) != 0xFFFF )
+            return false;
+    }
+#endif
+    for ( ; i < length; ++i )
+    {
+        if ( _data[ i ] != 0.f )
+            return false;
     }
     return true;
 }
@@ -140,12 +198,8 @@ AudioBuffer* AudioBuffer::clone()
 {
     AudioBuffer* output = new AudioBuffer( amountOfChannels, bufferSize );
 
-    for ( int i = 0; i < amountOfChannels; ++i )
-    {
-        float* sourceBuffer = getBufferForChannel( i );
-        float* targetBuffer = output->getBufferForChannel( i );
+    // both buffers share the same layout, copy all channels at once
+    memcpy( output->_data, _data, ( size_t ) amountOfChannels * _stride * sizeof( float ));
 
-        memcpy( targetBuffer, sourceBuffer, bufferSize * sizeof( float ));
-    }
     return output;
 }
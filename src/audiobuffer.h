@@ -24,12 +24,15 @@
 #define __AUDIOBUFFER_H_INCLUDED__
 
 #include "global.h"
-#include <vector>
 
 /**
  * An AudioBuffer represents multiple channels of audio
  * each of equal buffer length.
  * AudioBuffer has convenience methods for cloning, silencing and mixing
+ *
+ * All channels share a single allocation aligned to ALIGNMENT bytes, each channel
+ * starts at a multiple of the stride (the buffer size padded to the alignment)
+ * so every channel buffer is aligned. The padding is always silent.
  */
 class AudioBuffer
 {
@@ -37,11 +40,14 @@ class AudioBuffer
         AudioBuffer( int aAmountOfChannels, int aBufferSize );
         ~AudioBuffer();
 
+        static const int ALIGNMENT = 64; // in bytes, matches a cache line
+
         int amountOfChannels;
         int bufferSize;
         bool loopeable;
 
         float* getBufferForChannel( int aChannelNum );
+        int getStride();
         int mergeBuffers( AudioBuffer* aBuffer, int aReadOffset, int aWriteOffset, float aMixVolume );
         void silenceBuffers();
         void adjustBufferVolumes( float volume );
@@ -49,7 +55,9 @@ class AudioBuffer
         AudioBuffer* clone();
 
     protected:
-        std::vector<float*>* _buffers;
+        float* _data;    // contiguous memory of all channels
+        void*  _memory;  // unaligned allocation containing _data
+        int    _stride;  // distance (in samples) between the start of each channel
 };
 
 #endif
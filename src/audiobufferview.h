@@ -0,0 +1,83 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __AUDIOBUFFERVIEW_H_INCLUDED__
+#define __AUDIOBUFFERVIEW_H_INCLUDED__
+
+#include "audiobuffer.h"
+#include <algorithm>
+
+/**
+ * An AudioBufferView is a non-owning view over multiple channels of audio
+ * of equal buffer length. It can either wrap the contiguous (strided) memory
+ * of an AudioBuffer or a list of separate channel buffers (e.g. those provided
+ * by the host) so processing stages can operate on either without copying.
+ * Creating a view does not allocate, the viewed memory must outlive the view.
+ */
+class AudioBufferView
+{
+    public:
+        AudioBufferView() : amountOfChannels( 0 ), bufferSize( 0 ) {}
+
+        // view over contiguous memory where each channel starts stride samples after the previous one
+
+        AudioBufferView( float* data, int stride, int aAmountOfChannels, int aBufferSize )
+        {
+            amountOfChannels = std::min( aAmountOfChannels, ( int ) Igorski::VST::MAX_CHANNELS );
+            bufferSize       = aBufferSize;
+
+            for ( int c = 0; c < amountOfChannels; ++c )
+                _channels[ c ] = data + ( c * stride );
+        }
+
+        // view over separate channel buffers
+
+        AudioBufferView( float** channels, int aAmountOfChannels, int aBufferSize )
+        {
+            amountOfChannels = std::min( aAmountOfChannels, ( int ) Igorski::VST::MAX_CHANNELS );
+            bufferSize       = aBufferSize;
+
+            for ( int c = 0; c < amountOfChannels; ++c )
+                _channels[ c ] = channels[ c ];
+        }
+
+        // view over (the first aBufferSize samples of) an AudioBuffer
+
+        AudioBufferView( AudioBuffer* buffer, int aBufferSize )
+        : AudioBufferView( buffer->getBufferForChannel( 0 ), buffer->getStride(), buffer->amountOfChannels,
+                           std::min( aBufferSize, buffer->bufferSize ))
+        {
+        }
+
+        int amountOfChannels;
+        int bufferSize;
+
+        inline float* getBufferForChannel( int aChannelNum )
+        {
+            return _channels[ aChannelNum ];
+        }
+
+    private:
+        float* _channels[ Igorski::VST::MAX_CHANNELS ];
+};
+
+#endif
@@ -23,11 +23,16 @@
 #include "bitcrusher.h"
 #include "global.h"
 #include "calc.h"
+#include "kernels/kernels.h"
 #include <limits.h>
 #include <math.h>
 
 namespace Igorski {
 
+// out-of-class definition, as the constant is bound to a reference by std::min
+
+const int BitCrusher::SUB_BLOCK_SIZE;
+
 /* constructor */
 
 BitCrusher::BitCrusher( float amount, float inputMix, float outputMix )
@@ -40,6 +45,8 @@ BitCrusher::BitCrusher( float amount, float inputMix, float outputMix )
 
     lfo = new LFO();
     hasLFO = false;
+
+    _lfoBuffer = nullptr;
 }
 
 BitCrusher::~BitCrusher()
@@ -49,15 +56,18 @@ BitCrusher::~BitCrusher()
 
 /* public methods */
 
-void BitCrusher::setLFO( float LFORatePercentage, float LFODepth )
+void BitCrusher::setLFO( float LFORatePercentage, float LFODepth, float LFOSync )
 {
+    lfo->setSync( LFOSync );
+
     bool wasEnabled = hasLFO;
-    bool enabled    = LFORatePercentage > 0.f;
+    bool enabled    = LFORatePercentage > 0.f || lfo->isSynced();
 
     hasLFO = enabled;
 
     bool hadChange = ( wasEnabled != enabled ) || _lfoDepth != LFODepth;
 
+    // note the rate is ignored while the oscillator is synchronized to the tempo
     if ( enabled )
         lfo->setRate(
             VST::MIN_LFO_RATE() + (
@@ -77,33 +87,55 @@ void BitCrusher::setLFO( float LFORatePercentage, float LFODepth )
     }
 }
 
+void BitCrusher::renderLFO( float* lfoBuffer, int bufferSize )
+{
+    if ( !hasLFO )
+        return;
+
+    _lfoBuffer = lfoBuffer;
+
+    lfo->render( _lfoBuffer, bufferSize );
+
+    for ( int i = 0; i < bufferSize; ++i )
+    {
+        // multiply by .5 and add .5 to make the LFO's bipolar waveform unipolar
+        float lfoValue = _lfoBuffer[ i ] * .5f + .5f;
+        _lfoBuffer[ i ] = std::min( _lfoMax, _lfoMin + _lfoRange * lfoValue );
+    }
+}
+
 void BitCrusher::process( float* inBuffer, int bufferSize )
 {
     // sound should not be crushed ? do nothing
     if ( _bits == 16 && !hasLFO )
         return;
 
-    int bitsPlusOne = _bits + 1;
+    if ( !hasLFO ) {
+        crush( inBuffer, bufferSize );
+        return;
+    }
 
-    for ( int i = 0; i < bufferSize; ++i )
+    // LFO attached ? update the resolution once per sub block
+
+    for ( int offset = 0; offset < bufferSize; offset += SUB_BLOCK_SIZE )
     {
-        short input = ( short ) (( inBuffer[ i ] * _inputMix ) * SHRT_MAX );
-        short prevent_offset = ( short )( -1 >> bitsPlusOne );
-        input &= ( -1 << ( 16 - _bits ));
-        inBuffer[ i ] = (( input + prevent_offset ) * _outputMix ) / SHRT_MAX;
-
-        if ( hasLFO ) {
-            // multiply by .5 and add .5 to make the LFO's bipolar waveform unipolar
-            float lfoValue = lfo->peek() * .5f  + .5f;
-            _tempAmount = std::min( _lfoMax, _lfoMin + _lfoRange * lfoValue );
-
-            // recalculate the current resolution
-            calcBits();
-            bitsPlusOne = _bits + 1;
-        }
+        // recalculate the current resolution for the amount rendered by the LFO
+        _tempAmount = _lfoBuffer[ offset ];
+        calcBits();
+
+        // no crushing at the current resolution ? skip this sub block
+        if ( _bits == 16 )
+            continue;
+
+        crush( inBuffer + offset, std::min( SUB_BLOCK_SIZE, bufferSize - offset ));
     }
 }
 
+bool BitCrusher::isActive()
+{
+    return hasLFO || _bits != 16;
+}
+
 /* setters */
 
 void BitCrusher::setAmount( float value )
@@ -142,6 +174,19 @@ void BitCrusher::cacheLFO()
     _lfoMin   = std::max( 0.f, ( float ) _amount - _lfoRange / 2.f );
 }
 
+void BitCrusher::crush( float* buffer, int bufferSize )
+{
+    // the sample is scaled to a 16-bit integer, its resolution is
+    // reduced by masking the lower bits after which it is scaled back
+
+    const float inputScale  = _inputMix * SHRT_MAX;
+    const float outputScale = _outputMix / SHRT_MAX;
+    const int   mask        = ~(( 1 << ( 16 - _bits )) - 1 );
+    const int   offset      = ( short )( -1 >> ( _bits + 1 ));
+
+    Kernels::crush( buffer, bufferSize, inputScale, outputScale, mask, offset );
+}
+
 void BitCrusher::calcBits()
 {
     // scale float to 1 - 16 bit range
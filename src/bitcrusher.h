@@ -32,9 +32,22 @@ class BitCrusher {
         BitCrusher( float amount, float inputMix, float outputMix );
         ~BitCrusher();
 
-        void setLFO( float LFORatePercentage, float LFODepth );
+        // LFOSync is the cycle length in quarter notes (0 when free running, see LFO::setSync()),
+        // when set it replaces the rate. The LFO is enabled when either is non-zero
+
+        void setLFO( float LFORatePercentage, float LFODepth, float LFOSync = 0.f );
+
+        // render the LFO bit resolution trajectory for the next bufferSize samples into given
+        // buffer, which must remain available until the last channel has been processed
+        // this should be invoked once per buffer (prior to processing the first
+        // channel) so all channels are processed using the same resolution
+
+        void renderLFO( float* lfoBuffer, int bufferSize );
         void process( float* inBuffer, int bufferSize );
 
+        // whether processing alters the signal at the current settings
+        bool isActive();
+
         void setAmount( float value ); // range between -1 to +1
         void setInputMix( float value );
         void setOutputMix( float value );
@@ -42,6 +55,11 @@ class BitCrusher {
         LFO* lfo;
         bool hasLFO;
 
+        // when modulated by the LFO, the bit resolution is updated
+        // once per sub block of this size (rather than per sample)
+
+        static const int SUB_BLOCK_SIZE = 8;
+
     private:
         int _bits; // we scale the amount to integers in the 1-16 range
         float _amount;
@@ -50,11 +68,16 @@ class BitCrusher {
 
         void cacheLFO();
         void calcBits();
+
+        // applies the quantization for the current bit resolution onto given buffer
+        void crush( float* buffer, int bufferSize );
         float _tempAmount;
         float _lfoDepth;
         float _lfoRange;
         float _lfoMax;
         float _lfoMin;
+
+        float* _lfoBuffer; // amounts rendered by renderLFO()
 };
 }
 
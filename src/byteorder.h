@@ -0,0 +1,80 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __BYTEORDER_H_INCLUDED__
+#define __BYTEORDER_H_INCLUDED__
+
+#include <stdint.h>
+#include <string.h>
+
+namespace Igorski {
+namespace ByteOrder {
+
+    // byte order agnostic access to little endian values (as used by the state and preset files)
+
+    inline uint16_t readUint16( const char* data )
+    {
+        const unsigned char* bytes = ( const unsigned char* ) data;
+        return ( uint16_t )( bytes[ 0 ] | ( bytes[ 1 ] << 8 ));
+    }
+
+    inline void writeUint16( char* data, uint16_t value )
+    {
+        unsigned char* bytes = ( unsigned char* ) data;
+        bytes[ 0 ] = value & 0xFF;
+        bytes[ 1 ] = ( value >> 8 ) & 0xFF;
+    }
+
+    inline uint32_t readUint32( const char* data )
+    {
+        const unsigned char* bytes = ( const unsigned char* ) data;
+        return ( uint32_t ) bytes[ 0 ]         | (( uint32_t ) bytes[ 1 ] << 8 ) |
+               (( uint32_t ) bytes[ 2 ] << 16 ) | (( uint32_t ) bytes[ 3 ] << 24 );
+    }
+
+    inline void writeUint32( char* data, uint32_t value )
+    {
+        unsigned char* bytes = ( unsigned char* ) data;
+        bytes[ 0 ] = value & 0xFF;
+        bytes[ 1 ] = ( value >> 8 )  & 0xFF;
+        bytes[ 2 ] = ( value >> 16 ) & 0xFF;
+        bytes[ 3 ] = ( value >> 24 ) & 0xFF;
+    }
+
+    inline float readFloat( const char* data )
+    {
+        uint32_t bits = readUint32( data );
+        float value;
+        memcpy( &value, &bits, sizeof( float ));
+        return value;
+    }
+
+    inline void writeFloat( char* data, float value )
+    {
+        uint32_t bits;
+        memcpy( &bits, &value, sizeof( float ));
+        writeUint32( data, bits );
+    }
+}
+}
+
+#endif
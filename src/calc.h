@@ -29,7 +29,7 @@
 
 // internally we handle all audio as 32-bit floats (hence 0x7f800000)
 // this methods is used by comb and allpass
-#define undenormalise(sample) ((((*(uint32 *)&(sample))&0x7f800000)==0)&&((sample)!=0.f))
+#define undenormalise(sample) ((((*(uint32_t *)&(sample))&0x7f800000)==0)&&((sample)!=0.f))
 
 /**
  * convenience utilities to process values
@@ -99,6 +99,14 @@ namespace Calc {
     {
         return value >= .5;
     }
+
+    // convert a normalized 0 - 1 value to an index in the 0 - ( amount - 1 ) range
+    // (e.g. for list parameters where each entry occupies an equal step)
+
+    inline int toIndex( float value, int amount )
+    {
+        return std::min( amount - 1, ( int ) ( cap( value ) * ( amount - 1 ) + .5f ));
+    }
 }
 }
 
@@ -26,42 +26,42 @@
 
  Comb::Comb()
  {
-     _filterStore = 0;
-     _bufIndex    = 0;
+     _state.filterStore = 0;
+     _state.index       = 0;
  }
 
  void Comb::setBuffer( float *buf, int size )
  {
-     _buffer  = buf;
-     _bufSize = size;
+     _state.buffer = buf;
+     _state.size   = size;
  }
 
  void Comb::mute()
  {
-     for ( int i = 0; i < _bufSize; i++ ) {
-         _buffer[ i ] = 0;
+     for ( int i = 0; i < _state.size; i++ ) {
+         _state.buffer[ i ] = 0;
      }
  }
 
  float Comb::getDamp()
  {
-     return _damp1;
+     return _state.damp1;
  }
 
  void Comb::setDamp( float val )
  {
-     _damp1 = val;
-     _damp2 = 1 - val;
+     _state.damp1 = val;
+     _state.damp2 = 1 - val;
  }
 
  float Comb::getFeedback()
  {
-     return _feedback;
+     return _state.feedback;
  }
 
  void Comb::setFeedback( float val )
  {
-     _feedback = val;
+     _state.feedback = val;
  }
 
  }
@@ -26,25 +26,36 @@
 #include "global.h"
 #include "calc.h"
 
-using namespace Steinberg;
-
 namespace Igorski {
 class Comb
 {
     public:
+        // the state of the filter, this is shared with the block
+        // processing kernels of the reverb tank (see kernels/kernels.h)
+
+        struct State {
+            float  feedback;
+            float  filterStore;
+            float  damp1;
+            float  damp2;
+            float* buffer;
+            int size;
+            int index;
+        };
+
         Comb();
         void setBuffer( float *buf, int size );
         inline float process( float input )
         {
-            float output = _buffer[ _bufIndex ];
+            float output = _state.buffer[ _state.index ];
             undenormalise( output );
 
-            _filterStore = ( output * _damp2 ) + ( _filterStore * _damp1 );
-            undenormalise( _filterStore );
+            _state.filterStore = ( output * _state.damp2 ) + ( _state.filterStore * _state.damp1 );
+            undenormalise( _state.filterStore );
 
-            _buffer[_bufIndex] = input + ( _filterStore * _feedback );
-            if ( ++_bufIndex >= _bufSize ) {
-                _bufIndex = 0;
+            _state.buffer[ _state.index ] = input + ( _state.filterStore * _state.feedback );
+            if ( ++_state.index >= _state.size ) {
+                _state.index = 0;
             }
             return output;
         }
@@ -53,15 +64,10 @@ class Comb
         void setDamp( float val );
         float getFeedback();
         void setFeedback( float val );
+        State* getState() { return &_state; }
 
     private:
-        float  _feedback;
-        float  _filterStore;
-        float  _damp1;
-        float  _damp2;
-        float* _buffer;
-        int _bufSize;
-        int _bufIndex;
+        State _state;
 };
 }
 #endif
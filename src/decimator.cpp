@@ -22,14 +22,23 @@
  */
 #include "decimator.h"
 #include "calc.h"
+#include "simd.h"
 #include <math.h>
 
 namespace Igorski {
 
+constexpr float Decimator::MIN_RATE;
+
 /* constructor / destructor */
 
 Decimator::Decimator( int bits, float rate )
 {
+    _holdIndices = nullptr;
+    _heldSamples = new float[ VST::MAX_CHANNELS ];
+
+    for ( int i = 0; i < VST::MAX_CHANNELS; ++i )
+        _heldSamples[ i ] = 0.f;
+
     setBits( bits );
     setRate( rate );
 
@@ -38,7 +47,7 @@ Decimator::Decimator( int bits, float rate )
 
 Decimator::~Decimator()
 {
-    // nowt...
+    delete[] _heldSamples;
 }
 
 /* getters / setters */
@@ -52,7 +61,12 @@ void Decimator::setBits( int value )
 {
     // cap in 1 - 32 range
     _bits = std::min( 32, std::max( 1, value ));
-    _m    = 1 << ( _bits - 1 );
+    _step = 1.f / ( float ) ( 1LL << ( _bits - 1 ));
+
+    // at resolutions beyond the precision of a 32-bit float mantissa
+    // quantization has no effect
+
+    _doQuantize = _bits <= 24;
 }
 
 float Decimator::getRate()
@@ -62,40 +76,98 @@ float Decimator::getRate()
 
 void Decimator::setRate( float value )
 {
-    _rate = Calc::cap( value );
+    _rate   = std::max( MIN_RATE, Calc::cap( value ));
+    _doHold = _rate < 1.f;
 }
 
-void Decimator::store()
+/* public methods */
+
+void Decimator::prepare( int* holdIndices, int bufferSize )
 {
-    _accumulatorStored = _accumulator;
+    if ( !_doHold )
+        return;
+
+    _holdIndices = holdIndices;
+
+    // advance the accumulator for the whole buffer, each time it completes a
+    // cycle the current sample is sampled and held until the next cycle completes
+
+    float accumulator = _accumulator;
+    int holdIndex     = -1;
+
+    for ( int i = 0; i < bufferSize; ++i )
+    {
+        accumulator += _rate;
+
+        bool sample  = accumulator >= 1.f;
+        accumulator -= sample ? 1.f : 0.f;
+        holdIndex    = sample ? i : holdIndex;
+
+        _holdIndices[ i ] = holdIndex;
+    }
+    _accumulator = accumulator;
 }
 
-void Decimator::restore()
+bool Decimator::isActive()
 {
-    _accumulator = _accumulatorStored;
+    return _doQuantize || _doHold;
 }
 
-/* public methods */
+void Decimator::process( float* sampleBuffer, int bufferSize, int c )
+{
+    // full resolution at the original sample rate ? nothing to do
+    if ( !isActive() )
+        return;
+
+    if ( _doQuantize )
+        quantize( sampleBuffer, bufferSize );
+
+    if ( !_doHold )
+        return;
+
+    // samples preceding the first sampling position of this buffer
+    // hold the last sample of the previous buffer
+
+    int i = 0;
+    float heldSample = _heldSamples[ c ];
+
+    for ( ; i < bufferSize && _holdIndices[ i ] < 0; ++i )
+        sampleBuffer[ i ] = heldSample;
+
+    // hold indices never exceed the current index and a sampled position holds
+    // itself, as such the buffer can safely be processed in place
+
+    for ( ; i < bufferSize; ++i )
+        sampleBuffer[ i ] = sampleBuffer[ _holdIndices[ i ]];
 
-void Decimator::process( float* sampleBuffer, int bufferSize )
+    if ( bufferSize > 0 )
+        _heldSamples[ c ] = sampleBuffer[ bufferSize - 1 ];
+}
+
+/* private methods */
+
+void Decimator::quantize( float* sampleBuffer, int bufferSize )
 {
-    float sample;
-    bool doProcess = ( _bits < 32 );
+    // round each sample to the nearest multiple of the quantization step
 
-    for ( int i = 0; i < bufferSize; ++i )
-    {
-        sample = sampleBuffer[ i ];
-        _accumulator += _rate;
+    const float scale = 1.f / _step;
+    int i = 0;
+
+#ifdef FOGPAD_SSE2
+    // conversion to integer rounds to nearest (default rounding mode)
 
-        if ( _accumulator >= 1.f )
-        {
-            _accumulator -= 1.f;
+    const __m128 vScale = _mm_set1_ps( scale );
+    const __m128 vStep  = _mm_set1_ps( _step );
 
-            if ( doProcess )
-                sample = ( float ) _m * floor( sample / ( float ) _m + 0.5f );
-        }
-        sampleBuffer[ i ] = sample;
+    for ( ; i + 4 <= bufferSize; i += 4 )
+    {
+        __m128i rounded = _mm_cvtps_epi32( _mm_mul_ps( _mm_loadu_ps( sampleBuffer + i ), vScale ));
+        _mm_storeu_ps( sampleBuffer + i, _mm_mul_ps( _mm_cvtepi32_ps( rounded ), vStep ));
     }
+#endif
+
+    for ( ; i < bufferSize; ++i )
+        sampleBuffer[ i ] = rintf( sampleBuffer[ i ] * scale ) * _step;
 }
 
 }
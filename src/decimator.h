@@ -38,26 +38,38 @@ class Decimator {
         void setBits( int value );
 
         // decimator has an internal oscillator
-        // as the effect is applied at the peak of the cycle
+        // the input is sampled (and held) at the peak of the cycle
         // the range is 0 - 1 where 1 implies the original sample rate
         float getRate();
         void setRate( float value );
 
-        void process( float* sampleBuffer, int bufferSize );
+        // calculates the sample and hold positions for the next bufferSize samples into
+        // given buffer, which must remain available until the last channel has been processed
+        // this should be invoked once per buffer (prior to processing the first
+        // channel) so all channels are sampled at the same positions
 
-        // store/restore the processor properties
-        // this ensures that multi channel processing for a
-        // single buffer uses all properties across all channels
+        void prepare( int* holdIndices, int bufferSize );
 
-        void store();
-        void restore();
+        // whether processing alters the signal at the current settings
+        bool isActive();
+
+        void process( float* sampleBuffer, int bufferSize, int c );
+
+        // the lowest supported rate, as a rate of 0 would hold a single sample indefinitely
+        static constexpr float MIN_RATE = 0.01f;
 
     private:
         int _bits;
-        long _m;
         float _rate;
+        float _step;         // quantization step for the current bit resolution
         float _accumulator;
-        float _accumulatorStored;
+        bool _doQuantize;
+        bool _doHold;
+
+        int* _holdIndices;   // per sample, the index of the sample to hold (-1 for the last sample of the previous buffer)
+        float* _heldSamples; // per channel, the held sample at the end of the last buffer
+
+        void quantize( float* sampleBuffer, int bufferSize );
 };
 }
 
@@ -0,0 +1,75 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "ducker.h"
+#include "global.h"
+#include <math.h>
+
+namespace Igorski {
+
+/* constructor */
+
+Ducker::Ducker( float attackMs, float releaseMs )
+{
+    _attack   = attackMs;
+    _release  = releaseMs;
+    _amount   = 0.f;
+    _envelope = 0.f;
+    _gain     = 1.f;
+}
+
+Ducker::~Ducker()
+{
+
+}
+
+/* public methods */
+
+float Ducker::getAmount()
+{
+    return _amount;
+}
+
+void Ducker::setAmount( float value )
+{
+    _amount = std::min( 1.f, std::max( 0.f, value ));
+}
+
+bool Ducker::isActive()
+{
+    return _amount > 0.f || _gain < 1.f;
+}
+
+/* private methods */
+
+void Ducker::follow( float peak, int bufferSize )
+{
+    // the envelope is updated once per buffer, so the time constants
+    // are expressed in the duration of the buffer
+
+    float ms          = ( float ) bufferSize / ( float ) VST::SAMPLE_RATE * 1000.f;
+    float coefficient = expf( -ms / ( peak > _envelope ? _attack : _release ));
+
+    _envelope = peak + coefficient * ( _envelope - peak );
+}
+
+}
@@ -0,0 +1,67 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __DUCKER_H_INCLUDED__
+#define __DUCKER_H_INCLUDED__
+
+#include "levelmeter.h"
+
+namespace Igorski {
+class Ducker {
+
+    public:
+        Ducker( float attackMs, float releaseMs );
+        ~Ducker();
+
+        // the amount by which the wet signal is attenuated when the sidechain
+        // signal reaches full scale, value between 0 (no ducking) - 1
+        float getAmount();
+        void setAmount( float value );
+
+        // whether the gain is altered at the current settings (remaining true until
+        // the gain has fully recovered when the amount is set to 0)
+        bool isActive();
+
+        // follows the peak envelope of the sidechain signal and renders the gain to apply onto the
+        // wet signal for the next bufferSize samples into given buffer. The envelope is updated once
+        // per buffer (using the vectorized peak of all sidechain channels) and the gain is ramped from
+        // its value at the end of the previous buffer. When no sidechain is provided (e.g. the bus
+        // is inactive) the envelope releases as if silence was received
+
+        template <typename SampleType>
+        void render( float* gainBuffer, SampleType** sidechainBuffer, int numChannels, int bufferSize );
+
+    private:
+        float _amount;
+        float _attack;   // in ms
+        float _release;  // in ms
+        float _envelope; // linear peak envelope of the sidechain signal
+        float _gain;     // gain applied at the end of the last rendered buffer
+
+        // updates the envelope using the peak of the last bufferSize samples
+        void follow( float peak, int bufferSize );
+};
+}
+
+#include "ducker.tcc"
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+namespace Igorski
+{
+template <typename SampleType>
+void Ducker::render( float* gainBuffer, SampleType** sidechainBuffer, int numChannels, int bufferSize )
+{
+    float peak = 0.f;
+
+    if ( sidechainBuffer != nullptr )
+    {
+        for ( int c = 0; c < numChannels; ++c )
+        {
+            float channelPeak = 0.f;
+            double sumOfSquares = 0.0;
+
+            LevelMeter::reduce( sidechainBuffer[ c ], bufferSize, channelPeak, sumOfSquares );
+
+            peak = std::max( peak, channelPeak );
+        }
+    }
+    follow( peak, bufferSize );
+
+    // ramp towards the gain for the current envelope to prevent zipper noise
+
+    float target = 1.f - _amount * std::min( 1.f, _envelope );
+    float step   = ( target - _gain ) / ( float ) bufferSize;
+
+    for ( int i = 0; i < bufferSize; ++i )
+        gainBuffer[ i ] = _gain + step * ( float )( i + 1 );
+
+    _gain = target;
+}
+
+}
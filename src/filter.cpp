@@ -24,8 +24,6 @@
 #include "global.h"
 #include <algorithm>
 
-using namespace Steinberg;
-
 namespace Igorski {
 
 Filter::Filter() {
@@ -47,10 +45,11 @@ Filter::Filter() {
 
     lfo = new Igorski::LFO();
 
-    _hasLFO = false;
+    _hasLFO              = false;
+    _lfoBuffer           = nullptr;
+    _coefficientInterval = 1;
 
-    // stereo (2) probably enough...
-    int numChannels = 8;
+    int numChannels = VST::MAX_CHANNELS;
 
     _in1  = new float[ numChannels ];
     _in2  = new float[ numChannels ];
@@ -77,7 +76,8 @@ Filter::~Filter() {
 
 /* public methods */
 
-void Filter::updateProperties( float cutoffPercentage, float resonancePercentage, float LFORatePercentage, float LFODepth )
+void Filter::updateProperties( float cutoffPercentage, float resonancePercentage, float LFORatePercentage, float LFODepth,
+                               float LFOSync )
 {
     float co  = VST::FILTER_MIN_FREQ + ( cutoffPercentage * ( VST::FILTER_MAX_FREQ - VST::FILTER_MIN_FREQ ));
     float res = VST::FILTER_MIN_RESONANCE + ( resonancePercentage * ( VST::FILTER_MAX_RESONANCE - VST::FILTER_MIN_RESONANCE ));
@@ -88,7 +88,9 @@ void Filter::updateProperties( float cutoffPercentage, float resonancePercentage
     }
     _depth = LFODepth;
 
-    bool doLFO = LFORatePercentage != 0.f;
+    lfo->setSync( LFOSync );
+
+    bool doLFO = LFORatePercentage != 0.f || lfo->isSynced();
 
     if ( !doLFO && _hasLFO ) {
         setLFO( false );
@@ -96,6 +98,8 @@ void Filter::updateProperties( float cutoffPercentage, float resonancePercentage
     else if ( doLFO ) {
         setLFO( true );
         cacheLFOProperties();
+
+        // note the rate is ignored while the oscillator is synchronized to the tempo
         lfo->setRate(
             VST::MIN_LFO_RATE() + (
                 LFORatePercentage * ( VST::MAX_LFO_RATE() - VST::MIN_LFO_RATE() )
@@ -104,33 +108,63 @@ void Filter::updateProperties( float cutoffPercentage, float resonancePercentage
     }
 }
 
-void Filter::process( float* sampleBuffer, int bufferSize, int c )
+void Filter::renderLFO( float* lfoBuffer, int bufferSize )
 {
-    for ( int32 i = 0; i < bufferSize; ++i )
+    if ( !_hasLFO )
+        return;
+
+    _lfoBuffer = lfoBuffer;
+
+    lfo->render( _lfoBuffer, bufferSize );
+
+    // oscillator attached to Filter ? travel the cutoff values
+    // between the minimum and maximum frequencies
+
+    for ( int i = 0; i < bufferSize; ++i )
     {
-        float input  = sampleBuffer[ i ];
-        float output = _a1 * input + _a2 * _in1[ c ] + _a3 * _in2[ c ] - _b1 * _out1[ c ] - _b2 * _out2[ c ];
+        // multiply by .5 and add .5 to make bipolar waveform unipolar
+        float lfoValue = _lfoBuffer[ i ] * .5f + .5f;
+        _lfoBuffer[ i ] = std::min( _lfoMax, _lfoMin + _lfoRange * lfoValue );
+    }
+}
+
+void Filter::process( float* sampleBuffer, int bufferSize, int c )
+{
+    float in1  = _in1 [ c ];
+    float in2  = _in2 [ c ];
+    float out1 = _out1[ c ];
+    float out2 = _out2[ c ];
 
-        _in2 [ c ] = _in1[ c ];
-        _in1 [ c ] = input;
-        _out2[ c ] = _out1[ c ];
-        _out1[ c ] = output;
+    int coefficientCountdown = 0;
 
-        // oscillator attached to Filter ? travel the cutoff values
-        // between the minimum and maximum frequencies
+    for ( int i = 0; i < bufferSize; ++i )
+    {
+        // update the coefficients for the cutoff frequency rendered by the LFO
+        // (at the interval defined by the current quality setting)
 
-        if ( _hasLFO )
+        if ( _hasLFO && --coefficientCountdown <= 0 )
         {
-            // multiply by .5 and add .5 to make bipolar waveform unipolar
-            float lfoValue = lfo->peek() * .5f  + .5f;
-            _tempCutoff = std::min( _lfoMax, _lfoMin + _lfoRange * lfoValue );
-
+            coefficientCountdown = _coefficientInterval;
+            _tempCutoff = _lfoBuffer[ i ];
             calculateParameters();
         }
 
+        float input  = sampleBuffer[ i ];
+        float output = _a1 * input + _a2 * in1 + _a3 * in2 - _b1 * out1 - _b2 * out2;
+
+        in2  = in1;
+        in1  = input;
+        out2 = out1;
+        out1 = output;
+
         // commit the effect
         sampleBuffer[ i ] = output;
     }
+
+    _in1 [ c ] = in1;
+    _in2 [ c ] = in2;
+    _out1[ c ] = out1;
+    _out2[ c ] = out2;
 }
 
 void Filter::setCutoff( float frequency )
@@ -176,17 +210,9 @@ void Filter::setLFO( bool enabled )
     }
 }
 
-void Filter::store()
-{
-    _accumulatorStored = lfo->getAccumulator();
-    _tempCutoffStored  = _tempCutoff;
-}
-
-void Filter::restore()
+void Filter::setQuality( VST::Quality quality )
 {
-    lfo->setAccumulator( _accumulatorStored );
-    _tempCutoff = _tempCutoffStored;
-    calculateParameters();
+    _coefficientInterval = ( quality == VST::QUALITY_HIGH ) ? 1 : ECO_COEFFICIENT_INTERVAL;
 }
 
 void Filter::calculateParameters()
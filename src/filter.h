@@ -42,23 +42,33 @@ class Filter {
         float getDepth();
         void setLFO( bool enabled );
 
+        // when modulated by the LFO, QUALITY_HIGH recalculates the filter coefficients
+        // every sample while QUALITY_ECO recalculates these every few samples
+
+        void setQuality( VST::Quality quality );
+
+        static const int ECO_COEFFICIENT_INTERVAL = 16;
+
         void calculateParameters();
 
         // update Filter properties, the values here are in normalized 0 - 1 range
-        void updateProperties( float cutoffPercentage, float resonancePercentage, float LFORatePercentage, float fLFODepth );
+        // LFOSync is the cycle length in quarter notes (0 when free running, see LFO::setSync()),
+        // when set it replaces the rate. The LFO is enabled when either is non-zero
+        void updateProperties( float cutoffPercentage, float resonancePercentage, float LFORatePercentage, float fLFODepth,
+                               float LFOSync = 0.f );
+
+        // render the LFO cutoff trajectory for the next bufferSize samples into given
+        // buffer, which must remain available until the last channel has been processed
+        // this should be invoked once per buffer (prior to processing the first
+        // channel) so all channels are processed using the same cutoff values
+
+        void renderLFO( float* lfoBuffer, int bufferSize );
 
         // apply filter to incoming sampleBuffer contents
         void process( float* sampleBuffer, int bufferSize, int c );
 
         LFO* lfo;
 
-        // store/restore the processor properties
-        // this ensures that multi channel processing for a
-        // single buffer uses all properties across all channels
-
-        void store();
-        void restore();
-
     private:
         float _cutoff;
         float _tempCutoff;
@@ -68,11 +78,11 @@ class Filter {
         float _lfoMax;
         float _lfoRange;
         bool  _hasLFO;
+        int   _coefficientInterval;
 
         // used internally
 
-        float _accumulatorStored;
-        float _tempCutoffStored;
+        float* _lfoBuffer;   // cutoff frequencies rendered by renderLFO()
 
         float _a1;
         float _a2;
@@ -0,0 +1,9 @@
+#include "global.h"
+
+namespace Igorski {
+namespace VST {
+
+    float SAMPLE_RATE = 44100.f;
+
+}
+}
@@ -1,10 +1,10 @@
 #ifndef __GLOBAL_HEADER__
 #define __GLOBAL_HEADER__
 
-#include "pluginterfaces/base/fplatform.h"
-#include "pluginterfaces/base/funknown.h"
+#include <cstdint>
 
-using namespace Steinberg;
+// note this header is shared by the DSP library and the plugin and should not depend on the
+// VST3 SDK, the class identifiers provided to the host are defined in pluginids.h
 
 namespace Igorski {
 namespace VST {
@@ -13,13 +13,24 @@ namespace VST {
     static const char* NAME     = "FogPad";
     static const char* VENDOR   = "igorski.nl";
 
-    static const FUID FogPadProcessorUID( 0xF2458509, 0xCBF43926, 0x04C11DB7, 0xFFFFFFFF );
-    static const FUID FogPadControllerUID( 0x10499968, 0xCBF43926, 0x04C11DB7, 0xFFFFFFFF );
-
-    // set upon initialization, see vst.cpp
-    static float SAMPLE_RATE = 44100.f;
+    // set upon initialization, see vst.cpp (defined in global.cpp so
+    // all translation units share the same value)
+    extern float SAMPLE_RATE;
     static int BUFFER_SIZE   = 8192;
 
+    // maximum amount of channels the processors keep state for
+    static const int MAX_CHANNELS = 8;
+
+    // processing quality tiers. QUALITY_HIGH uses the most expensive (per-sample
+    // filter coefficients, cubic drift interpolation, 4x true peak detection)
+    // settings and is used for offline rendering while QUALITY_ECO is used for
+    // realtime processing. also see FogPad::getQuality()
+
+    enum Quality {
+        QUALITY_ECO = 0,
+        QUALITY_HIGH
+    };
+
     static const float PI     = 3.141592653589793f;
     static const float TWO_PI = PI * 2.f;
 
@@ -37,8 +48,19 @@ namespace VST {
     static const float MAX_LFO_RATE() { return 10.f; }
     static const float MIN_LFO_RATE() { return .1f; }
 
-    // sine waveform used for the oscillator
-    static const float TABLE[ 128 ] = { 0, 0.0490677, 0.0980171, 0.14673, 0.19509, 0.24298, 0.290285, 0.33689, 0.382683, 0.427555, 0.471397, 0.514103, 0.55557, 0.595699, 0.634393, 0.671559, 0.707107, 0.740951, 0.77301, 0.803208, 0.83147, 0.857729, 0.881921, 0.903989, 0.92388, 0.941544, 0.95694, 0.970031, 0.980785, 0.989177, 0.995185, 0.998795, 1, 0.998795, 0.995185, 0.989177, 0.980785, 0.970031, 0.95694, 0.941544, 0.92388, 0.903989, 0.881921, 0.857729, 0.83147, 0.803208, 0.77301, 0.740951, 0.707107, 0.671559, 0.634393, 0.595699, 0.55557, 0.514103, 0.471397, 0.427555, 0.382683, 0.33689, 0.290285, 0.24298, 0.19509, 0.14673, 0.0980171, 0.0490677, 1.22465e-16, -0.0490677, -0.0980171, -0.14673, -0.19509, -0.24298, -0.290285, -0.33689, -0.382683, -0.427555, -0.471397, -0.514103, -0.55557, -0.595699, -0.634393, -0.671559, -0.707107, -0.740951, -0.77301, -0.803208, -0.83147, -0.857729, -0.881921, -0.903989, -0.92388, -0.941544, -0.95694, -0.970031, -0.980785, -0.989177, -0.995185, -0.998795, -1, -0.998795, -0.995185, -0.989177, -0.980785, -0.970031, -0.95694, -0.941544, -0.92388, -0.903989, -0.881921, -0.857729, -0.83147, -0.803208, -0.77301, -0.740951, -0.707107, -0.671559, -0.634393, -0.595699, -0.55557, -0.514103, -0.471397, -0.427555, -0.382683, -0.33689, -0.290285, -0.24298, -0.19509, -0.14673, -0.0980171, -0.0490677 };
+    // tempo synchronized oscillator rates, expressed as the length of a single
+    // cycle in quarter notes. Each note value is followed by its dotted and triplet variant
+    // also see controller.cpp to update the list parameter entries to match
+
+    static const int LFO_SYNC_AMOUNT = 18;
+    static const float LFO_SYNC_QUARTER_NOTES[ LFO_SYNC_AMOUNT ] = {
+        4.f,     6.f,      8.f / 3.f,   // 1/1
+        2.f,     3.f,      4.f / 3.f,   // 1/2
+        1.f,     1.5f,     2.f / 3.f,   // 1/4
+        .5f,     .75f,     1.f / 3.f,   // 1/8
+        .25f,    .375f,    1.f / 6.f,   // 1/16
+        .125f,   .1875f,   1.f / 12.f   // 1/32
+    };
 
     // These values are tuned to 44.1 kHz sample rate and will be
     // recalculated to match the host sample recalculated
@@ -0,0 +1,529 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "kernels.h"
+#include "../global.h"
+#include <limits.h>
+#include <math.h>
+
+/**
+ * AVX2 variant of the kernels, this translation unit is compiled with the AVX2 instruction set
+ * enabled (see CMakeLists.txt). When built without, the variant is unavailable
+ */
+#ifdef __AVX2__
+
+#include <immintrin.h>
+
+namespace Igorski {
+namespace Kernels {
+namespace AVX2 {
+
+// the kernels and their helpers have internal linkage, the helpers replace the inline
+// functions of headers and the standard library (see Kernels::processComb())
+
+namespace {
+
+template <typename T>
+inline T min( T a, T b )
+{
+    return ( b < a ) ? b : a;
+}
+
+template <typename T>
+inline T max( T a, T b )
+{
+    return ( a < b ) ? b : a;
+}
+
+// the eight comb filters each occupy a lane of a vector. Eight samples are read from
+// each delay line at once, these are transposed to update the recursive filter stores
+// of all combs at once for each sample (see Baseline::tank())
+
+static const int LANES = 8;
+
+static_assert( VST::NUM_COMBS == LANES, "the comb filters must fill all lanes of the vectors" );
+
+inline void transpose( __m256 rows[ LANES ] )
+{
+    __m256 t0 = _mm256_unpacklo_ps( rows[ 0 ], rows[ 1 ] );
+    __m256 t1 = _mm256_unpackhi_ps( rows[ 0 ], rows[ 1 ] );
+    __m256 t2 = _mm256_unpacklo_ps( rows[ 2 ], rows[ 3 ] );
+    __m256 t3 = _mm256_unpackhi_ps( rows[ 2 ], rows[ 3 ] );
+    __m256 t4 = _mm256_unpacklo_ps( rows[ 4 ], rows[ 5 ] );
+    __m256 t5 = _mm256_unpackhi_ps( rows[ 4 ], rows[ 5 ] );
+    __m256 t6 = _mm256_unpacklo_ps( rows[ 6 ], rows[ 7 ] );
+    __m256 t7 = _mm256_unpackhi_ps( rows[ 6 ], rows[ 7 ] );
+
+    __m256 s0 = _mm256_shuffle_ps( t0, t2, _MM_SHUFFLE( 1, 0, 1, 0 ));
+    __m256 s1 = _mm256_shuffle_ps( t0, t2, _MM_SHUFFLE( 3, 2, 3, 2 ));
+    __m256 s2 = _mm256_shuffle_ps( t1, t3, _MM_SHUFFLE( 1, 0, 1, 0 ));
+    __m256 s3 = _mm256_shuffle_ps( t1, t3, _MM_SHUFFLE( 3, 2, 3, 2 ));
+    __m256 s4 = _mm256_shuffle_ps( t4, t6, _MM_SHUFFLE( 1, 0, 1, 0 ));
+    __m256 s5 = _mm256_shuffle_ps( t4, t6, _MM_SHUFFLE( 3, 2, 3, 2 ));
+    __m256 s6 = _mm256_shuffle_ps( t5, t7, _MM_SHUFFLE( 1, 0, 1, 0 ));
+    __m256 s7 = _mm256_shuffle_ps( t5, t7, _MM_SHUFFLE( 3, 2, 3, 2 ));
+
+    rows[ 0 ] = _mm256_permute2f128_ps( s0, s4, 0x20 );
+    rows[ 1 ] = _mm256_permute2f128_ps( s1, s5, 0x20 );
+    rows[ 2 ] = _mm256_permute2f128_ps( s2, s6, 0x20 );
+    rows[ 3 ] = _mm256_permute2f128_ps( s3, s7, 0x20 );
+    rows[ 4 ] = _mm256_permute2f128_ps( s0, s4, 0x31 );
+    rows[ 5 ] = _mm256_permute2f128_ps( s1, s5, 0x31 );
+    rows[ 6 ] = _mm256_permute2f128_ps( s2, s6, 0x31 );
+    rows[ 7 ] = _mm256_permute2f128_ps( s3, s7, 0x31 );
+}
+
+inline __m256 readDelay( const Comb::State* state )
+{
+    const float* buffer = state->buffer;
+    int index = state->index;
+
+    if ( index + LANES <= state->size )
+        return _mm256_loadu_ps( buffer + index );
+
+    // the samples wrap around the end of the delay line
+
+    float samples[ LANES ];
+    for ( int i = 0; i < LANES; ++i, ++index )
+        samples[ i ] = buffer[ index < state->size ? index : index - state->size ];
+
+    return _mm256_loadu_ps( samples );
+}
+
+inline void writeDelay( Comb::State* state, __m256 values )
+{
+    float* buffer = state->buffer;
+    int index = state->index;
+
+    if ( index + LANES <= state->size ) {
+        _mm256_storeu_ps( buffer + index, values );
+    }
+    else {
+        float samples[ LANES ];
+        _mm256_storeu_ps( samples, values );
+
+        for ( int i = 0; i < LANES; ++i, ++index )
+            buffer[ index < state->size ? index : index - state->size ] = samples[ i ];
+    }
+    if (( state->index += LANES ) >= state->size )
+        state->index -= state->size;
+}
+
+inline float reduceMax( __m256 values )
+{
+    __m128 maximum = _mm_max_ps( _mm256_castps256_ps128( values ), _mm256_extractf128_ps( values, 1 ));
+    maximum = _mm_max_ps( maximum, _mm_movehl_ps( maximum, maximum ));
+    maximum = _mm_max_ss( maximum, _mm_shuffle_ps( maximum, maximum, 1 ));
+
+    return _mm_cvtss_f32( maximum );
+}
+
+inline double reduceMax( __m256d values )
+{
+    __m128d maximum = _mm_max_pd( _mm256_castpd256_pd128( values ), _mm256_extractf128_pd( values, 1 ));
+    return _mm_cvtsd_f64( _mm_max_sd( maximum, _mm_unpackhi_pd( maximum, maximum )));
+}
+
+inline double reduceSum( __m256 values )
+{
+    float lanes[ 8 ];
+    _mm256_storeu_ps( lanes, values );
+
+    double sum = 0.0;
+    for ( int i = 0; i < 8; ++i )
+        sum += lanes[ i ];
+
+    return sum;
+}
+
+inline double reduceSum( __m256d values )
+{
+    double lanes[ 4 ];
+    _mm256_storeu_pd( lanes, values );
+
+    return lanes[ 0 ] + lanes[ 1 ] + lanes[ 2 ] + lanes[ 3 ];
+}
+
+void tank( Comb::State** states, AllPass::State** allPasses, float* buffer, int length )
+{
+    int i = 0;
+    bool fitsLanes = true;
+
+    for ( int k = 0; k < LANES; ++k )
+        fitsLanes = fitsLanes && states[ k ]->size >= LANES;
+
+    if ( fitsLanes )
+    {
+        float values[ 4 ][ LANES ];
+
+        for ( int k = 0; k < LANES; ++k ) {
+            values[ 0 ][ k ] = states[ k ]->feedback;
+            values[ 1 ][ k ] = states[ k ]->damp1;
+            values[ 2 ][ k ] = states[ k ]->damp2;
+            values[ 3 ][ k ] = states[ k ]->filterStore;
+        }
+        const __m256 feedback = _mm256_loadu_ps( values[ 0 ] );
+        const __m256 damp1    = _mm256_loadu_ps( values[ 1 ] );
+        const __m256 damp2    = _mm256_loadu_ps( values[ 2 ] );
+        __m256 filterStore    = _mm256_loadu_ps( values[ 3 ] );
+
+        for ( ; i + LANES <= length; i += LANES )
+        {
+            // transpose the delayed samples (a vector per comb) into a vector per sample
+
+            __m256 outputs[ LANES ];
+            __m256 samples[ LANES ];
+
+            for ( int k = 0; k < LANES; ++k )
+                samples[ k ] = outputs[ k ] = readDelay( states[ k ]);
+
+            transpose( samples );
+
+            for ( int j = 0; j < LANES; ++j ) {
+                filterStore  = _mm256_add_ps( _mm256_mul_ps( samples[ j ], damp2 ), _mm256_mul_ps( filterStore, damp1 ));
+                samples[ j ] = _mm256_add_ps( _mm256_set1_ps( buffer[ i + j ] ), _mm256_mul_ps( filterStore, feedback ));
+            }
+
+            transpose( samples );
+
+            for ( int k = 0; k < LANES; ++k )
+                writeDelay( states[ k ], samples[ k ] );
+
+            // accumulate the combs in order
+
+            __m256 sum = _mm256_setzero_ps();
+            for ( int k = 0; k < LANES; ++k )
+                sum = _mm256_add_ps( sum, outputs[ k ] );
+
+            _mm256_storeu_ps( buffer + i, sum );
+        }
+
+        _mm256_storeu_ps( values[ 3 ], filterStore );
+
+        for ( int k = 0; k < LANES; ++k )
+            states[ k ]->filterStore = values[ 3 ][ k ];
+    }
+
+    // remaining samples
+
+    for ( ; i < length; ++i )
+    {
+        float input = buffer[ i ];
+        float sum   = 0.f;
+
+        for ( int k = 0; k < LANES; ++k )
+            sum += processComb( states[ k ], input );
+
+        buffer[ i ] = sum;
+    }
+
+    // the allpass filters are applied in series, each onto the full buffer
+
+    for ( int a = 0; a < VST::NUM_ALLPASSES; ++a )
+    {
+        AllPass::State* state = allPasses[ a ];
+        const __m256 feedback = _mm256_set1_ps( state->feedback );
+
+        for ( i = 0; i < length; )
+        {
+            int range     = min( length - i, state->size - state->index );
+            float* delay  = state->buffer + state->index;
+            float* output = buffer + i;
+            int j = 0;
+
+            for ( ; j + 8 <= range; j += 8 )
+            {
+                __m256 input   = _mm256_loadu_ps( output + j );
+                __m256 delayed = _mm256_loadu_ps( delay + j );
+
+                _mm256_storeu_ps( output + j, _mm256_sub_ps( delayed, input ));
+                _mm256_storeu_ps( delay + j,  _mm256_add_ps( input, _mm256_mul_ps( delayed, feedback )));
+            }
+
+            for ( ; j < range; ++j )
+            {
+                float input   = output[ j ];
+                float delayed = delay[ j ];
+
+                output[ j ] = delayed - input;
+                delay[ j ]  = input + ( delayed * state->feedback );
+            }
+            i += range;
+
+            if (( state->index += range ) >= state->size )
+                state->index = 0;
+        }
+    }
+}
+
+void crush( float* buffer, int length, float inputScale, float outputScale, int mask, int offset )
+{
+    int i = 0;
+
+    // 16 samples at a time: two vectors of 8 floats are packed into a single vector of 16 shorts
+    // (saturating), masked and unpacked (sign extending) to floats again. Note packing and
+    // unpacking operate within each 128-bit lane, as such the sample order is restored
+
+    const __m256  vInputScale  = _mm256_set1_ps( inputScale );
+    const __m256  vOutputScale = _mm256_set1_ps( outputScale );
+    const __m256i vMask        = _mm256_set1_epi16(( short ) mask );
+    const __m256i vOffset      = _mm256_set1_epi32( offset );
+
+    for ( ; i + 16 <= length; i += 16 )
+    {
+        __m256i low  = _mm256_cvttps_epi32( _mm256_mul_ps( _mm256_loadu_ps( buffer + i ),     vInputScale ));
+        __m256i high = _mm256_cvttps_epi32( _mm256_mul_ps( _mm256_loadu_ps( buffer + i + 8 ), vInputScale ));
+
+        __m256i crushed = _mm256_and_si256( _mm256_packs_epi32( low, high ), vMask );
+
+        low  = _mm256_add_epi32( _mm256_srai_epi32( _mm256_unpacklo_epi16( crushed, crushed ), 16 ), vOffset );
+        high = _mm256_add_epi32( _mm256_srai_epi32( _mm256_unpackhi_epi16( crushed, crushed ), 16 ), vOffset );
+
+        _mm256_storeu_ps( buffer + i,     _mm256_mul_ps( _mm256_cvtepi32_ps( low ),  vOutputScale ));
+        _mm256_storeu_ps( buffer + i + 8, _mm256_mul_ps( _mm256_cvtepi32_ps( high ), vOutputScale ));
+    }
+
+    // remaining samples (saturated to the 16-bit range, same as the vectorized loop)
+
+    for ( ; i < length; ++i )
+    {
+        float scaled = min(( float ) SHRT_MAX, max(( float ) SHRT_MIN, buffer[ i ] * inputScale ));
+        short input  = ( short ) scaled;
+        input &= mask;
+        buffer[ i ] = ( input + offset ) * outputScale;
+    }
+}
+
+void mixFloat( float* outBuffer, const float* postMixBuffer, const float* inBuffer, const float* duckGain,
+               float wet, float dry, int length, float& peak, double& sumOfSquares )
+{
+    const __m256 signMask = _mm256_set1_ps( -0.f );
+    const __m256 vWet     = _mm256_set1_ps( wet );
+    const __m256 vDry     = _mm256_set1_ps( dry );
+    __m256 peaks   = _mm256_setzero_ps();
+    __m256 squares = _mm256_setzero_ps();
+    int i = 0;
+
+    for ( ; i + 8 <= length; i += 8 )
+    {
+        __m256 input   = _mm256_loadu_ps( inBuffer + i );
+        __m256 wetGain = duckGain ? _mm256_mul_ps( _mm256_loadu_ps( duckGain + i ), vWet ) : vWet;
+
+        peaks   = _mm256_max_ps( peaks, _mm256_andnot_ps( signMask, input ));
+        squares = _mm256_add_ps( squares, _mm256_mul_ps( input, input ));
+
+        _mm256_storeu_ps( outBuffer + i, _mm256_add_ps( _mm256_mul_ps( _mm256_loadu_ps( postMixBuffer + i ), wetGain ), _mm256_mul_ps( input, vDry )));
+    }
+    float maximum = reduceMax( peaks );
+    double sum    = reduceSum( squares );
+
+    for ( ; i < length; ++i )
+    {
+        float input   = inBuffer[ i ];
+        float wetGain = duckGain ? duckGain[ i ] * wet : wet;
+
+        maximum = max( maximum, fabsf( input ));
+        sum    += input * input;
+
+        outBuffer[ i ] = postMixBuffer[ i ] * wetGain + input * dry;
+    }
+    peak         = maximum;
+    sumOfSquares = sum;
+}
+
+void mixDouble( double* outBuffer, const float* postMixBuffer, const double* inBuffer, const float* duckGain,
+                float wet, float dry, int length, float& peak, double& sumOfSquares )
+{
+    const __m256d signMask = _mm256_set1_pd( -0.0 );
+    const __m256d vWet     = _mm256_set1_pd( wet );
+    const __m256d vDry     = _mm256_set1_pd( dry );
+    __m256d peaks   = _mm256_setzero_pd();
+    __m256d squares = _mm256_setzero_pd();
+    int i = 0;
+
+    for ( ; i + 4 <= length; i += 4 )
+    {
+        __m256d input     = _mm256_loadu_pd( inBuffer + i );
+        __m256d processed = _mm256_cvtps_pd( _mm_loadu_ps( postMixBuffer + i ));
+        __m256d wetGain   = duckGain ? _mm256_mul_pd( _mm256_cvtps_pd( _mm_loadu_ps( duckGain + i )), vWet ) : vWet;
+
+        peaks   = _mm256_max_pd( peaks, _mm256_andnot_pd( signMask, input ));
+        squares = _mm256_add_pd( squares, _mm256_mul_pd( input, input ));
+
+        _mm256_storeu_pd( outBuffer + i, _mm256_add_pd( _mm256_mul_pd( processed, wetGain ), _mm256_mul_pd( input, vDry )));
+    }
+    double maximum = reduceMax( peaks );
+    double sum     = reduceSum( squares );
+
+    for ( ; i < length; ++i )
+    {
+        double input   = inBuffer[ i ];
+        double wetGain = duckGain ? ( double ) duckGain[ i ] * wet : wet;
+
+        maximum = max( maximum, fabs( input ));
+        sum    += input * input;
+
+        outBuffer[ i ] = ( double ) postMixBuffer[ i ] * wetGain + input * dry;
+    }
+    peak         = ( float ) maximum;
+    sumOfSquares = sum;
+}
+
+void detectPeaksFloat( float** buffer, int numChannels, int offset, int length, float* peaks )
+{
+    const __m256 signMask = _mm256_set1_ps( -0.f );
+    int i = 0;
+
+    for ( ; i + 8 <= length; i += 8 )
+    {
+        __m256 peak = _mm256_andnot_ps( signMask, _mm256_loadu_ps( buffer[ 0 ] + offset + i ));
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = _mm256_max_ps( peak, _mm256_andnot_ps( signMask, _mm256_loadu_ps( buffer[ c ] + offset + i )));
+
+        _mm256_storeu_ps( peaks + i, peak );
+    }
+
+    for ( ; i < length; ++i )
+    {
+        float peak = fabsf( buffer[ 0 ][ offset + i ] );
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = max( peak, fabsf( buffer[ c ][ offset + i ] ));
+
+        peaks[ i ] = peak;
+    }
+}
+
+void detectPeaksDouble( double** buffer, int numChannels, int offset, int length, double* peaks )
+{
+    const __m256d signMask = _mm256_set1_pd( -0.0 );
+    int i = 0;
+
+    for ( ; i + 4 <= length; i += 4 )
+    {
+        __m256d peak = _mm256_andnot_pd( signMask, _mm256_loadu_pd( buffer[ 0 ] + offset + i ));
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = _mm256_max_pd( peak, _mm256_andnot_pd( signMask, _mm256_loadu_pd( buffer[ c ] + offset + i )));
+
+        _mm256_storeu_pd( peaks + i, peak );
+    }
+
+    for ( ; i < length; ++i )
+    {
+        double peak = fabs( buffer[ 0 ][ offset + i ] );
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = max( peak, fabs( buffer[ c ][ offset + i ] ));
+
+        peaks[ i ] = peak;
+    }
+}
+
+void applyGainFloat( float* buffer, const float* gains, int length, float& peak, double& sumOfSquares )
+{
+    const __m256 signMask = _mm256_set1_ps( -0.f );
+    __m256 peaks   = _mm256_setzero_ps();
+    __m256 squares = _mm256_setzero_ps();
+    int i = 0;
+
+    for ( ; i + 8 <= length; i += 8 )
+    {
+        __m256 samples = _mm256_mul_ps( _mm256_loadu_ps( buffer + i ), _mm256_loadu_ps( gains + i ));
+        _mm256_storeu_ps( buffer + i, samples );
+
+        peaks   = _mm256_max_ps( peaks, _mm256_andnot_ps( signMask, samples ));
+        squares = _mm256_add_ps( squares, _mm256_mul_ps( samples, samples ));
+    }
+    float maximum = reduceMax( peaks );
+    double sum    = reduceSum( squares );
+
+    for ( ; i < length; ++i )
+    {
+        buffer[ i ] *= gains[ i ];
+        maximum = max( maximum, fabsf( buffer[ i ] ));
+        sum    += buffer[ i ] * buffer[ i ];
+    }
+    peak          = max( peak, maximum );
+    sumOfSquares += sum;
+}
+
+void applyGainDouble( double* buffer, const double* gains, int length, float& peak, double& sumOfSquares )
+{
+    const __m256d signMask = _mm256_set1_pd( -0.0 );
+    __m256d peaks   = _mm256_setzero_pd();
+    __m256d squares = _mm256_setzero_pd();
+    int i = 0;
+
+    for ( ; i + 4 <= length; i += 4 )
+    {
+        __m256d samples = _mm256_mul_pd( _mm256_loadu_pd( buffer + i ), _mm256_loadu_pd( gains + i ));
+        _mm256_storeu_pd( buffer + i, samples );
+
+        peaks   = _mm256_max_pd( peaks, _mm256_andnot_pd( signMask, samples ));
+        squares = _mm256_add_pd( squares, _mm256_mul_pd( samples, samples ));
+    }
+    double maximum = reduceMax( peaks );
+    double sum     = reduceSum( squares );
+
+    for ( ; i < length; ++i )
+    {
+        buffer[ i ] *= gains[ i ];
+        maximum = max( maximum, fabs( buffer[ i ] ));
+        sum    += buffer[ i ] * buffer[ i ];
+    }
+    peak          = max( peak, ( float ) maximum );
+    sumOfSquares += sum;
+}
+
+}
+
+static const Table TABLE = {
+    &tank, &crush, &mixFloat, &mixDouble, &detectPeaksFloat, &detectPeaksDouble, &applyGainFloat, &applyGainDouble
+};
+
+const Table* getTable()
+{
+    return &TABLE;
+}
+
+}
+}
+}
+
+#else
+
+namespace Igorski {
+namespace Kernels {
+namespace AVX2 {
+
+const Table* getTable()
+{
+    return nullptr;
+}
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,328 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "kernels.h"
+#include "../global.h"
+#include <limits.h>
+#include <math.h>
+
+/**
+ * AVX-512 variant of the kernels, this translation unit is compiled with the AVX-512 Foundation
+ * instruction set enabled (see CMakeLists.txt). When built without, the variant is unavailable
+ */
+#ifdef __AVX512F__
+
+#include <immintrin.h>
+
+namespace Igorski {
+namespace Kernels {
+namespace AVX512 {
+
+// the kernels and their helpers have internal linkage, the helpers replace the inline
+// functions of headers and the standard library (see Kernels::processComb())
+
+namespace {
+
+template <typename T>
+inline T min( T a, T b )
+{
+    return ( b < a ) ? b : a;
+}
+
+template <typename T>
+inline T max( T a, T b )
+{
+    return ( a < b ) ? b : a;
+}
+
+inline double reduceSum( __m512 values )
+{
+    float lanes[ 16 ];
+    _mm512_storeu_ps( lanes, values );
+
+    double sum = 0.0;
+    for ( int i = 0; i < 16; ++i )
+        sum += lanes[ i ];
+
+    return sum;
+}
+
+inline double reduceSum( __m512d values )
+{
+    double lanes[ 8 ];
+    _mm512_storeu_pd( lanes, values );
+
+    double sum = 0.0;
+    for ( int i = 0; i < 8; ++i )
+        sum += lanes[ i ];
+
+    return sum;
+}
+
+void crush( float* buffer, int length, float inputScale, float outputScale, int mask, int offset )
+{
+    int i = 0;
+
+    // 16 samples at a time: narrowed to shorts (saturating), masked and widened (sign extending)
+
+    const __m512  vInputScale  = _mm512_set1_ps( inputScale );
+    const __m512  vOutputScale = _mm512_set1_ps( outputScale );
+    const __m256i vMask        = _mm256_set1_epi16(( short ) mask );
+    const __m512i vOffset      = _mm512_set1_epi32( offset );
+
+    for ( ; i + 16 <= length; i += 16 )
+    {
+        __m512i scaled  = _mm512_cvttps_epi32( _mm512_mul_ps( _mm512_loadu_ps( buffer + i ), vInputScale ));
+        __m256i crushed = _mm256_and_si256( _mm512_cvtsepi32_epi16( scaled ), vMask );
+
+        scaled = _mm512_add_epi32( _mm512_cvtepi16_epi32( crushed ), vOffset );
+
+        _mm512_storeu_ps( buffer + i, _mm512_mul_ps( _mm512_cvtepi32_ps( scaled ), vOutputScale ));
+    }
+
+    // remaining samples (saturated to the 16-bit range, same as the vectorized loop)
+
+    for ( ; i < length; ++i )
+    {
+        float scaled = min(( float ) SHRT_MAX, max(( float ) SHRT_MIN, buffer[ i ] * inputScale ));
+        short input  = ( short ) scaled;
+        input &= mask;
+        buffer[ i ] = ( input + offset ) * outputScale;
+    }
+}
+
+void mixFloat( float* outBuffer, const float* postMixBuffer, const float* inBuffer, const float* duckGain,
+               float wet, float dry, int length, float& peak, double& sumOfSquares )
+{
+    const __m512 vWet = _mm512_set1_ps( wet );
+    const __m512 vDry = _mm512_set1_ps( dry );
+    __m512 peaks   = _mm512_setzero_ps();
+    __m512 squares = _mm512_setzero_ps();
+    int i = 0;
+
+    for ( ; i + 16 <= length; i += 16 )
+    {
+        __m512 input   = _mm512_loadu_ps( inBuffer + i );
+        __m512 wetGain = duckGain ? _mm512_mul_ps( _mm512_loadu_ps( duckGain + i ), vWet ) : vWet;
+
+        peaks   = _mm512_max_ps( peaks, _mm512_abs_ps( input ));
+        squares = _mm512_add_ps( squares, _mm512_mul_ps( input, input ));
+
+        _mm512_storeu_ps( outBuffer + i, _mm512_add_ps( _mm512_mul_ps( _mm512_loadu_ps( postMixBuffer + i ), wetGain ), _mm512_mul_ps( input, vDry )));
+    }
+    float maximum = _mm512_reduce_max_ps( peaks );
+    double sum    = reduceSum( squares );
+
+    for ( ; i < length; ++i )
+    {
+        float input   = inBuffer[ i ];
+        float wetGain = duckGain ? duckGain[ i ] * wet : wet;
+
+        maximum = max( maximum, fabsf( input ));
+        sum    += input * input;
+
+        outBuffer[ i ] = postMixBuffer[ i ] * wetGain + input * dry;
+    }
+    peak         = maximum;
+    sumOfSquares = sum;
+}
+
+void mixDouble( double* outBuffer, const float* postMixBuffer, const double* inBuffer, const float* duckGain,
+                float wet, float dry, int length, float& peak, double& sumOfSquares )
+{
+    const __m512d vWet = _mm512_set1_pd( wet );
+    const __m512d vDry = _mm512_set1_pd( dry );
+    __m512d peaks   = _mm512_setzero_pd();
+    __m512d squares = _mm512_setzero_pd();
+    int i = 0;
+
+    for ( ; i + 8 <= length; i += 8 )
+    {
+        __m512d input     = _mm512_loadu_pd( inBuffer + i );
+        __m512d processed = _mm512_cvtps_pd( _mm256_loadu_ps( postMixBuffer + i ));
+        __m512d wetGain   = duckGain ? _mm512_mul_pd( _mm512_cvtps_pd( _mm256_loadu_ps( duckGain + i )), vWet ) : vWet;
+
+        peaks   = _mm512_max_pd( peaks, _mm512_abs_pd( input ));
+        squares = _mm512_add_pd( squares, _mm512_mul_pd( input, input ));
+
+        _mm512_storeu_pd( outBuffer + i, _mm512_add_pd( _mm512_mul_pd( processed, wetGain ), _mm512_mul_pd( input, vDry )));
+    }
+    double maximum = _mm512_reduce_max_pd( peaks );
+    double sum     = reduceSum( squares );
+
+    for ( ; i < length; ++i )
+    {
+        double input   = inBuffer[ i ];
+        double wetGain = duckGain ? ( double ) duckGain[ i ] * wet : wet;
+
+        maximum = max( maximum, fabs( input ));
+        sum    += input * input;
+
+        outBuffer[ i ] = ( double ) postMixBuffer[ i ] * wetGain + input * dry;
+    }
+    peak         = ( float ) maximum;
+    sumOfSquares = sum;
+}
+
+void detectPeaksFloat( float** buffer, int numChannels, int offset, int length, float* peaks )
+{
+    int i = 0;
+
+    for ( ; i + 16 <= length; i += 16 )
+    {
+        __m512 peak = _mm512_abs_ps( _mm512_loadu_ps( buffer[ 0 ] + offset + i ));
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = _mm512_max_ps( peak, _mm512_abs_ps( _mm512_loadu_ps( buffer[ c ] + offset + i )));
+
+        _mm512_storeu_ps( peaks + i, peak );
+    }
+
+    for ( ; i < length; ++i )
+    {
+        float peak = fabsf( buffer[ 0 ][ offset + i ] );
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = max( peak, fabsf( buffer[ c ][ offset + i ] ));
+
+        peaks[ i ] = peak;
+    }
+}
+
+void detectPeaksDouble( double** buffer, int numChannels, int offset, int length, double* peaks )
+{
+    int i = 0;
+
+    for ( ; i + 8 <= length; i += 8 )
+    {
+        __m512d peak = _mm512_abs_pd( _mm512_loadu_pd( buffer[ 0 ] + offset + i ));
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = _mm512_max_pd( peak, _mm512_abs_pd( _mm512_loadu_pd( buffer[ c ] + offset + i )));
+
+        _mm512_storeu_pd( peaks + i, peak );
+    }
+
+    for ( ; i < length; ++i )
+    {
+        double peak = fabs( buffer[ 0 ][ offset + i ] );
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = max( peak, fabs( buffer[ c ][ offset + i ] ));
+
+        peaks[ i ] = peak;
+    }
+}
+
+void applyGainFloat( float* buffer, const float* gains, int length, float& peak, double& sumOfSquares )
+{
+    __m512 peaks   = _mm512_setzero_ps();
+    __m512 squares = _mm512_setzero_ps();
+    int i = 0;
+
+    for ( ; i + 16 <= length; i += 16 )
+    {
+        __m512 samples = _mm512_mul_ps( _mm512_loadu_ps( buffer + i ), _mm512_loadu_ps( gains + i ));
+        _mm512_storeu_ps( buffer + i, samples );
+
+        peaks   = _mm512_max_ps( peaks, _mm512_abs_ps( samples ));
+        squares = _mm512_add_ps( squares, _mm512_mul_ps( samples, samples ));
+    }
+    float maximum = _mm512_reduce_max_ps( peaks );
+    double sum    = reduceSum( squares );
+
+    for ( ; i < length; ++i )
+    {
+        buffer[ i ] *= gains[ i ];
+        maximum = max( maximum, fabsf( buffer[ i ] ));
+        sum    += buffer[ i ] * buffer[ i ];
+    }
+    peak          = max( peak, maximum );
+    sumOfSquares += sum;
+}
+
+void applyGainDouble( double* buffer, const double* gains, int length, float& peak, double& sumOfSquares )
+{
+    __m512d peaks   = _mm512_setzero_pd();
+    __m512d squares = _mm512_setzero_pd();
+    int i = 0;
+
+    for ( ; i + 8 <= length; i += 8 )
+    {
+        __m512d samples = _mm512_mul_pd( _mm512_loadu_pd( buffer + i ), _mm512_loadu_pd( gains + i ));
+        _mm512_storeu_pd( buffer + i, samples );
+
+        peaks   = _mm512_max_pd( peaks, _mm512_abs_pd( samples ));
+        squares = _mm512_add_pd( squares, _mm512_mul_pd( samples, samples ));
+    }
+    double maximum = _mm512_reduce_max_pd( peaks );
+    double sum     = reduceSum( squares );
+
+    for ( ; i < length; ++i )
+    {
+        buffer[ i ] *= gains[ i ];
+        maximum = max( maximum, fabs( buffer[ i ] ));
+        sum    += buffer[ i ] * buffer[ i ];
+    }
+    peak          = max( peak, ( float ) maximum );
+    sumOfSquares += sum;
+}
+
+}
+
+const Table* getTable()
+{
+    // the reverb tank is bound by the recursion of the comb filters rather than the vector width
+    // (the eight combs of a channel occupy a 256-bit vector), as such the tank of the AVX2 variant
+    // is used (AVX2 being supported by all AVX-512 capable CPUs)
+
+    const Table* avx2 = AVX2::getTable();
+
+    if ( avx2 == nullptr )
+        return nullptr;
+
+    static const Table TABLE = {
+        avx2->tank, &crush, &mixFloat, &mixDouble, &detectPeaksFloat, &detectPeaksDouble, &applyGainFloat, &applyGainDouble
+    };
+    return &TABLE;
+}
+
+}
+}
+}
+
+#else
+
+namespace Igorski {
+namespace Kernels {
+namespace AVX512 {
+
+const Table* getTable()
+{
+    return nullptr;
+}
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,477 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "kernels.h"
+#include "../global.h"
+#include "../simd.h"
+#include <algorithm>
+#include <limits.h>
+#include <math.h>
+
+namespace Igorski {
+namespace Kernels {
+namespace Baseline {
+
+#ifdef FOGPAD_SSE2
+
+// the comb filters are processed in groups of four, each comb occupying a lane of a vector.
+// Four samples are read from each delay line at once, these are transposed to update the
+// recursive filter stores of the group at once for each sample, after which the values
+// to write into the delay lines are transposed back
+
+static const int LANES  = 4;
+static const int GROUPS = VST::NUM_COMBS / LANES;
+
+static_assert( VST::NUM_COMBS % LANES == 0, "the comb filters must fill all lanes of the vectors" );
+
+inline __m128 readDelay( const Comb::State* state )
+{
+    const float* buffer = state->buffer;
+    int index = state->index;
+
+    if ( index + LANES <= state->size )
+        return _mm_loadu_ps( buffer + index );
+
+    // the samples wrap around the end of the delay line
+
+    float samples[ LANES ];
+    for ( int i = 0; i < LANES; ++i, ++index )
+        samples[ i ] = buffer[ index < state->size ? index : index - state->size ];
+
+    return _mm_loadu_ps( samples );
+}
+
+inline void writeDelay( Comb::State* state, __m128 values )
+{
+    float* buffer = state->buffer;
+    int index = state->index;
+
+    if ( index + LANES <= state->size ) {
+        _mm_storeu_ps( buffer + index, values );
+    }
+    else {
+        float samples[ LANES ];
+        _mm_storeu_ps( samples, values );
+
+        for ( int i = 0; i < LANES; ++i, ++index )
+            buffer[ index < state->size ? index : index - state->size ] = samples[ i ];
+    }
+    if (( state->index += LANES ) >= state->size )
+        state->index -= state->size;
+}
+
+#endif
+
+void tank( Comb::State** states, AllPass::State** allPasses, float* buffer, int length )
+{
+    int i = 0;
+#ifdef FOGPAD_SSE2
+    bool fitsLanes = true;
+
+    for ( int k = 0; k < VST::NUM_COMBS; ++k )
+        fitsLanes = fitsLanes && states[ k ]->size >= LANES;
+
+    if ( fitsLanes )
+    {
+        __m128 feedback[ GROUPS ], damp1[ GROUPS ], damp2[ GROUPS ], filterStore[ GROUPS ];
+
+        for ( int g = 0; g < GROUPS; ++g ) {
+            Comb::State** group = states + g * LANES;
+
+            feedback[ g ]    = _mm_setr_ps( group[ 0 ]->feedback,    group[ 1 ]->feedback,    group[ 2 ]->feedback,    group[ 3 ]->feedback );
+            damp1[ g ]       = _mm_setr_ps( group[ 0 ]->damp1,       group[ 1 ]->damp1,       group[ 2 ]->damp1,       group[ 3 ]->damp1 );
+            damp2[ g ]       = _mm_setr_ps( group[ 0 ]->damp2,       group[ 1 ]->damp2,       group[ 2 ]->damp2,       group[ 3 ]->damp2 );
+            filterStore[ g ] = _mm_setr_ps( group[ 0 ]->filterStore, group[ 1 ]->filterStore, group[ 2 ]->filterStore, group[ 3 ]->filterStore );
+        }
+
+        for ( ; i + LANES <= length; i += LANES )
+        {
+            __m128 outputs[ VST::NUM_COMBS ];
+
+            for ( int g = 0; g < GROUPS; ++g )
+            {
+                // transpose the delayed samples (a vector per comb) into a vector per sample
+
+                __m128 samples[ LANES ];
+                for ( int k = 0; k < LANES; ++k )
+                    samples[ k ] = outputs[ g * LANES + k ] = readDelay( states[ g * LANES + k ]);
+
+                _MM_TRANSPOSE4_PS( samples[ 0 ], samples[ 1 ], samples[ 2 ], samples[ 3 ] );
+
+                __m128 store = filterStore[ g ];
+
+                for ( int j = 0; j < LANES; ++j ) {
+                    store        = _mm_add_ps( _mm_mul_ps( samples[ j ], damp2[ g ] ), _mm_mul_ps( store, damp1[ g ] ));
+                    samples[ j ] = _mm_add_ps( _mm_set1_ps( buffer[ i + j ] ), _mm_mul_ps( store, feedback[ g ] ));
+                }
+                filterStore[ g ] = store;
+
+                _MM_TRANSPOSE4_PS( samples[ 0 ], samples[ 1 ], samples[ 2 ], samples[ 3 ] );
+
+                for ( int k = 0; k < LANES; ++k )
+                    writeDelay( states[ g * LANES + k ], samples[ k ] );
+            }
+
+            // accumulate the combs in order
+
+            __m128 sum = _mm_setzero_ps();
+            for ( int k = 0; k < VST::NUM_COMBS; ++k )
+                sum = _mm_add_ps( sum, outputs[ k ] );
+
+            _mm_storeu_ps( buffer + i, sum );
+        }
+
+        for ( int g = 0; g < GROUPS; ++g ) {
+            float stores[ LANES ];
+            _mm_storeu_ps( stores, filterStore[ g ] );
+
+            for ( int k = 0; k < LANES; ++k )
+                states[ g * LANES + k ]->filterStore = stores[ k ];
+        }
+    }
+#endif
+    // remaining samples (or all samples when SIMD is unavailable)
+
+    for ( ; i < length; ++i )
+    {
+        float input = buffer[ i ];
+        float sum   = 0.f;
+
+        for ( int k = 0; k < VST::NUM_COMBS; ++k )
+            sum += processComb( states[ k ], input );
+
+        buffer[ i ] = sum;
+    }
+
+    // the allpass filters are applied in series, each onto the full buffer. Within the range
+    // up to the end of the delay line, each sample of the delay line is read and written once
+
+    for ( int a = 0; a < VST::NUM_ALLPASSES; ++a )
+    {
+        AllPass::State* state = allPasses[ a ];
+
+        for ( i = 0; i < length; )
+        {
+            int range     = std::min( length - i, state->size - state->index );
+            float* delay  = state->buffer + state->index;
+            float* output = buffer + i;
+            int j = 0;
+#ifdef FOGPAD_SSE2
+            const __m128 feedback = _mm_set1_ps( state->feedback );
+
+            for ( ; j + 4 <= range; j += 4 )
+            {
+                __m128 input   = _mm_loadu_ps( output + j );
+                __m128 delayed = _mm_loadu_ps( delay + j );
+
+                _mm_storeu_ps( output + j, _mm_sub_ps( delayed, input ));
+                _mm_storeu_ps( delay + j,  _mm_add_ps( input, _mm_mul_ps( delayed, feedback )));
+            }
+#endif
+            for ( ; j < range; ++j )
+            {
+                float input   = output[ j ];
+                float delayed = delay[ j ];
+
+                output[ j ] = delayed - input;
+                delay[ j ]  = input + ( delayed * state->feedback );
+            }
+            i += range;
+
+            if (( state->index += range ) >= state->size )
+                state->index = 0;
+        }
+    }
+}
+
+void crush( float* buffer, int length, float inputScale, float outputScale, int mask, int offset )
+{
+    int i = 0;
+
+#ifdef FOGPAD_SSE2
+    // 8 samples at a time: two vectors of 4 floats are packed into a single vector of
+    // 8 shorts (saturating), masked and unpacked (sign extending) to floats again
+
+    const __m128  vInputScale  = _mm_set1_ps( inputScale );
+    const __m128  vOutputScale = _mm_set1_ps( outputScale );
+    const __m128i vMask        = _mm_set1_epi16(( short ) mask );
+    const __m128i vOffset      = _mm_set1_epi32( offset );
+
+    for ( ; i + 8 <= length; i += 8 )
+    {
+        __m128i low  = _mm_cvttps_epi32( _mm_mul_ps( _mm_loadu_ps( buffer + i ),     vInputScale ));
+        __m128i high = _mm_cvttps_epi32( _mm_mul_ps( _mm_loadu_ps( buffer + i + 4 ), vInputScale ));
+
+        __m128i crushed = _mm_and_si128( _mm_packs_epi32( low, high ), vMask );
+
+        low  = _mm_add_epi32( _mm_srai_epi32( _mm_unpacklo_epi16( crushed, crushed ), 16 ), vOffset );
+        high = _mm_add_epi32( _mm_srai_epi32( _mm_unpackhi_epi16( crushed, crushed ), 16 ), vOffset );
+
+        _mm_storeu_ps( buffer + i,     _mm_mul_ps( _mm_cvtepi32_ps( low ),  vOutputScale ));
+        _mm_storeu_ps( buffer + i + 4, _mm_mul_ps( _mm_cvtepi32_ps( high ), vOutputScale ));
+    }
+#endif
+
+    // remaining samples (or all samples when SIMD is unavailable)
+    // note the input is saturated to the 16-bit range, same as the SIMD kernel
+
+    for ( ; i < length; ++i )
+    {
+        float scaled = std::min(( float ) SHRT_MAX, std::max(( float ) SHRT_MIN, buffer[ i ] * inputScale ));
+        short input  = ( short ) scaled;
+        input &= mask;
+        buffer[ i ] = ( input + offset ) * outputScale;
+    }
+}
+
+void mixFloat( float* outBuffer, const float* postMixBuffer, const float* inBuffer, const float* duckGain,
+               float wet, float dry, int length, float& peak, double& sumOfSquares )
+{
+    int i = 0;
+    float maximum = 0.f;
+    double sum    = 0.0;
+#ifdef FOGPAD_SSE2
+    const __m128 signMask = _mm_set1_ps( -0.f );
+    const __m128 vWet     = _mm_set1_ps( wet );
+    const __m128 vDry     = _mm_set1_ps( dry );
+    __m128 peaks   = _mm_setzero_ps();
+    __m128 squares = _mm_setzero_ps();
+
+    for ( ; i + 4 <= length; i += 4 )
+    {
+        __m128 input   = _mm_loadu_ps( inBuffer + i );
+        __m128 wetGain = duckGain ? _mm_mul_ps( _mm_loadu_ps( duckGain + i ), vWet ) : vWet;
+
+        peaks   = _mm_max_ps( peaks, _mm_andnot_ps( signMask, input ));
+        squares = _mm_add_ps( squares, _mm_mul_ps( input, input ));
+
+        _mm_storeu_ps( outBuffer + i, _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( postMixBuffer + i ), wetGain ), _mm_mul_ps( input, vDry )));
+    }
+    float lanes[ 4 ];
+    _mm_storeu_ps( lanes, peaks );
+    maximum = std::max( std::max( lanes[ 0 ], lanes[ 1 ] ), std::max( lanes[ 2 ], lanes[ 3 ] ));
+    _mm_storeu_ps( lanes, squares );
+    sum = ( double ) lanes[ 0 ] + lanes[ 1 ] + lanes[ 2 ] + lanes[ 3 ];
+#endif
+    for ( ; i < length; ++i )
+    {
+        float input   = inBuffer[ i ];
+        float wetGain = duckGain ? duckGain[ i ] * wet : wet;
+
+        maximum = std::max( maximum, fabsf( input ));
+        sum    += input * input;
+
+        outBuffer[ i ] = postMixBuffer[ i ] * wetGain + input * dry;
+    }
+    peak         = maximum;
+    sumOfSquares = sum;
+}
+
+void mixDouble( double* outBuffer, const float* postMixBuffer, const double* inBuffer, const float* duckGain,
+                float wet, float dry, int length, float& peak, double& sumOfSquares )
+{
+    int i = 0;
+    double maximum = 0.0;
+    double sum     = 0.0;
+#ifdef FOGPAD_SSE2
+    const __m128d signMask = _mm_set1_pd( -0.0 );
+    const __m128d vWet     = _mm_set1_pd( wet );
+    const __m128d vDry     = _mm_set1_pd( dry );
+    __m128d peaks   = _mm_setzero_pd();
+    __m128d squares = _mm_setzero_pd();
+
+    for ( ; i + 2 <= length; i += 2 )
+    {
+        __m128d input     = _mm_loadu_pd( inBuffer + i );
+        __m128d processed = _mm_cvtps_pd( _mm_castsi128_ps( _mm_loadl_epi64(( const __m128i* )( postMixBuffer + i ))));
+        __m128d wetGain   = duckGain ? _mm_mul_pd( _mm_cvtps_pd( _mm_castsi128_ps( _mm_loadl_epi64(( const __m128i* )( duckGain + i )))), vWet ) : vWet;
+
+        peaks   = _mm_max_pd( peaks, _mm_andnot_pd( signMask, input ));
+        squares = _mm_add_pd( squares, _mm_mul_pd( input, input ));
+
+        _mm_storeu_pd( outBuffer + i, _mm_add_pd( _mm_mul_pd( processed, wetGain ), _mm_mul_pd( input, vDry )));
+    }
+    double lanes[ 2 ];
+    _mm_storeu_pd( lanes, peaks );
+    maximum = std::max( lanes[ 0 ], lanes[ 1 ] );
+    _mm_storeu_pd( lanes, squares );
+    sum = lanes[ 0 ] + lanes[ 1 ];
+#endif
+    for ( ; i < length; ++i )
+    {
+        double input   = inBuffer[ i ];
+        double wetGain = duckGain ? ( double ) duckGain[ i ] * wet : wet;
+
+        maximum = std::max( maximum, fabs( input ));
+        sum    += input * input;
+
+        outBuffer[ i ] = ( double ) postMixBuffer[ i ] * wetGain + input * dry;
+    }
+    peak         = ( float ) maximum;
+    sumOfSquares = sum;
+}
+
+void detectPeaksFloat( float** buffer, int numChannels, int offset, int length, float* peaks )
+{
+    int i = 0;
+#ifdef FOGPAD_SSE2
+    // the absolute value is obtained by clearing the sign bit, the peak for four
+    // sample frames is determined at once by taking the maximum across the channels
+
+    const __m128 signMask = _mm_set1_ps( -0.f );
+
+    for ( ; i + 4 <= length; i += 4 )
+    {
+        __m128 peak = _mm_andnot_ps( signMask, _mm_loadu_ps( buffer[ 0 ] + offset + i ));
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = _mm_max_ps( peak, _mm_andnot_ps( signMask, _mm_loadu_ps( buffer[ c ] + offset + i )));
+
+        _mm_storeu_ps( peaks + i, peak );
+    }
+#endif
+    for ( ; i < length; ++i )
+    {
+        float peak = fabsf( buffer[ 0 ][ offset + i ] );
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = std::max( peak, fabsf( buffer[ c ][ offset + i ] ));
+
+        peaks[ i ] = peak;
+    }
+}
+
+void detectPeaksDouble( double** buffer, int numChannels, int offset, int length, double* peaks )
+{
+    int i = 0;
+#ifdef FOGPAD_SSE2
+    const __m128d signMask = _mm_set1_pd( -0.0 );
+
+    for ( ; i + 2 <= length; i += 2 )
+    {
+        __m128d peak = _mm_andnot_pd( signMask, _mm_loadu_pd( buffer[ 0 ] + offset + i ));
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = _mm_max_pd( peak, _mm_andnot_pd( signMask, _mm_loadu_pd( buffer[ c ] + offset + i )));
+
+        _mm_storeu_pd( peaks + i, peak );
+    }
+#endif
+    for ( ; i < length; ++i )
+    {
+        double peak = fabs( buffer[ 0 ][ offset + i ] );
+
+        for ( int c = 1; c < numChannels; ++c )
+            peak = std::max( peak, fabs( buffer[ c ][ offset + i ] ));
+
+        peaks[ i ] = peak;
+    }
+}
+
+void applyGainFloat( float* buffer, const float* gains, int length, float& peak, double& sumOfSquares )
+{
+    int i = 0;
+    float maximum = 0.f;
+    double sum    = 0.0;
+#ifdef FOGPAD_SSE2
+    const __m128 signMask = _mm_set1_ps( -0.f );
+    __m128 peaks   = _mm_setzero_ps();
+    __m128 squares = _mm_setzero_ps();
+
+    for ( ; i + 4 <= length; i += 4 )
+    {
+        __m128 samples = _mm_mul_ps( _mm_loadu_ps( buffer + i ), _mm_loadu_ps( gains + i ));
+        _mm_storeu_ps( buffer + i, samples );
+
+        peaks   = _mm_max_ps( peaks, _mm_andnot_ps( signMask, samples ));
+        squares = _mm_add_ps( squares, _mm_mul_ps( samples, samples ));
+    }
+    float lanes[ 4 ];
+    _mm_storeu_ps( lanes, peaks );
+    maximum = std::max( std::max( lanes[ 0 ], lanes[ 1 ] ), std::max( lanes[ 2 ], lanes[ 3 ] ));
+    _mm_storeu_ps( lanes, squares );
+    sum = ( double ) lanes[ 0 ] + lanes[ 1 ] + lanes[ 2 ] + lanes[ 3 ];
+#endif
+    for ( ; i < length; ++i )
+    {
+        buffer[ i ] *= gains[ i ];
+        maximum = std::max( maximum, fabsf( buffer[ i ] ));
+        sum    += buffer[ i ] * buffer[ i ];
+    }
+    peak          = std::max( peak, maximum );
+    sumOfSquares += sum;
+}
+
+void applyGainDouble( double* buffer, const double* gains, int length, float& peak, double& sumOfSquares )
+{
+    int i = 0;
+    double maximum = 0.0;
+    double sum     = 0.0;
+#ifdef FOGPAD_SSE2
+    const __m128d signMask = _mm_set1_pd( -0.0 );
+    __m128d peaks   = _mm_setzero_pd();
+    __m128d squares = _mm_setzero_pd();
+
+    for ( ; i + 2 <= length; i += 2 )
+    {
+        __m128d samples = _mm_mul_pd( _mm_loadu_pd( buffer + i ), _mm_loadu_pd( gains + i ));
+        _mm_storeu_pd( buffer + i, samples );
+
+        peaks   = _mm_max_pd( peaks, _mm_andnot_pd( signMask, samples ));
+        squares = _mm_add_pd( squares, _mm_mul_pd( samples, samples ));
+    }
+    double lanes[ 2 ];
+    _mm_storeu_pd( lanes, peaks );
+    maximum = std::max( lanes[ 0 ], lanes[ 1 ] );
+    _mm_storeu_pd( lanes, squares );
+    sum = lanes[ 0 ] + lanes[ 1 ];
+#endif
+    for ( ; i < length; ++i )
+    {
+        buffer[ i ] *= gains[ i ];
+        maximum = std::max( maximum, fabs( buffer[ i ] ));
+        sum    += buffer[ i ] * buffer[ i ];
+    }
+    peak          = std::max( peak, ( float ) maximum );
+    sumOfSquares += sum;
+}
+
+static const Table TABLE = {
+    &tank, &crush, &mixFloat, &mixDouble, &detectPeaksFloat, &detectPeaksDouble, &applyGainFloat, &applyGainDouble
+};
+
+const Table* getTable()
+{
+    return &TABLE;
+}
+
+}
+
+// the baseline is in use until a variant is selected (see select())
+
+Table table = {
+    &Baseline::tank, &Baseline::crush, &Baseline::mixFloat, &Baseline::mixDouble,
+    &Baseline::detectPeaksFloat, &Baseline::detectPeaksDouble, &Baseline::applyGainFloat, &Baseline::applyGainDouble
+};
+
+}
+}
@@ -0,0 +1,159 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "kernels.h"
+
+#if defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ))
+#include <intrin.h>
+#define FOGPAD_CPUID 1
+#elif ( defined( __GNUC__ ) || defined( __clang__ )) && ( defined( __x86_64__ ) || defined( __i386__ ))
+#include <cpuid.h>
+#define FOGPAD_CPUID 1
+#endif
+
+namespace Igorski {
+namespace Kernels {
+
+const char* ISA_NAMES[ ISA_AMOUNT ] = { "baseline", "avx2", "avx512" };
+
+static ISA selected = ISA_BASELINE;
+
+#ifdef FOGPAD_CPUID
+
+// queries the registers of given cpuid leaf
+
+static void cpuid( int leaf, int subleaf, unsigned int registers[ 4 ] )
+{
+#ifdef _MSC_VER
+    int values[ 4 ];
+    __cpuidex( values, leaf, subleaf );
+    for ( int i = 0; i < 4; ++i )
+        registers[ i ] = ( unsigned int ) values[ i ];
+#else
+    __cpuid_count( leaf, subleaf, registers[ 0 ], registers[ 1 ], registers[ 2 ], registers[ 3 ] );
+#endif
+}
+
+// the register states enabled by the operating system (XCR0)
+
+static unsigned long long getEnabledStates()
+{
+#ifdef _MSC_VER
+    return _xgetbv( 0 );
+#else
+    unsigned int eax, edx;
+    __asm__ __volatile__( "xgetbv" : "=a"( eax ), "=d"( edx ) : "c"( 0 ));
+    return (( unsigned long long ) edx << 32 ) | eax;
+#endif
+}
+
+static bool isSupportedByCPU( ISA isa )
+{
+    if ( isa == ISA_BASELINE )
+        return true;
+
+    unsigned int registers[ 4 ]; // eax, ebx, ecx, edx
+
+    cpuid( 0, 0, registers );
+    if ( registers[ 0 ] < 7 )
+        return false;
+
+    // the wider registers can only be used when the operating system preserves their state (OSXSAVE)
+
+    cpuid( 1, 0, registers );
+    if (( registers[ 2 ] & ( 1u << 27 )) == 0 )
+        return false;
+
+    unsigned long long states = getEnabledStates();
+
+    cpuid( 7, 0, registers );
+
+    switch ( isa ) {
+        default:
+            return false;
+
+        case ISA_AVX2:
+            // XMM and YMM state, AVX2
+            return ( states & 0x06 ) == 0x06 && ( registers[ 1 ] & ( 1u << 5 )) != 0;
+
+        case ISA_AVX512:
+            // XMM, YMM, opmask and ZMM state, AVX-512 Foundation
+            return ( states & 0xe6 ) == 0xe6 && ( registers[ 1 ] & ( 1u << 16 )) != 0;
+    }
+}
+
+#else
+
+static bool isSupportedByCPU( ISA isa )
+{
+    return isa == ISA_BASELINE;
+}
+
+#endif
+
+static const Table* getTable( ISA isa )
+{
+    switch ( isa ) {
+        default:
+        case ISA_BASELINE:
+            return Baseline::getTable();
+        case ISA_AVX2:
+            return AVX2::getTable();
+        case ISA_AVX512:
+            return AVX512::getTable();
+    }
+}
+
+bool isSupported( ISA isa )
+{
+    return isa >= ISA_BASELINE && isa < ISA_AMOUNT && getTable( isa ) != nullptr && isSupportedByCPU( isa );
+}
+
+ISA select()
+{
+    for ( int isa = ISA_AMOUNT - 1; isa > ISA_BASELINE; --isa ) {
+        if ( select(( ISA ) isa ))
+            return ( ISA ) isa;
+    }
+    select( ISA_BASELINE );
+
+    return ISA_BASELINE;
+}
+
+bool select( ISA isa )
+{
+    if ( !isSupported( isa ))
+        return false;
+
+    table    = *getTable( isa );
+    selected = isa;
+
+    return true;
+}
+
+ISA getSelected()
+{
+    return selected;
+}
+
+}
+}
@@ -0,0 +1,187 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __KERNELS_H_INCLUDED__
+#define __KERNELS_H_INCLUDED__
+
+#include "../global.h"
+#include "../calc.h"
+#include "../comb.h"
+#include "../allpass.h"
+
+namespace Igorski {
+
+/**
+ * Kernels provides the vectorized inner loops of the processing stages in a variant
+ * for each supported instruction set. The variants are compiled separately (each translation
+ * unit using the compiler flags of its instruction set) and are equal in output (the floating
+ * point operations are performed in the same order, without contraction into fused
+ * multiply-adds). The best variant supported by the CPU is selected once, when the
+ * plugin module is loaded (see select()), until then the SSE2 baseline is used
+ *
+ * The Filter is not dispatched: its biquad is a per sample recursion (with coefficients
+ * recalculated by the LFO) which does not vectorize within a channel. The AVX-512 variant
+ * uses the tank of the AVX2 variant, as the eight combs of a channel occupy a 256-bit
+ * vector and the tank is bound by the latency of their recursion rather than the vector width
+ */
+namespace Kernels {
+
+    enum ISA {
+        ISA_BASELINE = 0, // SSE2 (part of the x86-64 baseline), scalar on other architectures
+        ISA_AVX2,
+        ISA_AVX512,
+        ISA_AMOUNT
+    };
+
+    extern const char* ISA_NAMES[ ISA_AMOUNT ];
+
+    struct Table {
+
+        // processes given buffer in place through the reverb tank of a single channel:
+        // the comb filters in parallel (accumulating their output) followed by the allpass
+        // filters in series (see ReverbProcess, VST::NUM_COMBS and VST::NUM_ALLPASSES)
+        // the filters are provided by their state, as the variants may not invoke the
+        // inline methods of the filters (see processComb())
+
+        void ( *tank )( Comb::State** combs, AllPass::State** allPasses, float* buffer, int length );
+
+        // reduces the resolution of given buffer (see BitCrusher)
+
+        void ( *crush )( float* buffer, int length, float inputScale, float outputScale, int mask, int offset );
+
+        // mixes the dry input and processed post mix signal into the output, providing the peak
+        // and sum of squares of the input. When provided, duckGain specifies the gain of the wet
+        // signal for each sample. The output may share its memory with either of the inputs
+
+        void ( *mixFloat  )( float* outBuffer, const float* postMixBuffer, const float* inBuffer, const float* duckGain,
+                             float wet, float dry, int length, float& peak, double& sumOfSquares );
+        void ( *mixDouble )( double* outBuffer, const float* postMixBuffer, const double* inBuffer, const float* duckGain,
+                             float wet, float dry, int length, float& peak, double& sumOfSquares );
+
+        // writes the absolute peak across all channels for each sample frame in the
+        // given range of the buffer into peaks (see Limiter)
+
+        void ( *detectPeaksFloat  )( float** buffer, int numChannels, int offset, int length, float* peaks );
+        void ( *detectPeaksDouble )( double** buffer, int numChannels, int offset, int length, double* peaks );
+
+        // multiplies each sample in given buffer by its corresponding gain, accumulating
+        // the peak and sum of squares of the resulting samples (see Limiter)
+
+        void ( *applyGainFloat  )( float* buffer, const float* gains, int length, float& peak, double& sumOfSquares );
+        void ( *applyGainDouble )( double* buffer, const double* gains, int length, float& peak, double& sumOfSquares );
+    };
+
+    // the kernels in use
+
+    extern Table table;
+
+    // whether given instruction set is supported by both the build and the CPU (and operating system)
+
+    bool isSupported( ISA isa );
+
+    // selects the kernels of the best supported instruction set, returning the instruction set
+    // this should be invoked once, prior to processing (i.e. not while the kernels are in use)
+
+    ISA select();
+
+    // selects the kernels of given instruction set (for comparison of the variants)
+    // returns false (leaving the current selection unchanged) when unsupported
+
+    bool select( ISA isa );
+
+    ISA getSelected();
+
+    // the entry points to the selected kernels
+
+    inline void tank( Comb** combs, AllPass** allPasses, float* buffer, int length ) {
+        Comb::State* combStates[ VST::NUM_COMBS ];
+        AllPass::State* allPassStates[ VST::NUM_ALLPASSES ];
+
+        for ( int i = 0; i < VST::NUM_COMBS; ++i )
+            combStates[ i ] = combs[ i ]->getState();
+
+        for ( int i = 0; i < VST::NUM_ALLPASSES; ++i )
+            allPassStates[ i ] = allPasses[ i ]->getState();
+
+        table.tank( combStates, allPassStates, buffer, length );
+    }
+
+    // processes a single sample through the comb filter of given state (equal to Comb::process())
+    // The variants are compiled with the flags of their instruction set: an inline function with
+    // external linkage (e.g. of a header or the standard library) used within a variant could be
+    // the copy the linker selects for all callers, executing unsupported instructions on other
+    // CPUs. As such the variants only use functions with internal linkage, like this one
+
+    static inline float processComb( Comb::State* state, float input )
+    {
+        float output = state->buffer[ state->index ];
+        undenormalise( output );
+
+        state->filterStore = ( output * state->damp2 ) + ( state->filterStore * state->damp1 );
+        undenormalise( state->filterStore );
+
+        state->buffer[ state->index ] = input + ( state->filterStore * state->feedback );
+        if ( ++state->index >= state->size ) {
+            state->index = 0;
+        }
+        return output;
+    }
+
+    inline void crush( float* buffer, int length, float inputScale, float outputScale, int mask, int offset ) {
+        table.crush( buffer, length, inputScale, outputScale, mask, offset );
+    }
+
+    inline void mix( float* outBuffer, const float* postMixBuffer, const float* inBuffer, const float* duckGain,
+                     float wet, float dry, int length, float& peak, double& sumOfSquares ) {
+        table.mixFloat( outBuffer, postMixBuffer, inBuffer, duckGain, wet, dry, length, peak, sumOfSquares );
+    }
+
+    inline void mix( double* outBuffer, const float* postMixBuffer, const double* inBuffer, const float* duckGain,
+                     float wet, float dry, int length, float& peak, double& sumOfSquares ) {
+        table.mixDouble( outBuffer, postMixBuffer, inBuffer, duckGain, wet, dry, length, peak, sumOfSquares );
+    }
+
+    inline void detectPeaks( float** buffer, int numChannels, int offset, int length, float* peaks ) {
+        table.detectPeaksFloat( buffer, numChannels, offset, length, peaks );
+    }
+
+    inline void detectPeaks( double** buffer, int numChannels, int offset, int length, double* peaks ) {
+        table.detectPeaksDouble( buffer, numChannels, offset, length, peaks );
+    }
+
+    inline void applyGain( float* buffer, const float* gains, int length, float& peak, double& sumOfSquares ) {
+        table.applyGainFloat( buffer, gains, length, peak, sumOfSquares );
+    }
+
+    inline void applyGain( double* buffer, const double* gains, int length, float& peak, double& sumOfSquares ) {
+        table.applyGainDouble( buffer, gains, length, peak, sumOfSquares );
+    }
+
+    // the kernel tables of each variant (nullptr when the build does not provide the variant)
+
+    namespace Baseline { const Table* getTable(); }
+    namespace AVX2     { const Table* getTable(); }
+    namespace AVX512   { const Table* getTable(); }
+}
+}
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "levelmeter.h"
+#include "simd.h"
+#include <math.h>
+
+namespace Igorski {
+
+LevelMeter::LevelMeter()
+{
+    _history = nullptr;
+
+    begin( 0, 0 );
+    end( 1 );
+}
+
+/* public methods */
+
+void LevelMeter::begin( int numInChannels, int numOutChannels )
+{
+    _levels.amountOfInputChannels  = std::min( numInChannels,  ( int ) VST::MAX_CHANNELS );
+    _levels.amountOfOutputChannels = std::min( numOutChannels, ( int ) VST::MAX_CHANNELS );
+
+    for ( int c = 0; c < VST::MAX_CHANNELS; ++c ) {
+        _inputPeaks   [ c ] = 0.f;
+        _inputSquares [ c ] = 0.0;
+        _outputPeaks  [ c ] = 0.f;
+        _outputSquares[ c ] = 0.0;
+    }
+}
+
+const LevelMeter::Levels& LevelMeter::end( int bufferSize )
+{
+    double scale = 1.0 / std::max( 1, bufferSize );
+
+    for ( int c = 0; c < VST::MAX_CHANNELS; ++c ) {
+        _levels.inputPeak [ c ] = _inputPeaks [ c ];
+        _levels.inputRMS  [ c ] = ( float ) sqrt( _inputSquares[ c ] * scale );
+        _levels.outputPeak[ c ] = _outputPeaks[ c ];
+        _levels.outputRMS [ c ] = ( float ) sqrt( _outputSquares[ c ] * scale );
+    }
+
+    if ( _history != nullptr )
+        _history->push( _levels );
+
+    return _levels;
+}
+
+void LevelMeter::reduce( const float* buffer, int length, float& peak, double& sumOfSquares )
+{
+    int i = 0;
+    float maximum = 0.f;
+    double sum    = 0.0;
+#ifdef FOGPAD_SSE2
+    const __m128 signMask = _mm_set1_ps( -0.f );
+    __m128 peaks   = _mm_setzero_ps();
+    __m128 squares = _mm_setzero_ps();
+
+    for ( ; i + 4 <= length; i += 4 )
+    {
+        __m128 samples = _mm_loadu_ps( buffer + i );
+        peaks   = _mm_max_ps( peaks, _mm_andnot_ps( signMask, samples ));
+        squares = _mm_add_ps( squares, _mm_mul_ps( samples, samples ));
+    }
+    float lanes[ 4 ];
+    _mm_storeu_ps( lanes, peaks );
+    maximum = std::max( std::max( lanes[ 0 ], lanes[ 1 ] ), std::max( lanes[ 2 ], lanes[ 3 ] ));
+    _mm_storeu_ps( lanes, squares );
+    sum = ( double ) lanes[ 0 ] + lanes[ 1 ] + lanes[ 2 ] + lanes[ 3 ];
+#endif
+    for ( ; i < length; ++i )
+    {
+        maximum = std::max( maximum, fabsf( buffer[ i ] ));
+        sum    += buffer[ i ] * buffer[ i ];
+    }
+    peak          = std::max( peak, maximum );
+    sumOfSquares += sum;
+}
+
+void LevelMeter::reduce( const double* buffer, int length, float& peak, double& sumOfSquares )
+{
+    int i = 0;
+    double maximum = 0.0;
+    double sum     = 0.0;
+#ifdef FOGPAD_SSE2
+    const __m128d signMask = _mm_set1_pd( -0.0 );
+    __m128d peaks   = _mm_setzero_pd();
+    __m128d squares = _mm_setzero_pd();
+
+    for ( ; i + 2 <= length; i += 2 )
+    {
+        __m128d samples = _mm_loadu_pd( buffer + i );
+        peaks   = _mm_max_pd( peaks, _mm_andnot_pd( signMask, samples ));
+        squares = _mm_add_pd( squares, _mm_mul_pd( samples, samples ));
+    }
+    double lanes[ 2 ];
+    _mm_storeu_pd( lanes, peaks );
+    maximum = std::max( lanes[ 0 ], lanes[ 1 ] );
+    _mm_storeu_pd( lanes, squares );
+    sum = lanes[ 0 ] + lanes[ 1 ];
+#endif
+    for ( ; i < length; ++i )
+    {
+        maximum = std::max( maximum, fabs( buffer[ i ] ));
+        sum    += buffer[ i ] * buffer[ i ];
+    }
+    peak          = std::max( peak, ( float ) maximum );
+    sumOfSquares += sum;
+}
+
+void LevelMeter::setHistory( LevelsHistory* history )
+{
+    _history = history;
+}
+
+}
@@ -0,0 +1,140 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __LEVELMETER_H_INCLUDED__
+#define __LEVELMETER_H_INCLUDED__
+
+#include "global.h"
+#include "ringbuffer.h"
+#include <algorithm>
+
+namespace Igorski {
+
+/**
+ * LevelMeter collects the per-channel peak and RMS levels of the input and output
+ * signals during a process cycle. The levels are not measured in separate passes: the
+ * loops that read the input (the final mix) and write the output (the limiter gain stage)
+ * accumulate their block reductions into the meter via addInput() and addOutput().
+ * At the end of the cycle, the levels are pushed into the history (when set)
+ */
+class LevelMeter {
+
+    public:
+        // the levels of a single process cycle, as linear gain
+
+        struct Levels {
+            int amountOfInputChannels;
+            int amountOfOutputChannels;
+            float inputPeak [ VST::MAX_CHANNELS ];
+            float inputRMS  [ VST::MAX_CHANNELS ];
+            float outputPeak[ VST::MAX_CHANNELS ];
+            float outputRMS [ VST::MAX_CHANNELS ];
+        };
+
+        // lock-free queue transferring the levels to the UI (one entry per process cycle)
+
+        typedef RingBuffer<Levels, 256> LevelsHistory;
+
+        LevelMeter();
+
+        // start measuring a new process cycle
+
+        void begin( int numInChannels, int numOutChannels );
+
+        // finalize the measurement of the cycle (of given length in samples) and publish
+        // the levels into the history. Returns the measured levels
+
+        const Levels& end( int bufferSize );
+
+        // accumulate the peak and sum of squares of (a block of) a channels samples
+
+        inline void addInput( int channel, float peak, double sumOfSquares )
+        {
+            if ( channel >= VST::MAX_CHANNELS )
+                return;
+
+            _inputPeaks[ channel ]    = std::max( _inputPeaks[ channel ], peak );
+            _inputSquares[ channel ] += sumOfSquares;
+        }
+
+        inline void addOutput( int channel, float peak, double sumOfSquares )
+        {
+            if ( channel >= VST::MAX_CHANNELS )
+                return;
+
+            _outputPeaks[ channel ]    = std::max( _outputPeaks[ channel ], peak );
+            _outputSquares[ channel ] += sumOfSquares;
+        }
+
+        // measure given buffers directly (for when no fused loop processed them)
+
+        template <typename SampleType>
+        void measureInput( SampleType** buffer, int numChannels, int bufferSize );
+
+        template <typename SampleType>
+        void measureOutput( SampleType** buffer, int numChannels, int bufferSize );
+
+        // vectorized reduction of a block of samples into its peak and sum of squares
+
+        static void reduce( const float* buffer, int length, float& peak, double& sumOfSquares );
+        static void reduce( const double* buffer, int length, float& peak, double& sumOfSquares );
+
+        // when set, the levels of each process cycle are pushed into given history
+        // the history is owned by the caller and can be unset by providing a nullptr
+
+        void setHistory( LevelsHistory* history );
+
+    private:
+        Levels _levels;
+        LevelsHistory* _history;
+
+        float  _inputPeaks   [ VST::MAX_CHANNELS ];
+        double _inputSquares [ VST::MAX_CHANNELS ];
+        float  _outputPeaks  [ VST::MAX_CHANNELS ];
+        double _outputSquares[ VST::MAX_CHANNELS ];
+};
+
+template <typename SampleType>
+void LevelMeter::measureInput( SampleType** buffer, int numChannels, int bufferSize )
+{
+    for ( int c = 0; c < numChannels; ++c ) {
+        float peak = 0.f;
+        double sumOfSquares = 0.0;
+        reduce( buffer[ c ], bufferSize, peak, sumOfSquares );
+        addInput( c, peak, sumOfSquares );
+    }
+}
+
+template <typename SampleType>
+void LevelMeter::measureOutput( SampleType** buffer, int numChannels, int bufferSize )
+{
+    for ( int c = 0; c < numChannels; ++c ) {
+        float peak = 0.f;
+        double sumOfSquares = 0.0;
+        reduce( buffer[ c ], bufferSize, peak, sumOfSquares );
+        addOutput( c, peak, sumOfSquares );
+    }
+}
+
+}
+
+#endif
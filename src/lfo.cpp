@@ -21,12 +21,26 @@
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "lfo.h"
+#include <algorithm>
+#include <math.h>
 
 namespace Igorski {
 
+const LFO::WaveTable LFO::SINE_TABLE = LFO::WaveTable();
+constexpr float LFO::FRACTION_SCALE;
+constexpr float LFO::PHASE_TO_BIPOLAR;
+
 LFO::LFO() {
-    _rate        = VST::MIN_LFO_RATE();
-    _accumulator = 0.f;
+    _waveform       = SINE;
+    _sync           = 0.f;
+    _tempo          = 120.0;
+    _phase          = 0;
+    _phaseIncrement = 0;
+    _cycle          = 0;
+    _randomStart    = getRandom( _cycle );
+    _randomTarget   = getRandom( _cycle + 1 );
+
+    setRate( VST::MIN_LFO_RATE() );
 }
 
 LFO::~LFO() {
@@ -43,16 +57,149 @@ float LFO::getRate()
 void LFO::setRate( float value )
 {
     _rate = value;
+    calculatePhaseIncrement();
+}
+
+LFO::Waveform LFO::getWaveform()
+{
+    return _waveform;
+}
+
+void LFO::setWaveform( Waveform value )
+{
+    _waveform = value;
+}
+
+void LFO::setWaveform( int value )
+{
+    setWaveform(( Waveform ) std::min(( int ) WAVEFORM_AMOUNT - 1, std::max( 0, value )));
+}
+
+uint32_t LFO::getPhase()
+{
+    return _phase;
+}
+
+void LFO::setPhase( uint32_t value )
+{
+    _phase = value;
+}
+
+float LFO::getSync()
+{
+    return _sync;
 }
 
-void LFO::setAccumulator( float value )
+void LFO::setSync( float quarterNotesPerCycle )
 {
-    _accumulator = value;
+    _sync = std::max( 0.f, quarterNotesPerCycle );
+    calculatePhaseIncrement();
 }
 
-float LFO::getAccumulator()
+bool LFO::isSynced()
 {
-    return _accumulator;
+    return _sync > 0.f;
+}
+
+void LFO::setTempo( double tempo )
+{
+    if ( tempo <= 0.0 || tempo == _tempo )
+        return;
+
+    _tempo = tempo;
+    calculatePhaseIncrement();
+}
+
+void LFO::syncPosition( double quarterNotes )
+{
+    if ( !isSynced() )
+        return;
+
+    double cycles = quarterNotes / ( double ) _sync;
+    double cycle  = floor( cycles );
+
+    // the fractional part of the cycle count is the phase
+    _phase = ( uint32_t ) (( cycles - cycle ) * 4294967296.0 );
+
+    // keep random values in line with the cycle (e.g. after a change of the playback position)
+
+    uint32_t cycleIndex = ( uint32_t ) ( int64_t ) cycle;
+
+    if ( cycleIndex != _cycle ) {
+        _cycle        = cycleIndex;
+        _randomStart  = getRandom( _cycle );
+        _randomTarget = getRandom( _cycle + 1 );
+    }
+}
+
+void LFO::render( float* out, int bufferSize )
+{
+    uint32_t phase     = _phase;
+    uint32_t increment = _phaseIncrement;
+
+    if ( _waveform == RANDOM )
+    {
+        for ( int i = 0; i < bufferSize; ++i )
+            out[ i ] = peek();
+
+        return;
+    }
+
+    // the waveform switch is resolved once for the whole block
+
+    switch ( _waveform )
+    {
+        default:
+        case SINE:
+            for ( int i = 0; i < bufferSize; ++i, phase += increment ) {
+                uint32_t index = phase >> FRACTION_BITS;
+                float frac     = ( float ) ( phase & (( 1 << FRACTION_BITS ) - 1 )) * FRACTION_SCALE;
+                float s1       = SINE_TABLE.values[ index ];
+                out[ i ]       = s1 + ( SINE_TABLE.values[ index + 1 ] - s1 ) * frac;
+            }
+            break;
+
+        case TRIANGLE:
+            for ( int i = 0; i < bufferSize; ++i, phase += increment ) {
+                int64_t offset = ( int32_t ) ( phase + 0xC0000000u );
+                out[ i ] = 1.f - ( float ) ( offset < 0 ? -offset : offset ) * PHASE_TO_BIPOLAR * 2.f;
+            }
+            break;
+
+        case SAWTOOTH:
+            for ( int i = 0; i < bufferSize; ++i, phase += increment )
+                out[ i ] = ( float ) (( int32_t ) phase ) * PHASE_TO_BIPOLAR;
+            break;
+
+        case SQUARE:
+            for ( int i = 0; i < bufferSize; ++i, phase += increment )
+                out[ i ] = ( phase < 0x80000000u ) ? 1.f : -1.f;
+            break;
+    }
+    _phase = phase;
+}
+
+/* private methods */
+
+void LFO::calculatePhaseIncrement()
+{
+    // when synchronized, the rate in Hz is the amount of cycles per second at the current tempo
+    double rate = isSynced() ? ( _tempo / 60.0 ) / ( double ) _sync : ( double ) _rate;
+
+    // the phase increment is the fraction of the cycle travelled per sample
+    // scaled to the full 32-bit range (4294967296 == 2^32)
+    _phaseIncrement = ( uint32_t ) ( rate / ( double ) VST::SAMPLE_RATE * 4294967296.0 );
+}
+
+float LFO::getRandom( uint32_t cycle )
+{
+    // integer hash of the cycle index, returns value in -1 to +1 range
+    uint32_t hash = cycle * 2654435761u;
+    hash ^= hash >> 16;
+    hash *= 2246822519u;
+    hash ^= hash >> 13;
+
+    return ( float ) (( int32_t ) hash ) * PHASE_TO_BIPOLAR;
 }
 
 }
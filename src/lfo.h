@@ -24,55 +24,194 @@
 #define __LFO_H_INCLUDED__
 
 #include "global.h"
+#include <stdint.h>
 
 namespace Igorski {
 class LFO {
 
     public:
+
+        // the available waveforms, the values are bipolar (-1 to +1 range)
+        // and all waveforms start at 0 for a phase of 0 (except for the square)
+
+        enum Waveform {
+            SINE = 0,
+            TRIANGLE,
+            SAWTOOTH,
+            SQUARE,
+            RANDOM, // smoothly interpolated random values, a new target is drawn once per cycle
+            WAVEFORM_AMOUNT
+        };
+
         LFO();
         ~LFO();
 
         float getRate();
         void setRate( float value );
 
-        // accumulators are used to retrieve a sample from the wave table
-        // in other words: track the progress of the oscillator against its range
+        Waveform getWaveform();
+        void setWaveform( Waveform value );
+        void setWaveform( int value );
+
+        // the phase is a 32-bit fixed point value where the full
+        // integer range spans a single cycle of the oscillator
+
+        uint32_t getPhase();
+        void setPhase( uint32_t value );
 
-        float getAccumulator();
-        void setAccumulator( float offset );
+        // tempo synchronization, when a sync length is set (in quarter notes per cycle)
+        // the rate is derived from the host tempo instead of the rate in Hz.
+        // a value of 0 restores free running operation
+
+        float getSync();
+        void setSync( float quarterNotesPerCycle );
+        bool isSynced();
+        void setTempo( double tempo );
 
         /**
-         * retrieve a value from the wave table for the current
-         * accumulator position, this method also increments
-         * the accumulator and keeps it within bounds
+         * lock the phase of a synchronized oscillator to the musical
+         * position of the host (in quarter notes), this is invoked once per
+         * buffer so the phase only depends on the project position
+         * (e.g. rendering the same section twice yields the same modulation)
+         */
+        void syncPosition( double quarterNotes );
+
+        /**
+         * retrieve the value of the oscillator for the current
+         * phase, this method also increments the phase (which
+         * wraps naturally upon overflow)
          */
         inline float peek()
         {
-            // the wave table offset to read from
-            float SR_OVER_LENGTH = VST::SAMPLE_RATE / ( float ) TABLE_SIZE;
-            int readOffset = ( _accumulator == 0.f ) ? 0 : ( int ) ( _accumulator / SR_OVER_LENGTH );
-
-            // increment the accumulators read offset
-            _accumulator += _rate;
+            uint32_t phase = _phase;
+            _phase += _phaseIncrement;
 
-            // keep the accumulator within the bounds of the sample frequency
-            if ( _accumulator > VST::SAMPLE_RATE )
-                _accumulator -= VST::SAMPLE_RATE;
+            if ( _waveform == RANDOM )
+                return peekRandom( phase );
 
-            // return the sample present at the calculated offset within the table
-            return VST::TABLE[ readOffset ];
+            return getValue( phase );
         }
 
-    private:
+        /**
+         * render the next bufferSize values of the oscillator into given
+         * output buffer (the equivalent of invoking peek() bufferSize times)
+         * this allows consumers to process a block of samples against a single,
+         * precalculated trajectory (for instance: across multiple channels)
+         */
+        void render( float* out, int bufferSize );
+
+        // the sine wave table, generated at compile time. Note the table holds
+        // an additional guard point (equal to the first) to allow interpolation
+        // to read one index ahead without wrapping
+
+        static const int TABLE_BITS = 10;
+        static const int TABLE_SIZE = 1 << TABLE_BITS;
 
-        // see Igorski::VST::LFO_TABLE;
-        static const int TABLE_SIZE = 128;
+        struct WaveTable {
+            float values[ TABLE_SIZE + 1 ];
+            constexpr WaveTable();
+        };
+        static const WaveTable SINE_TABLE;
 
-        // used internally
+    private:
+
+        // the amount of bits of the phase below the table index, used for interpolation
+        static const int FRACTION_BITS = 32 - TABLE_BITS;
+        static constexpr float FRACTION_SCALE  = 1.f / ( float ) ( 1 << FRACTION_BITS );
+        static constexpr float PHASE_TO_BIPOLAR = 1.f / 2147483648.f; // 1 / 2^31
 
         float _rate;
-        float _accumulator;   // is read offset in wave table buffer
+        Waveform _waveform;
+        float _sync;   // cycle length in quarter notes, 0 when free running
+        double _tempo; // host tempo in BPM
+
+        uint32_t _phase;          // current position within the cycle
+        uint32_t _phaseIncrement; // the amount to advance the phase by per sample
+
+        // smoothed random waveform, the random values are derived from the
+        // cycle count so synchronized oscillators render reproducible values
+
+        float _randomStart;
+        float _randomTarget;
+        uint32_t _cycle;
+
+        void calculatePhaseIncrement();
+        float getRandom( uint32_t cycle );
+
+        inline float getValue( uint32_t phase )
+        {
+            switch ( _waveform )
+            {
+                default:
+                case SINE:
+                {
+                    // linear interpolation between the two nearest table points
+                    uint32_t index = phase >> FRACTION_BITS;
+                    float frac     = ( float ) ( phase & (( 1 << FRACTION_BITS ) - 1 )) * FRACTION_SCALE;
+                    float s1       = SINE_TABLE.values[ index ];
+                    return s1 + ( SINE_TABLE.values[ index + 1 ] - s1 ) * frac;
+                }
+                case TRIANGLE:
+                {
+                    // offset the phase by three quarters so the waveform starts at 0 and rises
+                    int64_t offset = ( int32_t ) ( phase + 0xC0000000u );
+                    return 1.f - ( float ) ( offset < 0 ? -offset : offset ) * PHASE_TO_BIPOLAR * 2.f;
+                }
+                case SAWTOOTH:
+                    return ( float ) (( int32_t ) phase ) * PHASE_TO_BIPOLAR;
+
+                case SQUARE:
+                    return ( phase < 0x80000000u ) ? 1.f : -1.f;
+            }
+        }
+
+        inline float peekRandom( uint32_t phase )
+        {
+            // smoothstep interpolation between the start and target values of this cycle
+            float frac  = ( float ) phase * PHASE_TO_BIPOLAR * .5f;
+            float value = _randomStart + ( _randomTarget - _randomStart ) * ( frac * frac * ( 3.f - 2.f * frac ));
+
+            // phase wrapped around (cycle completed) ? draw a new target value
+            if ( _phase < phase ) {
+                _randomStart  = _randomTarget;
+                _randomTarget = getRandom( ++_cycle + 1 );
+            }
+            return value;
+        }
 };
+
+/**
+ * sine approximation using a Taylor series (std::sin is not constexpr),
+ * only used to generate the wave table at compile time
+ */
+constexpr double constexprSine( double x )
+{
+    const double PI = 3.14159265358979323846;
+
+    // reduce range to -PI - +PI
+
+    while ( x > PI )
+        x -= 2.0 * PI;
+    while ( x < -PI )
+        x += 2.0 * PI;
+
+    double term   = x;
+    double result = x;
+
+    for ( int n = 1; n < 16; ++n ) {
+        term   *= -x * x / (( 2.0 * n ) * ( 2.0 * n + 1.0 ));
+        result += term;
+    }
+    return result;
+}
+
+constexpr LFO::WaveTable::WaveTable() : values()
+{
+    for ( int i = 0; i <= TABLE_SIZE; ++i ) {
+        values[ i ] = ( float ) constexprSine( 2.0 * 3.14159265358979323846 * ( double ) ( i % TABLE_SIZE ) / ( double ) TABLE_SIZE );
+    }
+}
+
 }
 
 #endif
@@ -25,6 +25,7 @@
  */
 #include "limiter.h"
 #include "global.h"
+#include "calc.h"
 #include <math.h>
 
 // constructors / destructor
@@ -32,16 +33,22 @@
 Limiter::Limiter()
 {
     init( 0.15, 0.50, 0.60 );
+    initLookahead();
 }
 
 Limiter::Limiter( float attackMs, float releaseMs, float thresholdDb )
 {
     init( attackMs, releaseMs, thresholdDb );
+    initLookahead();
 }
 
 Limiter::~Limiter()
 {
-    // nowt...
+    delete[] _history;
+    delete[] _delayLines;
+    delete[] _dequeGains;
+    delete[] _dequeFrames;
+    delete[] _boxGains;
 }
 
 /* public methods */
@@ -69,6 +76,38 @@ float Limiter::getLinearGR()
     return gain > 1.f ? 1.f / gain : 1.f;
 }
 
+void Limiter::setLookahead( bool value )
+{
+    // the lookahead state is reset by the next process call
+    _lookahead = value;
+}
+
+bool Limiter::getLookahead()
+{
+    return _lookahead;
+}
+
+void Limiter::setQuality( Igorski::VST::Quality quality )
+{
+    // the evaluated phases are those of the given oversampling factor that
+    // are part of the 4x polyphase interpolator (e.g. phase .5 for 2x)
+
+    int oversampling = ( quality == Igorski::VST::QUALITY_HIGH ) ? OVERSAMPLING : 2;
+
+    _phaseStep  = OVERSAMPLING / oversampling;
+    _firstPhase = _phaseStep - 1;
+}
+
+int Limiter::getLatencySamples()
+{
+    return _lookahead ? _delaySize : 0;
+}
+
+void Limiter::setGainReductionHistory( GainReductionHistory* history )
+{
+    _gainReductionHistory = history;
+}
+
 /* protected methods */
 
 void Limiter::init( float attackMs, float releaseMs, float thresholdDb )
@@ -81,6 +120,8 @@ void Limiter::init( float attackMs, float releaseMs, float thresholdDb )
 
     gain = 1.f;
 
+    _gainReductionHistory = nullptr;
+
     recalculate();
 }
 
@@ -98,3 +139,109 @@ void Limiter::recalculate()
     att  = ( float )  pow( 10.0, -2.0 * pAttack );
     rel  = ( float )  pow( 10.0, -2.0 - ( 3.0 * pRelease ));
 }
+
+/* private methods */
+
+void Limiter::initLookahead()
+{
+    _lookahead       = false;
+    _lookaheadActive = false;
+
+    setQuality( Igorski::VST::QUALITY_HIGH );
+
+    // the gain envelope is held at its minimum over the window and then averaged over the
+    // window, as such the gain has fully reached the minimum required for a peak once the
+    // window has passed. The detected peak lags the input by half the interpolator taps
+
+    _windowSize = std::max( 1, Igorski::Calc::millisecondsToBuffer( LOOKAHEAD_MS ));
+    _delaySize  = ( _windowSize - 1 ) + ( TAPS / 2 );
+    _releaseCoefficient = 1.f - expf( -1.f / std::max( 1.f, Igorski::Calc::millisecondsToBuffer( LOOKAHEAD_RELEASE ) * 1.f ));
+
+    // windowed sinc interpolation for each fractional phase between the
+    // two center samples, normalized to unity gain
+
+    for ( int phase = 1; phase < OVERSAMPLING; ++phase )
+    {
+        float fraction = ( float ) phase / OVERSAMPLING;
+        float sum      = 0.f;
+
+        for ( int i = 0; i < TAPS; ++i )
+        {
+            float x      = ( float )( i - ( TAPS / 2 - 1 )) - fraction;
+            float sinc   = ( x == 0.f ) ? 1.f : sinf( Igorski::VST::PI * x ) / ( Igorski::VST::PI * x );
+            float window = 0.5f * ( 1.f + cosf( Igorski::VST::PI * x / ( TAPS / 2 )));
+
+            _phaseCoefficients[ phase - 1 ][ i ] = sinc * window;
+            sum += sinc * window;
+        }
+        for ( int i = 0; i < TAPS; ++i )
+            _phaseCoefficients[ phase - 1 ][ i ] /= sum;
+    }
+
+    _history     = new double[ Igorski::VST::MAX_CHANNELS * TAPS * 2 ];
+    _delayLines  = new double[ Igorski::VST::MAX_CHANNELS * _delaySize ];
+    _dequeGains  = new float[ _windowSize + 1 ];
+    _dequeFrames = new uint32_t[ _windowSize + 1 ];
+    _boxGains    = new float[ _windowSize ];
+
+    resetLookahead();
+}
+
+void Limiter::resetLookahead()
+{
+    std::fill( _history, _history + Igorski::VST::MAX_CHANNELS * TAPS * 2, 0.0 );
+    std::fill( _delayLines, _delayLines + Igorski::VST::MAX_CHANNELS * _delaySize, 0.0 );
+    std::fill( _boxGains, _boxGains + _windowSize, 1.f );
+
+    _historyIndex = 0;
+    _delayIndex   = 0;
+    _lastPeak     = 0.f;
+    _dequeHead    = 0;
+    _dequeLength  = 0;
+    _frame        = 0;
+    _boxSum       = _windowSize;
+    _boxIndex     = 0;
+    _releasedGain = 1.f;
+}
+
+float Limiter::getLookaheadGain( float truePeak )
+{
+    float requiredGain = ( truePeak > TRUE_PEAK_CEILING ) ? TRUE_PEAK_CEILING / truePeak : 1.f;
+    int capacity = _windowSize + 1;
+
+    // sliding window minimum: expire the oldest gain once it leaves the window and
+    // drop all gains that can no longer become the minimum (O(1) amortized per frame)
+
+    if ( _dequeLength > 0 && ( _frame - _dequeFrames[ _dequeHead ]) >= ( uint32_t ) _windowSize ) {
+        _dequeHead = ( _dequeHead + 1 ) % capacity;
+        --_dequeLength;
+    }
+
+    while ( _dequeLength > 0 && _dequeGains[ ( _dequeHead + _dequeLength - 1 ) % capacity ] >= requiredGain )
+        --_dequeLength;
+
+    int tail = ( _dequeHead + _dequeLength ) % capacity;
+    _dequeGains [ tail ] = requiredGain;
+    _dequeFrames[ tail ] = _frame++;
+    ++_dequeLength;
+
+    float minimumGain = _dequeGains[ _dequeHead ];
+
+    // attack instantly, release exponentially
+
+    if ( minimumGain < _releasedGain )
+        _releasedGain = minimumGain;
+    else
+        _releasedGain += ( minimumGain - _releasedGain ) * _releaseCoefficient;
+
+    // box filter to smooth the attack over the window
+
+    _boxSum -= _boxGains[ _boxIndex ];
+    _boxGains[ _boxIndex ] = _releasedGain;
+    _boxSum += _releasedGain;
+
+    if ( ++_boxIndex == _windowSize )
+        _boxIndex = 0;
+
+    return ( float )( _boxSum / _windowSize );
+}
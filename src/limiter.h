@@ -27,16 +27,42 @@
 #define __LIMITER_H_INCLUDED__
 
 #include "audiobuffer.h"
+#include "global.h"
+#include <math.h>
+#include <algorithm>
+#include "ringbuffer.h"
+#include "levelmeter.h"
+#include "kernels/kernels.h"
 
 class Limiter
 {
     public:
+        // the range of the linear gain reduction applied during a chunk of processed
+        // samples (where 1 equals no reduction), recorded for visualization purposes
+
+        struct GainReduction {
+            float minimum;
+            float maximum;
+        };
+
+        // lock-free queue transferring the gain reduction history to the UI, this
+        // holds a few seconds of history (a chunk being 64 samples)
+
+        typedef Igorski::RingBuffer<GainReduction, 4096> GainReductionHistory;
+
+
         Limiter();
         Limiter( float attackMs, float releaseMs, float thresholdDb );
         ~Limiter();
 
+        // when provided, the level of the limited output is accumulated into outputMeter
+        // (measured within the pass writing the output). amount optionally provides, for each
+        // sample, the amount of gain reduction to apply (0 leaves the signal unaltered, while the
+        // lookahead delay remains in place), e.g. to crossfade the limiting when bypassing
+
         template <typename SampleType>
-        void process( SampleType** outputBuffer, int bufferSize, int numOutChannels );
+        void process( SampleType** outputBuffer, int bufferSize, int numOutChannels,
+                      Igorski::LevelMeter* outputMeter = nullptr, const float* amount = nullptr );
 
         void setAttack( float attackMs );
         void setRelease( float releaseMs );
@@ -44,6 +70,26 @@ class Limiter
 
         float getLinearGR();
 
+        // lookahead mode applies a true-peak ceiling after the limiter. The output is delayed
+        // so gain can be reduced ahead of (inter-sample) peaks exceeding the ceiling. Toggling
+        // the mode is real-time safe as all lookahead buffers are allocated on construction
+
+        void setLookahead( bool value );
+        bool getLookahead();
+
+        // QUALITY_HIGH detects true peaks at 4x oversampling, QUALITY_ECO at 2x
+        // (only evaluating the halfway point between samples). Latency is unaffected
+
+        void setQuality( Igorski::VST::Quality quality );
+
+        // the amount of samples the output is delayed by (0 when lookahead mode is off)
+        int getLatencySamples();
+
+        // when set, the gain reduction of each processed chunk is pushed into given history
+        // the history is owned by the caller and can be unset by providing a nullptr
+
+        void setGainReductionHistory( GainReductionHistory* history );
+
     protected:
         void init( float attackMs, float releaseMs, float thresholdDb );
         void recalculate();
@@ -55,6 +101,67 @@ class Limiter
         float pKnee;
 
         float thresh, gain, att, rel, trim;
+
+    private:
+
+        static constexpr float LOOKAHEAD_MS      = 2.f;
+        static constexpr float LOOKAHEAD_RELEASE = 50.f;      // in ms
+        static constexpr float TRUE_PEAK_CEILING = 0.891251f; // -1 dBTP
+
+        // inter-sample peaks are detected at 4x oversampling using a polyphase
+        // interpolator, each (fractional) phase uses TAPS surrounding samples
+
+        static const int OVERSAMPLING = 4;
+        static const int TAPS         = 8;
+
+        GainReductionHistory* _gainReductionHistory;
+
+        bool _lookahead;
+        bool _lookaheadActive;
+        int _windowSize;     // size of the minimum gain window and the box filter
+        int _delaySize;      // equal to the reported latency
+        float _releaseCoefficient;
+        float _phaseCoefficients[ OVERSAMPLING - 1 ][ TAPS ];
+        int _firstPhase;     // the fractional phases evaluated for the current quality
+        int _phaseStep;
+
+        double* _history;    // per channel, the last TAPS input samples (written twice for contiguous reads)
+        int _historyIndex;
+        double* _delayLines; // per channel, the delayed output
+        int _delayIndex;
+        float _lastPeak;     // true peak of the interval preceding the last detected sample
+
+        // monotonic deque of gains (and the frame they were detected at) for the sliding minimum
+
+        float* _dequeGains;
+        uint32_t* _dequeFrames;
+        int _dequeHead;
+        int _dequeLength;
+        uint32_t _frame;
+
+        float* _boxGains;    // the last released gains, averaged to smooth the gain envelope
+        double _boxSum;
+        int _boxIndex;
+        float _releasedGain;
+
+        void initLookahead();
+        void resetLookahead();
+
+        // the gain required to keep given true peak below the ceiling, smoothed to the gain
+        // to apply to the sample frame exiting the delay lines
+
+        float getLookaheadGain( float truePeak );
+
+        // applies the lookahead stage onto given range of the buffer, providing
+        // the range of the applied gain through minimumGain and maximumGain
+
+        template <typename SampleType>
+        void processLookahead( SampleType** outputBuffer, int offset, int length, int numOutChannels,
+                               float& minimumGain, float& maximumGain, Igorski::LevelMeter* outputMeter,
+                               const float* amount );
+
+        // the amount of sample frames processed per pass
+        static const int CHUNK_SIZE = 64;
 };
 
 #include "limiter.tcc"
@@ -24,15 +24,13 @@
  * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 template <typename SampleType>
-void Limiter::process( SampleType** outputBuffer, int bufferSize, int numOutChannels )
+void Limiter::process( SampleType** outputBuffer, int bufferSize, int numOutChannels,
+                       Igorski::LevelMeter* outputMeter, const float* amount )
 {
-//    if ( gain > 0.9999f && outputBuffer->isSilent )
-//    {
-//        // don't process if input is silent
-//        return;
-//    }
+    if ( numOutChannels <= 0 )
+        return;
 
-    SampleType g, at, re, tr, th, lev, ol, or_;
+    SampleType g, at, re, tr, th, lev;
 
     th = thresh;
     g = gain;
@@ -40,57 +38,193 @@ void Limiter::process( SampleType** outputBuffer, int bufferSize, int numOutChan
     re = rel;
     tr = trim;
 
-    bool hasRight = ( numOutChannels > 1 );
+    // all channels share the same gain, derived from the peak across all channels
+    // the detector was originally calibrated against the sum of a stereo pair, for
+    // multichannel signals the peak is scaled to match (equal to a correlated stereo signal)
 
-    SampleType* leftBuffer  = outputBuffer[ 0 ];
-    SampleType* rightBuffer = hasRight ? outputBuffer[ 1 ] : 0;
+    const SampleType detectorScale = ( numOutChannels > 1 ) ? 2.0 : 1.0;
+    const bool softKnee = pKnee > 0.5;
 
-    if ( pKnee > 0.5 )
+    SampleType peaks[ CHUNK_SIZE ];
+    SampleType gains[ CHUNK_SIZE ];
+
+    // clear the lookahead history when lookahead mode was (re)enabled
+
+    if ( _lookahead && !_lookaheadActive )
+        resetLookahead();
+
+    _lookaheadActive = _lookahead;
+
+    for ( int offset = 0; offset < bufferSize; offset += CHUNK_SIZE )
     {
-        // soft knee
+        int length = ( bufferSize - offset ) > CHUNK_SIZE ? CHUNK_SIZE : bufferSize - offset;
+
+        Igorski::Kernels::detectPeaks( outputBuffer, numOutChannels, offset, length, peaks );
 
-        for ( int i = 0; i < bufferSize; ++i ) {
+        // the gain envelope is recursive and thus calculated per sample
 
-            ol  = leftBuffer[ i ];
-            or_ = hasRight ? rightBuffer[ i ] : 0;
+        if ( softKnee )
+        {
+            for ( int i = 0; i < length; ++i ) {
 
-            lev = ( SampleType ) ( 1.f / ( 1.f + th * fabs( ol + or_ )));
+                lev = ( SampleType ) ( 1.f / ( 1.f + th * peaks[ i ] * detectorScale ));
 
-            if ( g > lev ) {
-                g = g - at * ( g - lev );
+                if ( g > lev ) {
+                    g = g - at * ( g - lev );
+                }
+                else {
+                    g = g + re * ( lev - g );
+                }
+                gains[ i ] = tr * g;
+            }
+        }
+        else
+        {
+            for ( int i = 0; i < length; ++i ) {
+
+                lev = ( SampleType ) ( 0.5 * g * peaks[ i ] * detectorScale );
+
+                if ( lev > th ) {
+                    g = g - ( at * ( lev - th ));
+                }
+                else {
+                    // below threshold
+                    g = g + ( SampleType )( re * ( 1.f - g ));
+                }
+                gains[ i ] = tr * g;
             }
-            else {
-                g = g + re * ( lev - g );
+        }
+
+        // scale the gain reduction by the requested amount
+
+        if ( amount != nullptr ) {
+            for ( int i = 0; i < length; ++i )
+                gains[ i ] = 1 + ( gains[ i ] - 1 ) * amount[ offset + i ];
+        }
+
+        // apply the gain envelope onto all channels (when not delayed for
+        // lookahead, this writes the final output which is thus measured here)
+
+        for ( int c = 0; c < numOutChannels; ++c ) {
+            float peak = 0.f;
+            double sumOfSquares = 0.0;
+
+            Igorski::Kernels::applyGain( outputBuffer[ c ] + offset, gains, length, peak, sumOfSquares );
+
+            if ( outputMeter != nullptr && !_lookahead )
+                outputMeter->addOutput( c, peak, sumOfSquares );
+        }
+
+        float minimumGain = 1.f;
+        float maximumGain = 1.f;
+
+        if ( _lookahead )
+            processLookahead( outputBuffer, offset, length, numOutChannels, minimumGain, maximumGain, outputMeter, amount );
+
+        // record the gain reduction of this chunk (the envelope excludes the trim gain)
+
+        if ( _gainReductionHistory != nullptr )
+        {
+            SampleType minimumEnvelope = gains[ 0 ];
+            SampleType maximumEnvelope = gains[ 0 ];
+
+            for ( int i = 1; i < length; ++i ) {
+                minimumEnvelope = std::min( minimumEnvelope, gains[ i ] );
+                maximumEnvelope = std::max( maximumEnvelope, gains[ i ] );
             }
 
-            leftBuffer[ i ] = ( ol * tr * g );
+            GainReduction reduction;
+            reduction.minimum = std::min( 1.f, ( float )( minimumEnvelope / tr )) * minimumGain;
+            reduction.maximum = std::min( 1.f, ( float )( maximumEnvelope / tr )) * maximumGain;
 
-            if ( hasRight )
-                rightBuffer[ i ] = ( or_ * tr * g );
+            _gainReductionHistory->push( reduction );
         }
     }
-    else
+    gain = g;
+}
+
+template <typename SampleType>
+void Limiter::processLookahead( SampleType** outputBuffer, int offset, int length, int numOutChannels,
+                                float& minimumGain, float& maximumGain, Igorski::LevelMeter* outputMeter,
+                                const float* amount )
+{
+    int numChannels = std::min( numOutChannels, ( int ) Igorski::VST::MAX_CHANNELS );
+
+    float  outputPeaks  [ Igorski::VST::MAX_CHANNELS ] = { 0.f };
+    double outputSquares[ Igorski::VST::MAX_CHANNELS ] = { 0.0 };
+
+    minimumGain = 1.f;
+    maximumGain = 0.f;
+
+    for ( int i = offset, l = offset + length; i < l; ++i )
     {
-        for ( int i = 0; i < bufferSize; ++i ) {
+        // determine the true peak of the interval between the two center samples of the
+        // interpolator history, combined with the preceding interval this covers the
+        // center sample and all inter-sample values surrounding it
 
-            ol  = leftBuffer[ i ];
-            or_ = hasRight ? rightBuffer[ i ] : 0;
+        float intervalPeak = 0.f;
 
-            lev = ( SampleType ) ( 0.5 * g * fabs( ol + or_ ));
+        for ( int c = 0; c < numChannels; ++c )
+        {
+            double* history = _history + ( c * TAPS * 2 );
 
-            if ( lev > th ) {
-                g = g - ( at * ( lev - th ));
-            }
-            else {
-                // below threshold
-                g = g + ( SampleType )( re * ( 1.f - g ));
+            history[ _historyIndex ] = history[ _historyIndex + TAPS ] = outputBuffer[ c ][ i ];
+
+            // contiguous window of the last TAPS samples, oldest first
+            const double* window = history + _historyIndex + 1;
+
+            intervalPeak = std::max( intervalPeak, ( float ) fabs( window[ TAPS / 2 ] ));
+
+            for ( int phase = _firstPhase; phase < OVERSAMPLING - 1; phase += _phaseStep )
+            {
+                double interpolated = 0.0;
+                for ( int t = 0; t < TAPS; ++t )
+                    interpolated += window[ t ] * _phaseCoefficients[ phase ][ t ];
+
+                intervalPeak = std::max( intervalPeak, ( float ) fabs( interpolated ));
             }
+        }
+
+        if ( ++_historyIndex == TAPS )
+            _historyIndex = 0;
 
-            leftBuffer[ i ] = ( ol * tr * g );
+        float truePeak = std::max( intervalPeak, _lastPeak );
+        _lastPeak      = intervalPeak;
 
-            if ( hasRight )
-                rightBuffer[ i ] = ( or_ * tr * g );
+        double lookaheadGain = getLookaheadGain( truePeak );
+
+        if ( amount != nullptr )
+            lookaheadGain = 1.0 + ( lookaheadGain - 1.0 ) * amount[ i ];
+
+        minimumGain = std::min( minimumGain, ( float ) lookaheadGain );
+        maximumGain = std::max( maximumGain, ( float ) lookaheadGain );
+
+        // delay the signal so the gain reduction precedes the peak
+
+        for ( int c = 0; c < numChannels; ++c )
+        {
+            double* delayLine = _delayLines + ( c * _delaySize );
+            double sample     = outputBuffer[ c ][ i ];
+            SampleType output = ( SampleType )( delayLine[ _delayIndex ] * lookaheadGain );
+
+            outputBuffer[ c ][ i ]   = output;
+            delayLine[ _delayIndex ] = sample;
+
+            outputPeaks  [ c ] = std::max( outputPeaks[ c ], ( float ) fabs( output ));
+            outputSquares[ c ] += ( double ) output * output;
         }
+
+        if ( ++_delayIndex == _delaySize )
+            _delayIndex = 0;
     }
-    gain = g;
+
+    if ( outputMeter != nullptr ) {
+        for ( int c = 0; c < numChannels; ++c )
+            outputMeter->addOutput( c, outputPeaks[ c ], outputSquares[ c ] );
+    }
+
+    // channels beyond the supported amount are silenced rather than passed unlimited
+
+    for ( int c = numChannels; c < numOutChannels; ++c )
+        std::fill( outputBuffer[ c ] + offset, outputBuffer[ c ] + offset + length, ( SampleType ) 0 );
 }
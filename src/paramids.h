@@ -47,6 +47,17 @@ enum
     kReverbDryMixId,          // reverb wet mix
     kReverbWetMixId,          // reverb dry mix
 
+    kLFOFilterShapeId,        // waveform of the filter LFO
+    kLFOBitResolutionShapeId, // waveform of the bit resolution LFO
+    kLFOFilterSyncId,         // tempo sync of the filter LFO
+    kLFOBitResolutionSyncId,  // tempo sync of the bit resolution LFO
+
+    kLimiterLookaheadId,      // lookahead true-peak limiting
+    kBypassId,                // bypass (crossfaded, letting the tail ring out)
+    kQualityId,               // processing quality tier (auto, eco or high)
+    kProgramId,               // program change, selecting a preset of the PresetBank
+    kSidechainDuckId,         // amount by which the sidechain input ducks the wet signal
+
     kVuPPMId                  // for the Vu value return to host
 };
 
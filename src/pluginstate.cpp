@@ -0,0 +1,234 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "pluginstate.h"
+#include "paramids.h"
+#include "byteorder.h"
+#include <string.h>
+
+namespace Igorski {
+
+const uint32_t PluginState::PARAMETER_IDS[ PluginState::PARAMETER_AMOUNT ] = {
+    kReverbSizeId,
+    kReverbWidthId,
+    kReverbDryMixId,
+    kReverbWetMixId,
+    kReverbFreezeId,
+    kReverbPlaybackRateId,
+    kBitResolutionId,
+    kBitResolutionChainId,
+    kLFOBitResolutionId,
+    kLFOBitResolutionDepthId,
+    kDecimatorId,
+    kFilterCutoffId,
+    kFilterResonanceId,
+    kLFOFilterId,
+    kLFOFilterDepthId,
+    // added after the initial release
+    kLFOFilterShapeId,
+    kLFOBitResolutionShapeId,
+    kLFOFilterSyncId,
+    kLFOBitResolutionSyncId,
+    kLimiterLookaheadId,
+    kBypassId,
+    kQualityId,
+    kSidechainDuckId
+};
+
+using namespace ByteOrder;
+
+// constructor
+
+PluginState::PluginState()
+{
+    clear();
+}
+
+/* public methods */
+
+bool PluginState::read( const char* data, size_t size )
+{
+    clear();
+
+    if ( size >= HEADER_SIZE && readUint32( data ) == MAGIC )
+    {
+        _version = readUint32( data + 4 );
+
+        size_t amount   = readUint32( data + 8 );
+        size_t position = HEADER_SIZE;
+
+        if ( _version == 0 || amount > ( size - position ) / 4 )
+            return false;
+
+        readValues( data + position, amount );
+        position += amount * 4;
+
+        // extension chunks (a truncated chunk ends the state)
+
+        while ( size - position >= 8 )
+        {
+            uint32_t id        = readUint32( data + position );
+            uint32_t chunkSize = readUint32( data + position + 4 );
+
+            position += 8;
+
+            if ( chunkSize > size - position )
+                break;
+
+            if ( _chunkAmount < MAX_CHUNKS ) {
+                Chunk& chunk = _chunks[ _chunkAmount++ ];
+                chunk.id   = id;
+                chunk.size = chunkSize;
+                chunk.data = data + position;
+            }
+            position += chunkSize;
+        }
+        return true;
+    }
+
+    // legacy state: a sequence of floats, of which the initial release stored
+    // LEGACY_PARAMETER_AMOUNT while later releases appended more
+
+    size_t amount = size / 4;
+
+    if ( amount < LEGACY_PARAMETER_AMOUNT )
+        return false;
+
+    readValues( data, amount );
+
+    return true;
+}
+
+size_t PluginState::write( char* data, size_t maxSize ) const
+{
+    size_t size = HEADER_SIZE + PARAMETER_AMOUNT * 4;
+
+    for ( int i = 0; i < _chunkAmount; ++i )
+        size += 8 + _chunks[ i ].size;
+
+    if ( size > maxSize )
+        return 0;
+
+    writeUint32( data,     MAGIC );
+    writeUint32( data + 4, VERSION );
+    writeUint32( data + 8, PARAMETER_AMOUNT );
+
+    size_t position = HEADER_SIZE;
+
+    for ( int i = 0; i < PARAMETER_AMOUNT; ++i, position += 4 )
+        writeFloat( data + position, _values[ i ] );
+
+    for ( int i = 0; i < _chunkAmount; ++i )
+    {
+        writeUint32( data + position,     _chunks[ i ].id );
+        writeUint32( data + position + 4, _chunks[ i ].size );
+        memcpy( data + position + 8, _chunks[ i ].data, _chunks[ i ].size );
+
+        position += 8 + _chunks[ i ].size;
+    }
+    return size;
+}
+
+bool PluginState::getValue( uint32_t paramId, float& value ) const
+{
+    int index = getIndex( paramId );
+
+    if ( index < 0 || !_hasValues[ index ])
+        return false;
+
+    value = _values[ index ];
+    return true;
+}
+
+void PluginState::setValue( uint32_t paramId, float value )
+{
+    int index = getIndex( paramId );
+
+    if ( index < 0 )
+        return;
+
+    _values[ index ]    = value;
+    _hasValues[ index ] = true;
+}
+
+void PluginState::readValues( const char* data, size_t amount )
+{
+    // parameters stored by newer versions are skipped
+
+    for ( size_t i = 0; i < amount && i < PARAMETER_AMOUNT; ++i )
+    {
+        _values[ i ]    = readFloat( data + i * 4 );
+        _hasValues[ i ] = true;
+    }
+}
+
+bool PluginState::addChunk( uint32_t id, const char* data, uint32_t size )
+{
+    if ( _chunkAmount == MAX_CHUNKS )
+        return false;
+
+    Chunk& chunk = _chunks[ _chunkAmount++ ];
+    chunk.id   = id;
+    chunk.size = size;
+    chunk.data = data;
+
+    return true;
+}
+
+const PluginState::Chunk* PluginState::getChunk( uint32_t id ) const
+{
+    for ( int i = 0; i < _chunkAmount; ++i )
+    {
+        if ( _chunks[ i ].id == id )
+            return &_chunks[ i ];
+    }
+    return nullptr;
+}
+
+uint32_t PluginState::getVersion() const
+{
+    return _version;
+}
+
+/* private methods */
+
+int PluginState::getIndex( uint32_t paramId ) const
+{
+    for ( int i = 0; i < PARAMETER_AMOUNT; ++i )
+    {
+        if ( PARAMETER_IDS[ i ] == paramId )
+            return i;
+    }
+    return -1;
+}
+
+void PluginState::clear()
+{
+    for ( int i = 0; i < PARAMETER_AMOUNT; ++i ) {
+        _values[ i ]    = 0.f;
+        _hasValues[ i ] = false;
+    }
+    _version     = 0;
+    _chunkAmount = 0;
+}
+
+}
@@ -0,0 +1,115 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __PLUGINSTATE_H_INCLUDED__
+#define __PLUGINSTATE_H_INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Igorski {
+
+/**
+ * PluginState (de)serializes the state of the plugin. It is shared by the processor and
+ * the controller, both read the full state in a single read and parse it here.
+ *
+ * The state is written as (all values little endian):
+ *
+ *   uint32 magic, uint32 version, uint32 parameter amount
+ *   float[ parameter amount ] parameter values (in the order of PARAMETER_IDS)
+ *   optional extension chunks, each as: uint32 id, uint32 size, size bytes of data
+ *
+ * New parameters are appended to PARAMETER_IDS. States holding fewer parameters leave the
+ * remaining parameters unset, while parameters and chunks unknown to this version are skipped.
+ * States written prior to the versioned format (a sequence of raw floats) are read as well.
+ */
+class PluginState {
+
+    public:
+        static const uint32_t MAGIC   = 0x44504746; // "FGPD"
+        static const uint32_t VERSION = 1;
+
+        // the parameters in the order of the state, newly added parameters must be appended
+
+        static const int PARAMETER_AMOUNT = 23;
+        static const uint32_t PARAMETER_IDS[ PARAMETER_AMOUNT ];
+
+        // the amount of parameters the first (unversioned) release stored
+
+        static const int LEGACY_PARAMETER_AMOUNT = 15;
+
+        static const int HEADER_SIZE         = 12;
+        static const int MAX_CHUNKS          = 8;
+        static const int MAX_EXTENSION_SIZE  = 4096;
+        static const int MAX_SIZE            = HEADER_SIZE + PARAMETER_AMOUNT * 4 + MAX_EXTENSION_SIZE;
+
+        struct Chunk {
+            uint32_t id;
+            uint32_t size;
+            const char* data;
+        };
+
+        PluginState();
+
+        // parses the state contained in given data, returns false when it does not contain
+        // a valid state. Chunks reference given data, which must outlive their use
+
+        bool read( const char* data, size_t size );
+
+        // writes the state into given data (which should hold MAX_SIZE bytes), returns the
+        // written size (or 0 when the state does not fit)
+
+        size_t write( char* data, size_t maxSize ) const;
+
+        // retrieve the value of given parameter, returns false when the state doesn't contain
+        // the parameter (in which case value is left untouched)
+
+        bool getValue( uint32_t paramId, float& value ) const;
+        void setValue( uint32_t paramId, float value );
+
+        // applies given amount of packed (little endian) parameter values, in the order of
+        // PARAMETER_IDS, onto this state (e.g. the parameter records of a PresetBank)
+
+        void readValues( const char* data, size_t amount );
+
+        // extension chunks, the data of added chunks must remain available until written
+        // getChunk() returns nullptr when the state contains no chunk with given id
+
+        bool addChunk( uint32_t id, const char* data, uint32_t size );
+        const Chunk* getChunk( uint32_t id ) const;
+
+        uint32_t getVersion() const;
+
+    private:
+        float _values[ PARAMETER_AMOUNT ];
+        bool  _hasValues[ PARAMETER_AMOUNT ];
+        uint32_t _version; // 0 for legacy states
+
+        Chunk _chunks[ MAX_CHUNKS ];
+        int _chunkAmount;
+
+        int getIndex( uint32_t paramId ) const;
+        void clear();
+};
+}
+
+#endif
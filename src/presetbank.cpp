@@ -0,0 +1,375 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "presetbank.h"
+#include "byteorder.h"
+#include <algorithm>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Igorski {
+
+using namespace ByteOrder;
+
+// the bank shared by all instances within the process
+
+static PresetBank* sharedBank = nullptr;
+static std::mutex sharedBankMutex;
+
+// constructors / destructor (the shared bank is constructed by acquire() and destructed by release())
+
+PresetBank::PresetBank() : _userBank( nullptr ), _references( 0 )
+{
+    map( getFactoryBankPath(), _factoryBank );
+    mapUserBank( getUserBankPath() );
+}
+
+PresetBank::PresetBank( const std::string& path ) : _userBank( nullptr ), _references( 0 )
+{
+    map( path, _factoryBank );
+    mapUserBank( "" ); // leaves the user bank empty
+}
+
+PresetBank::~PresetBank()
+{
+    unmap( _factoryBank );
+
+    for ( MappedBank* bank : _userBanks ) {
+        unmap( *bank );
+        delete bank;
+    }
+}
+
+/* public methods */
+
+PresetBank* PresetBank::acquire()
+{
+    std::lock_guard<std::mutex> lock( sharedBankMutex );
+
+    if ( sharedBank == nullptr )
+        sharedBank = new PresetBank();
+
+    ++sharedBank->_references;
+
+    return sharedBank;
+}
+
+void PresetBank::release( PresetBank* bank )
+{
+    std::lock_guard<std::mutex> lock( sharedBankMutex );
+
+    if ( bank == nullptr || bank != sharedBank )
+        return;
+
+    if ( --sharedBank->_references == 0 ) {
+        delete sharedBank;
+        sharedBank = nullptr;
+    }
+}
+
+int PresetBank::getAmount() const
+{
+    return _factoryBank.presetAmount + _userBank.load()->presetAmount;
+}
+
+bool PresetBank::getName( int index, char* name, size_t maxLength ) const
+{
+    const MappedBank* bank = getBank( index );
+
+    if ( bank == nullptr || maxLength == 0 )
+        return false;
+
+    // names are zero padded but not necessarily zero terminated
+
+    const char* source = bank->names + ( size_t ) index * NAME_LENGTH;
+    size_t length = 0;
+
+    while ( length < NAME_LENGTH && length < maxLength - 1 && source[ length ] != '\0' )
+        ++length;
+
+    memcpy( name, source, length );
+    name[ length ] = '\0';
+
+    return true;
+}
+
+bool PresetBank::getPreset( int index, PluginState& state ) const
+{
+    const MappedBank* bank = getBank( index );
+
+    if ( bank == nullptr )
+        return false;
+
+    state.readValues( bank->records + ( size_t ) index * bank->parameterAmount * 4, bank->parameterAmount );
+
+    return true;
+}
+
+bool PresetBank::isFactoryPreset( int index ) const
+{
+    return index >= 0 && index < _factoryBank.presetAmount;
+}
+
+bool PresetBank::write( const std::string& path, const std::vector<std::string>& names,
+                        const std::vector<PluginState>& presets )
+{
+    if ( names.size() != presets.size() )
+        return false;
+
+    uint32_t presetAmount = ( uint32_t ) presets.size();
+    std::vector<char> data( HEADER_SIZE + presetAmount * ( NAME_LENGTH + PluginState::PARAMETER_AMOUNT * 4 ), 0 );
+
+    writeUint32( &data[ 0 ],  MAGIC );
+    writeUint32( &data[ 4 ],  VERSION );
+    writeUint32( &data[ 8 ],  presetAmount );
+    writeUint32( &data[ 12 ], PluginState::PARAMETER_AMOUNT );
+
+    char* nameIndex = &data[ HEADER_SIZE ];
+    char* records   = nameIndex + presetAmount * NAME_LENGTH;
+
+    for ( uint32_t i = 0; i < presetAmount; ++i )
+    {
+        memcpy( nameIndex + i * NAME_LENGTH, names[ i ].c_str(), std::min( names[ i ].size(), ( size_t ) NAME_LENGTH ));
+
+        for ( int p = 0; p < PluginState::PARAMETER_AMOUNT; ++p )
+        {
+            float value = 0.f;
+            presets[ i ].getValue( PluginState::PARAMETER_IDS[ p ], value );
+            writeFloat( records + ( i * PluginState::PARAMETER_AMOUNT + p ) * 4, value );
+        }
+    }
+
+    // write into a temporary file in the same directory (so it can be renamed atomically)
+    // truncating the existing file would invalidate the mappings of other instances
+
+    std::string temporaryPath = path + ".tmp";
+    FILE* file = fopen( temporaryPath.c_str(), "wb" );
+
+    if ( file == nullptr )
+        return false;
+
+    bool written = fwrite( data.data(), 1, data.size(), file ) == data.size();
+
+    if ( fclose( file ) != 0 || !written ) {
+        remove( temporaryPath.c_str() );
+        return false;
+    }
+
+#ifdef _WIN32
+    bool renamed = MoveFileExA( temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING ) != 0;
+#else
+    bool renamed = rename( temporaryPath.c_str(), path.c_str() ) == 0;
+#endif
+
+    if ( !renamed ) {
+        remove( temporaryPath.c_str() );
+        return false;
+    }
+
+    // map the new file when it replaced the user bank of the shared bank
+
+    std::lock_guard<std::mutex> lock( sharedBankMutex );
+
+    if ( sharedBank != nullptr && path == getUserBankPath() )
+        sharedBank->mapUserBank( path );
+
+    return true;
+}
+
+std::string PresetBank::getFactoryBankPath()
+{
+    // the factory bank resides in the Resources folder of the bundle, which is a
+    // sibling of the (architecture specific) folder containing the plugin binary
+
+    std::string modulePath;
+
+#ifdef _WIN32
+    HMODULE module = nullptr;
+    char path[ MAX_PATH ];
+
+    if ( GetModuleHandleExA( GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                             ( LPCSTR ) &PresetBank::getFactoryBankPath, &module ) &&
+         GetModuleFileNameA( module, path, MAX_PATH ) > 0 )
+        modulePath = path;
+#else
+    Dl_info info;
+
+    if ( dladdr(( void* ) &PresetBank::getFactoryBankPath, &info ) != 0 && info.dli_fname != nullptr )
+        modulePath = info.dli_fname;
+#endif
+
+    size_t separator = modulePath.find_last_of( "/\\" );
+
+    if ( separator == std::string::npos )
+        return "fogpad.presets";
+
+    return modulePath.substr( 0, separator + 1 ) + "../Resources/fogpad.presets";
+}
+
+std::string PresetBank::getUserBankPath()
+{
+#if defined( _WIN32 )
+    const char* appData = getenv( "APPDATA" );
+    return std::string( appData ? appData : "." ) + "\\FogPad\\user.presets";
+#elif defined( __APPLE__ )
+    const char* home = getenv( "HOME" );
+    return std::string( home ? home : "." ) + "/Library/Application Support/FogPad/user.presets";
+#else
+    const char* home = getenv( "HOME" );
+    return std::string( home ? home : "." ) + "/.fogpad/user.presets";
+#endif
+}
+
+/* private methods */
+
+bool PresetBank::map( const std::string& path, MappedBank& bank )
+{
+    bank.data            = nullptr;
+    bank.size            = 0;
+    bank.handle          = nullptr;
+    bank.presetAmount    = 0;
+    bank.parameterAmount = 0;
+    bank.names           = nullptr;
+    bank.records         = nullptr;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+    if ( file == INVALID_HANDLE_VALUE )
+        return false;
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+
+    if ( GetFileSizeEx( file, &fileSize ) && fileSize.QuadPart >= HEADER_SIZE )
+        mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+    CloseHandle( file );
+
+    if ( mapping == nullptr )
+        return false;
+
+    bank.data   = ( const char* ) MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+    bank.size   = ( size_t ) fileSize.QuadPart;
+    bank.handle = mapping;
+
+    if ( bank.data == nullptr ) {
+        unmap( bank );
+        return false;
+    }
+#else
+    int file = open( path.c_str(), O_RDONLY );
+
+    if ( file < 0 )
+        return false;
+
+    struct stat fileInfo;
+    void* data = MAP_FAILED;
+
+    if ( fstat( file, &fileInfo ) == 0 && fileInfo.st_size >= HEADER_SIZE )
+        data = mmap( nullptr, ( size_t ) fileInfo.st_size, PROT_READ, MAP_SHARED, file, 0 );
+
+    close( file );
+
+    if ( data == MAP_FAILED )
+        return false;
+
+    bank.data = ( const char* ) data;
+    bank.size = ( size_t ) fileInfo.st_size;
+#endif
+
+    // validate the header and the size of the name index and records
+
+    uint32_t presetAmount    = readUint32( bank.data + 8 );
+    uint32_t parameterAmount = readUint32( bank.data + 12 );
+    uint64_t requiredSize    = HEADER_SIZE + ( uint64_t ) presetAmount * ( NAME_LENGTH + ( uint64_t ) parameterAmount * 4 );
+
+    if ( readUint32( bank.data ) != MAGIC || readUint32( bank.data + 4 ) == 0 || requiredSize > bank.size ) {
+        unmap( bank );
+        return false;
+    }
+
+    bank.presetAmount    = ( int ) presetAmount;
+    bank.parameterAmount = ( int ) parameterAmount;
+    bank.names           = bank.data + HEADER_SIZE;
+    bank.records         = bank.names + ( size_t ) presetAmount * NAME_LENGTH;
+
+    return true;
+}
+
+void PresetBank::mapUserBank( const std::string& path )
+{
+    // the previous mapping is retained as it can still be read by other threads
+    // (the renamed file remains valid while mapped), it is unmapped on destruction
+
+    MappedBank* bank = new MappedBank();
+    map( path, *bank );
+
+    _userBanks.push_back( bank );
+    _userBank.store( bank );
+}
+
+void PresetBank::unmap( MappedBank& bank )
+{
+#ifdef _WIN32
+    if ( bank.data != nullptr )
+        UnmapViewOfFile( bank.data );
+
+    if ( bank.handle != nullptr )
+        CloseHandle(( HANDLE ) bank.handle );
+#else
+    if ( bank.data != nullptr )
+        munmap(( void* ) bank.data, bank.size );
+#endif
+    bank.data         = nullptr;
+    bank.handle       = nullptr;
+    bank.size         = 0;
+    bank.presetAmount = 0;
+}
+
+const PresetBank::MappedBank* PresetBank::getBank( int& index ) const
+{
+    if ( index < 0 )
+        return nullptr;
+
+    if ( index < _factoryBank.presetAmount )
+        return &_factoryBank;
+
+    index -= _factoryBank.presetAmount;
+
+    const MappedBank* userBank = _userBank.load();
+
+    return ( index < userBank->presetAmount ) ? userBank : nullptr;
+}
+
+}
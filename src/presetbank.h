@@ -0,0 +1,132 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __PRESETBANK_H_INCLUDED__
+#define __PRESETBANK_H_INCLUDED__
+
+#include "pluginstate.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace Igorski {
+
+/**
+ * PresetBank provides the factory and user presets. Each bank is a single binary file
+ * which is memory-mapped read-only and shared by all plugin instances within the process.
+ * Presets are looked up by index without reading (or copying) the remainder of the bank.
+ *
+ * A bank file is laid out as (all values little endian):
+ *
+ *   uint32 magic, uint32 version, uint32 preset amount, uint32 parameter amount
+ *   char[ preset amount ][ NAME_LENGTH ] name index (zero padded)
+ *   float[ preset amount ][ parameter amount ] parameter records (in the order of PluginState::PARAMETER_IDS)
+ *
+ * The factory bank (fogpad.presets) is shipped inside the plugin bundle's Resources folder,
+ * the user bank (user.presets) resides in the users application data folder. Presets are
+ * indexed with the factory presets first, followed by the user presets.
+ */
+class PresetBank {
+
+    public:
+        static const uint32_t MAGIC       = 0x42504746; // "FGPB"
+        static const uint32_t VERSION     = 1;
+        static const int HEADER_SIZE      = 16;
+        static const int NAME_LENGTH      = 32;
+
+        // retrieve the bank shared by all instances, this maps the bank files on first
+        // acquisition. Each acquire() must be balanced by a call to release()
+        // (neither should be invoked on the audio thread)
+
+        static PresetBank* acquire();
+        static void release( PresetBank* bank );
+
+        // maps a single bank file independent of the shared bank (e.g. for the command line
+        // tools), its presets are indexed as factory presets. Banks created this way are
+        // owned by the caller (getAmount() returns 0 when the file isn't a valid bank)
+
+        explicit PresetBank( const std::string& path );
+        ~PresetBank();
+
+        // the amount of presets in both banks
+
+        int getAmount() const;
+
+        // copies the name of the preset at given index into given buffer, returns false
+        // when no preset exists at given index
+
+        bool getName( int index, char* name, size_t maxLength ) const;
+
+        // applies the parameter values of the preset at given index onto given state
+        // returns false when no preset exists at given index. Does not allocate
+
+        bool getPreset( int index, PluginState& state ) const;
+
+        bool isFactoryPreset( int index ) const;
+
+        // writes a bank file containing given presets (e.g. to create a user bank). The file is
+        // written under a temporary name and then renamed over the existing file, as other
+        // instances may have the existing file mapped. When given path is that of the user bank,
+        // the shared bank maps the new file (the previous mapping remains valid until the shared
+        // bank is destructed, as it may still be read). On Windows an existing file cannot be
+        // replaced while it is mapped, in which case false is returned
+
+        static bool write( const std::string& path, const std::vector<std::string>& names,
+                           const std::vector<PluginState>& presets );
+
+        static std::string getFactoryBankPath();
+        static std::string getUserBankPath();
+
+    private:
+        PresetBank();
+
+        // a read-only mapping of a bank file
+
+        struct MappedBank {
+            const char* data;
+            size_t size;
+            void* handle;           // platform specific handle of the mapping
+            int presetAmount;
+            int parameterAmount;
+            const char* names;
+            const char* records;
+        };
+
+        MappedBank _factoryBank;
+
+        // the current mapping of the user bank, and all its mappings (owned)
+
+        std::atomic<const MappedBank*> _userBank;
+        std::vector<MappedBank*> _userBanks;
+
+        int _references;
+
+        static bool map( const std::string& path, MappedBank& bank );
+        void mapUserBank( const std::string& path );
+        static void unmap( MappedBank& bank );
+
+        // resolves the bank and its local index for given preset index
+        const MappedBank* getBank( int& index ) const;
+};
+}
+
+#endif
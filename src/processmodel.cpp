@@ -0,0 +1,109 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "processmodel.h"
+#include "paramids.h"
+#include "calc.h"
+#include "lfo.h"
+#include <cmath>
+
+namespace Igorski {
+namespace ProcessModel {
+
+// the value of given parameter within given state (or its default when absent)
+
+static float getValue( const PluginState& state, uint32_t paramId )
+{
+    float value = getDefault( paramId );
+    state.getValue( paramId, value );
+
+    return value;
+}
+
+float getDefault( uint32_t paramId )
+{
+    switch ( paramId )
+    {
+        case kReverbSizeId:
+        case kReverbDryMixId:
+        case kReverbWetMixId:
+        case kReverbPlaybackRateId:
+        case kLFOBitResolutionDepthId:
+        case kFilterCutoffId:
+        case kLFOFilterDepthId:
+            return 0.5f;
+
+        case kReverbWidthId:
+        case kFilterResonanceId:
+            return 1.f;
+
+        default:
+            return 0.f;
+    }
+}
+
+void apply( ReverbProcess* process, const PluginState& state, VST::Quality quality )
+{
+    process->setRoomSize( getValue( state, kReverbSizeId ));
+    process->setWidth( getValue( state, kReverbWidthId ));
+    process->setDry( getValue( state, kReverbDryMixId ));
+    process->setWet( getValue( state, kReverbWetMixId ));
+    process->setMode( getValue( state, kReverbFreezeId ));
+    process->setPlaybackRate( getValue( state, kReverbPlaybackRateId ));
+
+    process->bitCrusherPostMix = Calc::toBool( getValue( state, kBitResolutionChainId ));
+
+    process->bitCrusher->setAmount( getValue( state, kBitResolutionId ));
+    process->bitCrusher->setLFO( getValue( state, kLFOBitResolutionId ), getValue( state, kLFOBitResolutionDepthId ),
+                                 getLFOSync( getValue( state, kLFOBitResolutionSyncId )));
+    process->bitCrusher->lfo->setWaveform( Calc::toIndex( getValue( state, kLFOBitResolutionShapeId ), LFO::WAVEFORM_AMOUNT ));
+
+    // invert the decimator range 0 == max bits (no distortion), 1 == min bits (severely distorted)
+    float scaledDecimator = std::abs( getValue( state, kDecimatorId ) - 1.0f );
+    int decimation = ( int )( scaledDecimator * 32.f );
+    process->decimator->setBits( decimation );
+    process->decimator->setRate( scaledDecimator );
+
+    process->filter->updateProperties(
+        getValue( state, kFilterCutoffId ), getValue( state, kFilterResonanceId ),
+        getValue( state, kLFOFilterId ),    getValue( state, kLFOFilterDepthId ),
+        getLFOSync( getValue( state, kLFOFilterSyncId ))
+    );
+    process->filter->lfo->setWaveform( Calc::toIndex( getValue( state, kLFOFilterShapeId ), LFO::WAVEFORM_AMOUNT ));
+
+    process->limiter->setLookahead( Calc::toBool( getValue( state, kLimiterLookaheadId )));
+    process->ducker->setAmount( getValue( state, kSidechainDuckId ));
+
+    process->setBypass( Calc::toBool( getValue( state, kBypassId )));
+    process->setQuality( quality );
+}
+
+float getLFOSync( float value )
+{
+    // the first entry of the sync list is "free running", the remainder
+    // are the entries of VST::LFO_SYNC_QUARTER_NOTES
+    int index = Calc::toIndex( value, VST::LFO_SYNC_AMOUNT + 1 );
+    return ( index == 0 ) ? 0.f : VST::LFO_SYNC_QUARTER_NOTES[ index - 1 ];
+}
+
+}
+}
@@ -0,0 +1,56 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __PROCESSMODEL_H_INCLUDED__
+#define __PROCESSMODEL_H_INCLUDED__
+
+#include "global.h"
+#include "pluginstate.h"
+#include "reverbprocess.h"
+
+namespace Igorski {
+
+/**
+ * ProcessModel translates the normalized (0 - 1 range) values of the plugin parameters
+ * (see paramids.h) into the properties of the ReverbProcess. It is shared by the plugin
+ * and the command line tools so both render the same parameters identically.
+ */
+namespace ProcessModel {
+
+    // the normalized value of given parameter for a newly created plugin instance
+
+    float getDefault( uint32_t paramId );
+
+    // applies the parameter values of given state onto given process, parameters absent
+    // from the state are applied at their default value. quality is the resolved quality
+    // tier (the quality parameter itself selects a tier automatically, see FogPad::getQuality())
+
+    void apply( ReverbProcess* process, const PluginState& state, VST::Quality quality );
+
+    // translates the normalized value of an LFO sync parameter into the
+    // length of a cycle in quarter notes (0 when the LFO runs freely)
+
+    float getLFOSync( float value );
+}
+}
+
+#endif
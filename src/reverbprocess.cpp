@@ -26,8 +26,15 @@
 
 namespace Igorski {
 
-ReverbProcess::ReverbProcess( int amountOfChannels ) {
+ReverbProcess::ReverbProcess( int amountOfChannels, int maxBufferSize ) {
     _amountOfChannels = amountOfChannels;
+    _maxBufferSize    = std::max( 1, maxBufferSize );
+
+    // the scratch pool holds the pre- and post mix buffers (each a block per channel), the
+    // modulation buffers of the filter, bit crusher and decimator, the bypass crossfade
+    // and the ducking gain of the wet signal
+
+    _scratchPool = new ScratchPool( _maxBufferSize, ( amountOfChannels * 2 ) + 5 );
 
     _maxRecordIndex = Calc::millisecondsToBuffer( MAX_RECORD_TIME_MS );
     _recordBuffer   = new AudioBuffer( amountOfChannels, _maxRecordIndex );
@@ -36,13 +43,24 @@ ReverbProcess::ReverbProcess( int amountOfChannels ) {
         _recordIndices[ i ] = 0;
     }
     _playbackReadIndex = 0.f;
+    _position          = 0.0;
+    _hasPosition       = false;
+
+    _bypass     = false;
+    _tailSilent = false;
+    _bypassMix  = 1.f;
+    _bypassStep = 1.f / std::max( 1, Calc::millisecondsToBuffer( BYPASS_FADE_MS ));
 
     bitCrusher = new BitCrusher( 8, .5f, .5f );
-    decimator  = new Decimator( 32, 0.f );
+    decimator  = new Decimator( 32, 1.f );
     filter     = new Filter();
     limiter    = new Limiter( 10.f, 500.f, .6f );
+    ducker     = new Ducker( DUCK_ATTACK_MS, DUCK_RELEASE_MS );
+    levelMeter = new LevelMeter();
+    profiler   = new StageProfiler();
 
     setupFilters();
+    setQuality( VST::QUALITY_HIGH );
 
     setWet     ( INITIAL_WET );
     setRoomSize( INITIAL_ROOM );
@@ -54,21 +72,20 @@ ReverbProcess::ReverbProcess( int amountOfChannels ) {
     // this will initialize the buffers with silence
     mute();
 
-    // will be lazily created in the process function
-    _preMixBuffer  = nullptr;
-    _postMixBuffer = nullptr;
-    _playbackRate  = 1.f;
+    _playbackRate = 1.f;
 }
 
 ReverbProcess::~ReverbProcess() {
     delete _recordIndices;
     delete _recordBuffer;
-    delete _postMixBuffer;
-    delete _preMixBuffer;
+    delete _scratchPool;
     delete bitCrusher;
     delete decimator;
     delete filter;
     delete limiter;
+    delete ducker;
+    delete levelMeter;
+    delete profiler;
     clearFilters();
 }
 
@@ -160,6 +177,47 @@ void ReverbProcess::setPlaybackRate( float value )
     }
 }
 
+void ReverbProcess::setTempo( double tempo )
+{
+    filter->lfo->setTempo( tempo );
+    bitCrusher->lfo->setTempo( tempo );
+}
+
+void ReverbProcess::setPosition( double quarterNotes )
+{
+    _position    = quarterNotes;
+    _hasPosition = true;
+}
+
+void ReverbProcess::setBypass( bool value )
+{
+    if ( value == _bypass )
+        return;
+
+    _bypass = value;
+
+    // the reverb resumes processing from a silent state when the tail had faded out
+    _tailSilent = false;
+}
+
+bool ReverbProcess::getBypass()
+{
+    return _bypass;
+}
+
+void ReverbProcess::setQuality( VST::Quality quality )
+{
+    _quality = quality;
+
+    filter->setQuality( quality );
+    limiter->setQuality( quality );
+}
+
+VST::Quality ReverbProcess::getQuality()
+{
+    return _quality;
+}
+
 float ReverbProcess::getMode()
 {
     return ( _mode >= FREEZE_MODE ) ? 1 : 0;
@@ -226,6 +284,28 @@ void ReverbProcess::clearFilters()
     }
 }
 
+void ReverbProcess::mixChannel( float* outBuffer, const float* postMixBuffer, const float* inBuffer,
+                                const float* duckGain, int bufferSize, int channel )
+{
+    float peak = 0.f;
+    double sumOfSquares = 0.0;
+
+    Kernels::mix( outBuffer, postMixBuffer, inBuffer, duckGain, _wet1, _dry, bufferSize, peak, sumOfSquares );
+
+    levelMeter->addInput( channel, peak, sumOfSquares );
+}
+
+void ReverbProcess::mixChannel( double* outBuffer, const float* postMixBuffer, const double* inBuffer,
+                                const float* duckGain, int bufferSize, int channel )
+{
+    float peak = 0.f;
+    double sumOfSquares = 0.0;
+
+    Kernels::mix( outBuffer, postMixBuffer, inBuffer, duckGain, _wet1, _dry, bufferSize, peak, sumOfSquares );
+
+    levelMeter->addInput( channel, peak, sumOfSquares );
+}
+
 void ReverbProcess::update()
 {
     // Recalculate internal values after parameter change
@@ -25,15 +25,20 @@
 
 #include "global.h"
 #include "audiobuffer.h"
+#include "audiobufferview.h"
+#include "scratchpool.h"
 #include "comb.h"
 #include "allpass.h"
 #include "bitcrusher.h"
 #include "decimator.h"
 #include "filter.h"
 #include "limiter.h"
+#include "levelmeter.h"
+#include "ducker.h"
+#include "stageprofiler.h"
+#include "kernels/kernels.h"
 #include <vector>
-
-using namespace Steinberg;
+#include <string.h>
 
 namespace Igorski {
 class ReverbProcess {
@@ -92,15 +97,29 @@ class ReverbProcess {
     static constexpr float MIN_PLAYBACK_RATE = 0.5f;
     static constexpr float MAX_PLAYBACK_RATE = 1.5f;
 
+    // bypass crossfade duration and the level below which the reverb tail is considered silent
+
+    static constexpr float BYPASS_FADE_MS = 20.f;
+    static constexpr float TAIL_SILENCE   = 0.00003f; // roughly -90 dB
+
+    // response of the sidechain envelope follower ducking the wet signal
+
+    static constexpr float DUCK_ATTACK_MS  = 10.f;
+    static constexpr float DUCK_RELEASE_MS = 250.f;
+
     public:
-        ReverbProcess( int amountOfChannels );
+        // maxBufferSize is the largest amount of samples processed at once (larger
+        // buffers provided to process() are processed in chunks of this size)
+
+        ReverbProcess( int amountOfChannels, int maxBufferSize = VST::BUFFER_SIZE );
         ~ReverbProcess();
 
-        // apply effect to incoming sampleBuffer contents
+        // apply effect to incoming sampleBuffer contents, the optional sidechain
+        // buffer (nullptr when not provided) drives the ducking of the wet signal
 
         template <typename SampleType>
         void process( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int numOutChannels,
-            int bufferSize, uint32 sampleFramesSize
+            int bufferSize, SampleType** sidechainBuffer = nullptr, int numSidechainChannels = 0
         );
 
         void mute();
@@ -119,10 +138,39 @@ class ReverbProcess {
         float getPlaybackRate();
         void setPlaybackRate( float value );
 
+        // synchronization of the tempo synced oscillators with the host. these should
+        // be invoked prior to process() with the tempo (in BPM) and the musical position
+        // (in quarter notes) at the start of the next buffer. When no position is provided
+        // for a buffer, the oscillators run freely at the last known tempo
+
+        void setTempo( double tempo );
+        void setPosition( double quarterNotes );
+
+        // when bypassed, the input is crossfaded to pass through unaltered while the
+        // reverb receives no further input. The remaining tail rings out on top of the
+        // input, after which the input is copied to the output without processing
+
+        void setBypass( bool value );
+        bool getBypass();
+
+        // applies given quality tier onto all stages, also see VST::Quality
+
+        void setQuality( VST::Quality quality );
+        VST::Quality getQuality();
+
         BitCrusher* bitCrusher;
         Decimator* decimator;
         Filter* filter;
         Limiter* limiter;
+        Ducker* ducker;
+
+        // measures the input and output levels of each process cycle
+
+        LevelMeter* levelMeter;
+
+        // measures the time spent in each processing stage (when enabled)
+
+        StageProfiler* profiler;
 
         // whether effects are applied onto the input delay signal or onto
         // the delayed signal itself (false = on input, true = on delay)
@@ -131,8 +179,18 @@ class ReverbProcess {
 
     private:
         AudioBuffer* _recordBuffer;  // contains the sample memory for drift mode
-        AudioBuffer* _preMixBuffer;  // buffer used for the pre-delay effect mixing
-        AudioBuffer* _postMixBuffer; // buffer used for the post-delay effect mixing
+
+        // temporary storage for the process cycle, provides the mix buffers and the
+        // modulation buffers of the effects. Reclaimed at the end of each process cycle
+
+        ScratchPool* _scratchPool;
+        int _maxBufferSize;
+
+        // the buffers the pre- and post mix stages operate on for the current process cycle, these
+        // either view pooled mix buffers or (when possible) directly view the host buffers
+
+        AudioBufferView _preMixView;  // buffer used for the pre-delay effect mixing
+        AudioBufferView _postMixView; // buffer used for the post-delay effect mixing
         int  _amountOfChannels;
         int  _maxRecordIndex;
         int* _recordIndices;
@@ -144,6 +202,16 @@ class ReverbProcess {
         float _playbackRate;
         float _playbackReadIndex;
 
+        double _position;
+        bool _hasPosition;
+
+        VST::Quality _quality;
+
+        bool _bypass;
+        bool _tailSilent;   // whether the reverb tail has faded out while bypassed
+        float _bypassMix;   // mix of the processed signal (1 = processing, 0 = bypassed)
+        float _bypassStep;  // change of the bypass mix per sample while crossfading
+
         float _gain;
         float _roomSize, _roomSize1;
         float _damp, _damp1;
@@ -155,12 +223,52 @@ class ReverbProcess {
         std::vector<combFilters*>    _combFilters;
         std::vector<allpassFilters*> _allpassFilters;
 
-        // ensures the pre- and post mix buffers match the appropriate amount of channels
-        // and buffer size. this also clones the contents of given in buffer into the pre-mix buffer
-        // the buffers are pooled so this can be called upon each process cycle without allocation overhead
+        // processes a buffer exceeding _maxBufferSize samples in chunks of at most _maxBufferSize samples
+
+        template <typename SampleType>
+        void processChunked( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int numOutChannels,
+            int bufferSize, SampleType** sidechainBuffer, int numSidechainChannels
+        );
+
+        // processes a buffer of at most _maxBufferSize samples
+
+        template <typename SampleType>
+        void processBlock( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int numOutChannels,
+            int bufferSize, SampleType** sidechainBuffer, int numSidechainChannels
+        );
+
+        // copies the input to the output without processing
+
+        template <typename SampleType>
+        void passThrough( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int numOutChannels,
+            int bufferSize
+        );
+
+        // applies the limiter onto the output, scaling the gain reduction by the mix of the
+        // processed signal when bypassing (bypassMix being nullptr when fully processing)
+
+        template <typename SampleType>
+        void limit( SampleType** outBuffer, int numOutChannels, int bufferSize, float* bypassMix );
+
+        // mixes the dry input and the processed post mix signal of a channel into the output
+        // measuring the input level within the same (vectorized) pass. The output
+        // may share its memory with either the input or the post mix buffer. When provided,
+        // duckGain specifies the gain of the wet signal for each sample (see Ducker)
+
+        void mixChannel( float* outBuffer, const float* postMixBuffer, const float* inBuffer,
+                         const float* duckGain, int bufferSize, int channel );
+        void mixChannel( double* outBuffer, const float* postMixBuffer, const double* inBuffer,
+                         const float* duckGain, int bufferSize, int channel );
+
+        // prepares the pre- and post mix views for the current process cycle. When the host provides
+        // floats, the pre mix view reads the input directly when no pre mix effects are active and
+        // the post mix view renders directly into the output when it isn't shared with the input.
+        // Otherwise mix buffers are acquired from the scratch pool (cloning the contents of the in
+        // buffer into the pre-mix buffer when required). Returns false when the scratch pool
+        // could not provide the mix buffers
 
         template <typename SampleType>
-        void prepareMixBuffers( SampleType** inBuffer, int numInChannels, int bufferSize );
+        bool prepareMixBuffers( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int bufferSize );
 
 };
 }
@@ -22,48 +22,171 @@
  */
 namespace Igorski
 {
+// provides given host buffers as float buffers when the host processes
+// in single precision (nullptr for any other sample type)
+
+template <typename SampleType>
+inline float** asFloatBuffers( SampleType** /* buffers */ )
+{
+    return nullptr;
+}
+
+template <>
+inline float** asFloatBuffers<float>( float** buffers )
+{
+    return buffers;
+}
+
 template <typename SampleType>
 void ReverbProcess::process( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int numOutChannels,
-                             int bufferSize, uint32 sampleFramesSize ) {
+                             int bufferSize, SampleType** sidechainBuffer, int numSidechainChannels ) {
+
+    // channels beyond those this process was constructed for have no record or scratch buffers
+    numInChannels = std::min( numInChannels, std::min( _amountOfChannels, ( int ) VST::MAX_CHANNELS ));
+
+    levelMeter->begin( numInChannels, numOutChannels );
+
+    // bypassed and the reverb tail has faded out ? copy the input without processing
+    // (unless the limiter is delaying the output for lookahead, as the latency must remain constant)
+
+    if ( _bypass && _tailSilent && !limiter->getLookahead() ) {
+        passThrough( inBuffer, outBuffer, numInChannels, numOutChannels, bufferSize );
+        levelMeter->measureInput( inBuffer, numInChannels, bufferSize );
+        levelMeter->measureOutput( outBuffer, numOutChannels, bufferSize );
+    }
+    else if ( bufferSize <= _maxBufferSize ) {
+        processBlock( inBuffer, outBuffer, numInChannels, numOutChannels, bufferSize,
+                      sidechainBuffer, numSidechainChannels );
+    }
+    else {
+        processChunked( inBuffer, outBuffer, numInChannels, numOutChannels, bufferSize,
+                        sidechainBuffer, numSidechainChannels );
+    }
+    levelMeter->end( bufferSize );
+}
+
+template <typename SampleType>
+void ReverbProcess::processChunked( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int numOutChannels,
+                                    int bufferSize, SampleType** sidechainBuffer, int numSidechainChannels ) {
+
+    // the host provided more samples than announced in the processing setup, process in chunks
+    // that fit within the scratch pool (the channel lists are offset for each chunk)
+
+    SampleType* chunkInBuffer [ VST::MAX_CHANNELS ];
+    SampleType* chunkOutBuffer[ VST::MAX_CHANNELS ];
+    SampleType* chunkSidechainBuffer[ VST::MAX_CHANNELS ];
+
+    numInChannels        = std::min( numInChannels,        ( int ) VST::MAX_CHANNELS );
+    numOutChannels       = std::min( numOutChannels,       ( int ) VST::MAX_CHANNELS );
+    numSidechainChannels = std::min( numSidechainChannels, ( int ) VST::MAX_CHANNELS );
+
+    for ( int offset = 0; offset < bufferSize; offset += _maxBufferSize )
+    {
+        for ( int c = 0; c < numInChannels; ++c )
+            chunkInBuffer[ c ] = inBuffer[ c ] + offset;
+
+        for ( int c = 0; c < numOutChannels; ++c )
+            chunkOutBuffer[ c ] = outBuffer[ c ] + offset;
+
+        for ( int c = 0; c < numSidechainChannels && sidechainBuffer != nullptr; ++c )
+            chunkSidechainBuffer[ c ] = sidechainBuffer[ c ] + offset;
+
+        processBlock( chunkInBuffer, chunkOutBuffer, numInChannels, numOutChannels,
+                      std::min( _maxBufferSize, bufferSize - offset ),
+                      sidechainBuffer != nullptr ? chunkSidechainBuffer : nullptr, numSidechainChannels );
+    }
+}
+
+template <typename SampleType>
+void ReverbProcess::processBlock( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int numOutChannels,
+                                  int bufferSize, SampleType** sidechainBuffer, int numSidechainChannels ) {
 
     // input and output buffers can be float or double as defined
     // by the templates SampleType value. Internally we process
     // audio as floats
 
-    SampleType inSample;
-    float frac, s1, s2;
-    int i, t, t2, readIndex, channelDelayBufferChannel;
+    float frac, s0, s1, s2, s3;
+    int i, t, t2;
     bool hasDrift = ( _playbackRate != 1.0f );
-    float orgPlaybackReadIndex = _playbackReadIndex;
 
-    // prepare the mix buffers and clone the incoming buffer contents into the pre-mix buffer
+    profiler->begin();
 
-    prepareMixBuffers( inBuffer, numInChannels, bufferSize );
+    // prepare the mix buffers (cloning the incoming buffer contents into the pre-mix buffer when required)
+    // the scratch pool is sized to hold all buffers of a cycle, should an acquisition fail nonetheless
+    // the input is passed through rather than processing invalid buffers
 
-    for ( int32 c = 0; c < numInChannels; ++c )
-    {
-        SampleType* channelInBuffer  = inBuffer[ c ];
-        SampleType* channelOutBuffer = outBuffer[ c ];
-        float* channelRecordBuffer   = _recordBuffer->getBufferForChannel( c );
-        float* channelPreMixBuffer   = _preMixBuffer->getBufferForChannel( c );
-        float* channelPostMixBuffer  = _postMixBuffer->getBufferForChannel( c );
+    if ( !prepareMixBuffers( inBuffer, outBuffer, numInChannels, bufferSize )) {
+        _scratchPool->reset();
+        passThrough( inBuffer, outBuffer, numInChannels, numOutChannels, bufferSize );
+        levelMeter->measureInput( inBuffer, numInChannels, bufferSize );
+        levelMeter->measureOutput( outBuffer, numOutChannels, bufferSize );
+        profiler->end( bufferSize );
+        return;
+    }
+
+    // lock the phase of tempo synced oscillators to the host position
+
+    if ( _hasPosition ) {
+        filter->lfo->syncPosition( _position );
+        bitCrusher->lfo->syncPosition( _position );
+        _hasPosition = false;
+    }
+
+    // render the oscillator trajectories of the effects once for this buffer
+    // so each channel is processed using the same modulation
+
+    filter->renderLFO( _scratchPool->acquire<float>(), bufferSize );
+    bitCrusher->renderLFO( _scratchPool->acquire<float>(), bufferSize );
+
+    // calculate the decimators sample and hold positions shared by all channels
 
-        orgPlaybackReadIndex = _playbackReadIndex;
+    decimator->prepare( _scratchPool->acquire<int>(), bufferSize );
 
-        // when processing the first channel, store the current effects properties
-        // so each subsequent channel is processed using the same processor variables
+    // when (crossfading towards) bypassed, render the mix of the processed signal
+    // this fades the reverb input and crossfades the dry mix towards unity gain
 
-        if ( c == 0 ) {
-            decimator->store();
-            filter->store();
+    float* bypassMix = nullptr;
+
+    if ( _bypass || _bypassMix < 1.f )
+    {
+        bypassMix = _scratchPool->acquire<float>();
+        float step = _bypass ? -_bypassStep : _bypassStep;
+
+        for ( i = 0; i < bufferSize; ++i ) {
+            _bypassMix = std::min( 1.f, std::max( 0.f, _bypassMix + step ));
+            bypassMix[ i ] = _bypassMix;
         }
+    }
+    // when ducking, render the gain of the wet signal from the sidechain envelope
+
+    float* duckGain = nullptr;
+
+    if ( ducker->isActive() ) {
+        duckGain = _scratchPool->acquire<float>();
+        ducker->render( duckGain, sidechainBuffer, numSidechainChannels, bufferSize );
+    }
+    float tailPeak = 0.f;
+
+    profiler->lap( StageProfiler::MODULATION );
+
+    for ( int c = 0; c < numInChannels; ++c )
+    {
+        SampleType* channelInBuffer  = inBuffer[ c ];
+        SampleType* channelOutBuffer = outBuffer[ c ];
+        float* channelRecordBuffer   = _recordBuffer->getBufferForChannel( c );
+        float* channelPreMixBuffer   = _preMixView.getBufferForChannel( c );
+        float* channelPostMixBuffer  = _postMixView.getBufferForChannel( c );
 
         // PRE MIX processing
 
         if ( !bitCrusherPostMix )
             bitCrusher->process( channelPreMixBuffer, bufferSize );
 
-        decimator->process( channelPreMixBuffer, bufferSize );
+        profiler->lap( StageProfiler::PREMIX_CRUSH );
+
+        decimator->process( channelPreMixBuffer, bufferSize, c );
+
+        profiler->lap( StageProfiler::DECIMATE );
 
         // record the incoming premixed, processed signal into the record buffer (for use with drift mode)
 
@@ -77,9 +200,13 @@ void ReverbProcess::process( SampleType** inBuffer, SampleType** outBuffer, int
         // update last recording index for this channel
         _recordIndices[ c ] = recordIndex;
 
+        profiler->lap( StageProfiler::RECORD );
+
         // REVERB processing applied onto the temp buffer
+        // the input of the reverb is written into the post mix buffer, which is
+        // then processed in place by the comb and allpass filters
 
-        SampleType inputSample, processedSample;
+        SampleType inputSample;
         combFilters* combs        = _combFilters.at( c );
         allpassFilters* allpasses = _allpassFilters.at( c );
 
@@ -92,10 +219,23 @@ void ReverbProcess::process( SampleType** inBuffer, SampleType** outBuffer, int
                 t2   = t + 1;
                 frac = _playbackReadIndex - t;
 
+                // the record buffer is circular, the surrounding samples wrap around its bounds
+
                 s1 = channelRecordBuffer[ t ];
-                s2 = channelRecordBuffer[ t2 < _maxRecordIndex ? t2 : t ];
+                s2 = channelRecordBuffer[ t2 < _maxRecordIndex ? t2 : t2 - _maxRecordIndex ];
+
+                if ( _quality == VST::QUALITY_HIGH ) {
+                    // cubic Hermite interpolation using the surrounding four samples
+                    s0 = channelRecordBuffer[ t > 0 ? t - 1 : _maxRecordIndex - 1 ];
+                    s3 = channelRecordBuffer[ t + 2 < _maxRecordIndex ? t + 2 : t + 2 - _maxRecordIndex ];
 
-                inputSample = s1 + ( s2 - s1 ) * frac;
+                    inputSample = ((( .5f * ( s3 - s0 ) + 1.5f * ( s1 - s2 )) * frac +
+                                  ( s0 - 2.5f * s1 + 2.f * s2 - .5f * s3 )) * frac +
+                                  .5f * ( s2 - s0 )) * frac + s1;
+                }
+                else {
+                    inputSample = s1 + ( s2 - s1 ) * frac;
+                }
 
                 if (( _playbackReadIndex += _playbackRate ) >= _maxRecordIndex ) {
                     _playbackReadIndex = 0.f;
@@ -106,93 +246,175 @@ void ReverbProcess::process( SampleType** inBuffer, SampleType** outBuffer, int
                 inputSample = channelPreMixBuffer[ i ];
             }
 
-            // ---- REVERB process
-
-            processedSample = 0;
             inputSample *= _gain;
 
-            // Accumulate comb filters in parallel
-            for ( int i = 0; i < VST::NUM_COMBS; i++ ) {
-                processedSample += combs->filters.at( i )->process( inputSample );
-            }
+            if ( bypassMix != nullptr )
+                inputSample *= bypassMix[ i ];
 
-            // Feed through allPasses in series
-            for ( int i = 0; i < VST::NUM_ALLPASSES; i++ ) {
-                processedSample = allpasses->filters.at( i )->process( processedSample );
-            }
-
-            // write the reverberated sample into the post mix buffer
-            channelPostMixBuffer[ i ] = processedSample/* * _wet1 + ( input * _dry ) */;
+            channelPostMixBuffer[ i ] = ( float ) inputSample;
         }
 
+        // ---- REVERB process
+        // accumulate comb filters in parallel and feed through allPasses in series
+
+        Kernels::tank( combs->filters.data(), allpasses->filters.data(), channelPostMixBuffer, bufferSize );
+
+        profiler->lap( StageProfiler::TANK );
+
         // POST MIX processing
         // apply the post mix effect processing
 
         filter->process( channelPostMixBuffer, bufferSize, c );
 
+        profiler->lap( StageProfiler::FILTER );
+
         if ( bitCrusherPostMix )
             bitCrusher->process( channelPostMixBuffer, bufferSize );
 
+        profiler->lap( StageProfiler::POSTMIX_CRUSH );
+
         // mix the input and processed post mix buffers into the output buffer
 
-        for ( i = 0; i < bufferSize; ++i ) {
+        // (the input level is measured within the mix pass)
 
-            // before writing to the out buffer we take a snapshot of the current in sample
-            // value as VST2 in Ableton Live supplies the same buffer for in and out!
-            inSample = channelInBuffer[ i ];
+        if ( bypassMix != nullptr ) {
+            // crossfading bypass, the wet signal is the remaining reverb tail
+            float inPeak = 0.f;
+            double inSumOfSquares = 0.0;
 
-            // wet mix (e.g. the effected signal)
-            channelOutBuffer[ i ] = ( SampleType ) channelPostMixBuffer[ i ] * _wet1;
+            for ( i = 0; i < bufferSize; ++i ) {
+                SampleType inSample = channelInBuffer[ i ];
+                float wetSample     = channelPostMixBuffer[ i ] * _wet1;
+                float dryGain       = _dry * bypassMix[ i ] + ( 1.f - bypassMix[ i ] );
 
-            // dry mix (e.g. mix in the input signal)
-            channelOutBuffer[ i ] += ( inSample * _dry );
-        }
+                inPeak          = std::max( inPeak, ( float ) std::abs( inSample ));
+                inSumOfSquares += ( double ) inSample * inSample;
+
+                // the tail is measured prior to ducking (as it resumes once the sidechain signal decays)
+                tailPeak = std::max( tailPeak, std::abs( wetSample ));
 
-        // prepare effects for the next channel
+                if ( duckGain != nullptr )
+                    wetSample *= duckGain[ i ];
 
-        if ( c < ( numInChannels - 1 )) {
-            decimator->restore();
-            filter->restore();
+                channelOutBuffer[ i ] = ( SampleType ) wetSample + inSample * dryGain;
+            }
+            levelMeter->addInput( c, inPeak, inSumOfSquares );
         }
+        else {
+            // note the output can be shared with the input (in place processing, as e.g. VST2 in
+            // Ableton Live supplies the same buffer for in and out) or with the post mix buffer
+            // (when the reverb was rendered directly into the output buffer)
+
+            mixChannel( channelOutBuffer, channelPostMixBuffer, channelInBuffer, duckGain, bufferSize, c );
+        }
+        profiler->lap( StageProfiler::MIX );
+    }
+
+    // once fully bypassed, the processing can be skipped when the tail has faded out
+
+    if ( bypassMix != nullptr && _bypassMix == 0.f && tailPeak < TAIL_SILENCE ) {
+        _tailSilent = true;
+        mute();
     }
 
     // limit the output signal as it can get quite hot
-    limiter->process<SampleType>( outBuffer, bufferSize, numOutChannels );
+    limit( outBuffer, numOutChannels, bufferSize, bypassMix );
+
+    profiler->lap( StageProfiler::LIMITER );
+
+    // all temporary storage can be reused by the next process cycle
+    _scratchPool->reset();
+
+    profiler->end( bufferSize );
+}
+
+template <typename SampleType>
+void ReverbProcess::passThrough( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int numOutChannels,
+                                 int bufferSize )
+{
+    for ( int c = 0; c < numOutChannels; ++c )
+    {
+        if ( c >= numInChannels )
+            memset( outBuffer[ c ], 0, bufferSize * sizeof( SampleType ));
+        else if ( inBuffer[ c ] != outBuffer[ c ] )
+            memcpy( outBuffer[ c ], inBuffer[ c ], bufferSize * sizeof( SampleType ));
+    }
+}
+
+template <typename SampleType>
+void ReverbProcess::limit( SampleType** outBuffer, int numOutChannels, int bufferSize, float* bypassMix )
+{
+    // the output level is measured within the pass writing the final output
+
+    // fully bypassed ? the output remains unaltered (unless delayed for lookahead,
+    // in which case the delay remains in place as the latency must remain constant)
+
+    if ( bypassMix != nullptr && !limiter->getLookahead() &&
+         bypassMix[ 0 ] == 0.f && bypassMix[ bufferSize - 1 ] == 0.f ) {
+        levelMeter->measureOutput( outBuffer, numOutChannels, bufferSize );
+        return;
+    }
+
+    // when crossfading the bypass, the gain reduction is scaled by the processed signal mix
+
+    limiter->process<SampleType>( outBuffer, bufferSize, numOutChannels, levelMeter, bypassMix );
 }
 
 template <typename SampleType>
-void ReverbProcess::prepareMixBuffers( SampleType** inBuffer, int numInChannels, int bufferSize )
+bool ReverbProcess::prepareMixBuffers( SampleType** inBuffer, SampleType** outBuffer, int numInChannels, int bufferSize )
 {
-    // if the pre mix buffer wasn't created yet or the buffer size has changed
-    // delete existing buffer and create new one to match properties
+    float** floatInBuffer  = asFloatBuffers( inBuffer );
+    float** floatOutBuffer = asFloatBuffers( outBuffer );
 
-    if ( _preMixBuffer == nullptr || _preMixBuffer->bufferSize != bufferSize ) {
-        delete _preMixBuffer;
-        _preMixBuffer = new AudioBuffer( numInChannels, bufferSize );
+    // the pre mix effects process in place, when none are active the input can be read directly
+
+    bool hasPreMixEffects = ( !bitCrusherPostMix && bitCrusher->isActive()) || decimator->isActive();
+
+    if ( floatInBuffer != nullptr && !hasPreMixEffects ) {
+        _preMixView = AudioBufferView( floatInBuffer, numInChannels, bufferSize );
     }
+    else {
+        _preMixView = _scratchPool->acquireBuffer( numInChannels, bufferSize );
+
+        if ( _preMixView.amountOfChannels != numInChannels )
+            return false;
 
-    // clone the in buffer contents
-    // note the clone is always cast to float as it is
-    // used for internal processing (see ReverbProcess::process)
+        // clone the in buffer contents
+        // note the clone is always cast to float as it is
+        // used for internal processing (see ReverbProcess::process)
 
-    for ( int c = 0; c < numInChannels; ++c ) {
+        for ( int c = 0; c < numInChannels; ++c ) {
 
-        SampleType* inChannelBuffer = ( SampleType* ) inBuffer[ c ];
-        float* channelPremixBuffer  = ( float* ) _preMixBuffer->getBufferForChannel( c );
+            SampleType* inChannelBuffer = ( SampleType* ) inBuffer[ c ];
+            float* channelPremixBuffer  = _preMixView.getBufferForChannel( c );
 
-        for ( int i = 0; i < bufferSize; ++i ) {
-            // clone into the pre mix buffer for pre-processing
-            channelPremixBuffer[ i ] = ( float ) inChannelBuffer[ i ];
+            for ( int i = 0; i < bufferSize; ++i ) {
+                // clone into the pre mix buffer for pre-processing
+                channelPremixBuffer[ i ] = ( float ) inChannelBuffer[ i ];
+            }
         }
     }
 
-    // if the post mix buffer wasn't created yet or the buffer size has changed
-    // delete existing buffer and create new one to match properties
+    // the reverb can be rendered directly into the output, unless the output shares
+    // its memory with the input (which is still required for the dry mix)
+
+    bool sharesBuffers = false;
 
-    if ( _postMixBuffer == nullptr || _postMixBuffer->bufferSize != bufferSize ) {
-        delete _postMixBuffer;
-        _postMixBuffer = new AudioBuffer( numInChannels, bufferSize );
+    for ( int c = 0; c < numInChannels && !sharesBuffers; ++c ) {
+        for ( int c2 = 0; c2 < numInChannels; ++c2 ) {
+            if ( inBuffer[ c ] == outBuffer[ c2 ] ) {
+                sharesBuffers = true;
+                break;
+            }
+        }
     }
+
+    if ( floatOutBuffer != nullptr && !sharesBuffers )
+        _postMixView = AudioBufferView( floatOutBuffer, numInChannels, bufferSize );
+    else
+        _postMixView = _scratchPool->acquireBuffer( numInChannels, bufferSize );
+
+    return _postMixView.amountOfChannels == numInChannels;
 }
 
 }
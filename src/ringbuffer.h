@@ -0,0 +1,87 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __RINGBUFFER_H_INCLUDED__
+#define __RINGBUFFER_H_INCLUDED__
+
+#include <atomic>
+
+namespace Igorski {
+
+/**
+ * Lock-free single producer / single consumer queue of fixed capacity.
+ * Used to transfer data from the audio thread (producer) to the UI thread
+ * (consumer) without blocking either of them. Values pushed while the
+ * queue is full are dropped.
+ */
+template <typename T, int CAPACITY>
+class RingBuffer {
+
+    public:
+        RingBuffer() : _readIndex( 0 ), _writeIndex( 0 ) {}
+
+        // to be invoked by the producer only, returns false when the queue is full
+
+        bool push( const T& value )
+        {
+            int writeIndex = _writeIndex.load( std::memory_order_relaxed );
+            int nextIndex  = next( writeIndex );
+
+            if ( nextIndex == _readIndex.load( std::memory_order_acquire ))
+                return false;
+
+            _values[ writeIndex ] = value;
+            _writeIndex.store( nextIndex, std::memory_order_release );
+
+            return true;
+        }
+
+        // to be invoked by the consumer only, returns false when the queue is empty
+
+        bool pop( T& value )
+        {
+            int readIndex = _readIndex.load( std::memory_order_relaxed );
+
+            if ( readIndex == _writeIndex.load( std::memory_order_acquire ))
+                return false;
+
+            value = _values[ readIndex ];
+            _readIndex.store( next( readIndex ), std::memory_order_release );
+
+            return true;
+        }
+
+    private:
+        // one slot remains unused to distinguish a full from an empty queue
+        T _values[ CAPACITY + 1 ];
+
+        std::atomic<int> _readIndex;
+        std::atomic<int> _writeIndex;
+
+        inline int next( int index )
+        {
+            return ( index == CAPACITY ) ? 0 : index + 1;
+        }
+};
+}
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "scratchpool.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace Igorski {
+
+/* constructor / destructor */
+
+ScratchPool::ScratchPool( int blockSize, int amountOfBlocks )
+{
+    _blockSize      = blockSize;
+    _amountOfBlocks = amountOfBlocks;
+    _acquiredBlocks = 0;
+
+    // pad each block to a multiple of the alignment (as AudioBuffer does)
+
+    const int samplesPerAlignment = AudioBuffer::ALIGNMENT / sizeof( float );
+    _blockStride = (( blockSize + samplesPerAlignment - 1 ) / samplesPerAlignment ) * samplesPerAlignment;
+
+    size_t size = ( size_t ) _amountOfBlocks * _blockStride * sizeof( float );
+    _memory     = malloc( size + AudioBuffer::ALIGNMENT );
+    _data       = ( float* )((( uintptr_t ) _memory + AudioBuffer::ALIGNMENT - 1 ) & ~(( uintptr_t ) AudioBuffer::ALIGNMENT - 1 ));
+
+    // touch all memory upfront so no page faults occur during processing
+    memset( _data, 0, size );
+}
+
+ScratchPool::~ScratchPool()
+{
+    free( _memory );
+}
+
+/* public methods */
+
+AudioBufferView ScratchPool::acquireBuffer( int amountOfChannels, int bufferSize )
+{
+    if ( bufferSize > _blockSize || amountOfChannels > VST::MAX_CHANNELS )
+        return AudioBufferView();
+
+    float* data = acquireBlocks( amountOfChannels );
+
+    if ( data == nullptr )
+        return AudioBufferView();
+
+    return AudioBufferView( data, _blockStride, amountOfChannels, bufferSize );
+}
+
+void ScratchPool::reset()
+{
+    _acquiredBlocks = 0;
+}
+
+int ScratchPool::getBlockSize()
+{
+    return _blockSize;
+}
+
+int ScratchPool::getAmountOfBlocks()
+{
+    return _amountOfBlocks;
+}
+
+/* private methods */
+
+float* ScratchPool::acquireBlocks( int amount )
+{
+    if ( _acquiredBlocks + amount > _amountOfBlocks )
+        return nullptr;
+
+    float* blocks = _data + (( size_t ) _acquiredBlocks * _blockStride );
+    _acquiredBlocks += amount;
+
+    return blocks;
+}
+
+}
@@ -0,0 +1,78 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __SCRATCHPOOL_H_INCLUDED__
+#define __SCRATCHPOOL_H_INCLUDED__
+
+#include "audiobufferview.h"
+
+namespace Igorski {
+
+/**
+ * A ScratchPool provides temporary storage to the processing stages. It is sized once
+ * (outside of the audio thread) and hands out fixed size blocks from a single aligned
+ * allocation during a process cycle. All blocks are reclaimed at once by reset() at
+ * the end of the cycle, so the same memory is reused (and remains cached) each cycle.
+ * Consecutively acquired blocks are contiguous in memory.
+ */
+class ScratchPool {
+
+    public:
+        // blockSize is the amount of samples each block can hold
+        ScratchPool( int blockSize, int amountOfBlocks );
+        ~ScratchPool();
+
+        // acquire a block of blockSize values (nullptr when all blocks are in use)
+        // values should be no larger than a sample, the contents are undefined
+
+        template <typename T>
+        T* acquire()
+        {
+            static_assert( sizeof( T ) <= sizeof( float ), "ScratchPool values cannot exceed the size of a float" );
+            return reinterpret_cast<T*>( acquireBlocks( 1 ));
+        }
+
+        // acquire a multichannel buffer of given size, each channel occupying a block
+        // returns an empty view (of zero channels) when the blocks are unavailable, the
+        // buffer size exceeds the block size or the channels exceed VST::MAX_CHANNELS
+
+        AudioBufferView acquireBuffer( int amountOfChannels, int bufferSize );
+
+        // reclaims all acquired blocks
+        void reset();
+
+        int getBlockSize();
+        int getAmountOfBlocks();
+
+    private:
+        float* _data;
+        void*  _memory;     // unaligned allocation containing _data
+        int _blockSize;
+        int _blockStride;   // block size padded to the alignment
+        int _amountOfBlocks;
+        int _acquiredBlocks;
+
+        float* acquireBlocks( int amount );
+};
+}
+
+#endif
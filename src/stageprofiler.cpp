@@ -0,0 +1,186 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "stageprofiler.h"
+#include <algorithm>
+
+namespace Igorski {
+
+// out-of-class definition, as the constant is bound to a reference by std::min
+
+const int StageProfiler::Statistics::WINDOW_SIZE;
+
+const char* StageProfiler::STAGE_NAMES[ STAGE_AMOUNT ] = {
+    "modulation", "pre crush", "decimate", "record", "tank", "filter", "post crush", "mix", "limiter"
+};
+
+StageProfiler::StageProfiler() : _enabled( false )
+{
+    _active  = false;
+    _history = nullptr;
+
+    for ( int i = 0; i < STAGE_AMOUNT; ++i )
+        _elapsed[ i ] = Clock::duration::zero();
+}
+
+/* public methods */
+
+void StageProfiler::setEnabled( bool enabled )
+{
+    _enabled.store( enabled, std::memory_order_relaxed );
+}
+
+bool StageProfiler::isEnabled() const
+{
+    return _enabled.load( std::memory_order_relaxed );
+}
+
+void StageProfiler::setHistory( TimingsHistory* history )
+{
+    _history = history;
+}
+
+bool StageProfiler::end( int bufferSize, Timings& timings )
+{
+    if ( !_active )
+        return false;
+
+    _active = false;
+
+    typedef std::chrono::duration<float, std::nano> Nanoseconds;
+
+    float scale = 1.f / std::max( 1, bufferSize );
+
+    timings.bufferSize = bufferSize;
+
+    for ( int i = 0; i < STAGE_AMOUNT; ++i )
+        timings.stages[ i ] = Nanoseconds( _elapsed[ i ] ).count() * scale;
+
+    timings.total = Nanoseconds( Clock::now() - _cycleStart ).count() * scale;
+
+    // a single frame should be processed in less than 1 / sample rate seconds
+
+    timings.load = timings.total * VST::SAMPLE_RATE * 1e-9f;
+
+    if ( _history != nullptr )
+        _history->push( timings );
+
+    return true;
+}
+
+bool StageProfiler::end( int bufferSize )
+{
+    Timings timings;
+    return end( bufferSize, timings );
+}
+
+/* statistics */
+
+StageProfiler::Statistics::Statistics()
+{
+    clear();
+}
+
+void StageProfiler::Statistics::add( const Timings& timings )
+{
+    for ( int i = 0; i < STAGE_AMOUNT; ++i )
+        _stages[ i ][ _writeIndex ] = timings.stages[ i ];
+
+    _totals[ _writeIndex ] = timings.total;
+    _loads [ _writeIndex ] = timings.load;
+
+    _writeIndex = ( _writeIndex + 1 ) % WINDOW_SIZE;
+    _amount     = std::min( _amount + 1, WINDOW_SIZE );
+}
+
+void StageProfiler::Statistics::clear()
+{
+    _writeIndex = 0;
+    _amount     = 0;
+}
+
+int StageProfiler::Statistics::getAmount() const
+{
+    return _amount;
+}
+
+float StageProfiler::Statistics::getMean( Stage stage ) const
+{
+    return getMean( _stages[ stage ] );
+}
+
+float StageProfiler::Statistics::getPercentile( Stage stage, float percentile ) const
+{
+    return getPercentile( _stages[ stage ], percentile );
+}
+
+float StageProfiler::Statistics::getTotalMean() const
+{
+    return getMean( _totals );
+}
+
+float StageProfiler::Statistics::getTotalPercentile( float percentile ) const
+{
+    return getPercentile( _totals, percentile );
+}
+
+float StageProfiler::Statistics::getLoadMean() const
+{
+    return getMean( _loads );
+}
+
+float StageProfiler::Statistics::getLoadPercentile( float percentile ) const
+{
+    return getPercentile( _loads, percentile );
+}
+
+/* private methods */
+
+float StageProfiler::Statistics::getMean( const float* values ) const
+{
+    if ( _amount == 0 )
+        return 0.f;
+
+    double sum = 0.0;
+    for ( int i = 0; i < _amount; ++i )
+        sum += values[ i ];
+
+    return ( float )( sum / _amount );
+}
+
+float StageProfiler::Statistics::getPercentile( const float* values, float percentile ) const
+{
+    if ( _amount == 0 )
+        return 0.f;
+
+    // the window is small, a partial sort of a copy suffices (the consumer is not real-time)
+
+    float sorted[ WINDOW_SIZE ];
+    std::copy( values, values + _amount, sorted );
+
+    int index = std::min( _amount - 1, std::max( 0, ( int )( percentile * _amount )));
+    std::nth_element( sorted, sorted + index, sorted + _amount );
+
+    return sorted[ index ];
+}
+
+}
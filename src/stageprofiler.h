@@ -0,0 +1,166 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __STAGEPROFILER_H_INCLUDED__
+#define __STAGEPROFILER_H_INCLUDED__
+
+#include "global.h"
+#include "ringbuffer.h"
+#include <atomic>
+#include <chrono>
+
+namespace Igorski {
+
+/**
+ * StageProfiler measures the time spent in each stage of ReverbProcess::process(). Profiling
+ * is disabled by default, in which case marking the stages costs a single branch. When enabled,
+ * the duration of each stage is measured using the steady clock (accumulating the time spent
+ * on all channels) and at the end of each process cycle, the timings are pushed into the
+ * history (when set), from which a consumer can collect Statistics.
+ */
+class StageProfiler {
+
+    public:
+        enum Stage {
+            MODULATION = 0, // LFO trajectories, decimator positions, bypass and ducking gain
+            PREMIX_CRUSH,
+            DECIMATE,
+            RECORD,
+            TANK,           // comb and allpass filters (including the drift interpolation)
+            FILTER,
+            POSTMIX_CRUSH,
+            MIX,
+            LIMITER,
+            STAGE_AMOUNT
+        };
+
+        static const char* STAGE_NAMES[ STAGE_AMOUNT ];
+
+        // the timings of a single process cycle
+
+        struct Timings {
+            int bufferSize;
+            float stages[ STAGE_AMOUNT ]; // in nanoseconds per sample frame
+            float total;                  // idem, for the entire cycle
+            float load;                   // the duration of the cycle relative to its real-time duration
+        };
+
+        // lock-free queue transferring the timings to the UI (one entry per process cycle)
+
+        typedef RingBuffer<Timings, 256> TimingsHistory;
+
+        // rolling statistics over the most recent process cycles, to be maintained by the consumer
+
+        class Statistics {
+            public:
+                static const int WINDOW_SIZE = 512;
+
+                Statistics();
+
+                void add( const Timings& timings );
+                void clear();
+
+                int getAmount() const;
+
+                // mean and percentile (e.g. .99) of the nanoseconds per frame spent in given stage
+
+                float getMean( Stage stage ) const;
+                float getPercentile( Stage stage, float percentile ) const;
+
+                // idem, for the entire cycle and its real-time load
+
+                float getTotalMean() const;
+                float getTotalPercentile( float percentile ) const;
+                float getLoadMean() const;
+                float getLoadPercentile( float percentile ) const;
+
+            private:
+                float _stages[ STAGE_AMOUNT ][ WINDOW_SIZE ];
+                float _totals[ WINDOW_SIZE ];
+                float _loads [ WINDOW_SIZE ];
+                int _writeIndex;
+                int _amount;
+
+                float getMean( const float* values ) const;
+                float getPercentile( const float* values, float percentile ) const;
+        };
+
+        StageProfiler();
+
+        // can be invoked from any thread, takes effect at the start of the next process cycle
+
+        void setEnabled( bool enabled );
+        bool isEnabled() const;
+
+        // when set, the timings of each process cycle are pushed into given history
+        // the history is owned by the caller and can be unset by providing a nullptr
+
+        void setHistory( TimingsHistory* history );
+
+        // start measuring a new process cycle
+
+        inline void begin()
+        {
+            _active = _enabled.load( std::memory_order_relaxed );
+
+            if ( !_active )
+                return;
+
+            for ( int i = 0; i < STAGE_AMOUNT; ++i )
+                _elapsed[ i ] = Clock::duration::zero();
+
+            _cycleStart = _lapStart = Clock::now();
+        }
+
+        // attribute the time passed since the previous mark to given stage
+
+        inline void lap( Stage stage )
+        {
+            if ( !_active )
+                return;
+
+            Clock::time_point now = Clock::now();
+            _elapsed[ stage ] += now - _lapStart;
+            _lapStart = now;
+        }
+
+        // finalize the measurement of the cycle (of given length in samples) and publish
+        // the timings into the history. Returns false when profiling is disabled
+
+        bool end( int bufferSize, Timings& timings );
+        bool end( int bufferSize );
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        std::atomic<bool> _enabled;
+        bool _active;
+        TimingsHistory* _history;
+
+        Clock::time_point _cycleStart;
+        Clock::time_point _lapStart;
+        Clock::duration _elapsed[ STAGE_AMOUNT ];
+};
+
+}
+
+#endif
@@ -23,7 +23,12 @@
 #include "../global.h"
 #include "controller.h"
 #include "uimessagecontroller.h"
+#include "gainreductionview.h"
+#include "levelmeterview.h"
+#include "stagetimingsview.h"
 #include "../paramids.h"
+#include "../calc.h"
+#include "../pluginstate.h"
 
 #include "pluginterfaces/base/ibstream.h"
 #include "pluginterfaces/base/ustring.h"
@@ -34,11 +39,25 @@
 #include "vstgui/uidescription/delegationcontroller.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 namespace Steinberg {
 namespace Vst {
 
+// pushes the history entries received from the processor into given history
+
+template <typename T, int CAPACITY>
+static void pushHistoryEntries( Igorski::RingBuffer<T, CAPACITY>* history, const void* data, uint32 size )
+{
+    T entry;
+
+    for ( uint32 offset = 0; offset + sizeof( T ) <= size; offset += sizeof( T )) {
+        memcpy( &entry, static_cast<const char*>( data ) + offset, sizeof( T )); // data might be unaligned
+        history->push( entry );
+    }
+}
+
 //------------------------------------------------------------------------
 // FogPadController Implementation
 //------------------------------------------------------------------------
@@ -53,14 +72,41 @@ tresult PLUGIN_API FogPadController::initialize( FUnknown* context )
     UnitInfo unitInfo;
     Unit* unit;
 
-    // create root only if you want to use the programListId
-    /*	unitInfo.id = kRootUnitId;	// always for Root Unit
-    unitInfo.parentUnitId = kNoParentUnitId;	// always for Root Unit
-    Steinberg::UString (unitInfo.name, USTRINGSIZE (unitInfo.name)).assign (USTRING ("Root"));
-    unitInfo.programListId = kNoProgramListId;
+    // the presets of the preset bank are provided as the program list of the root unit
+
+    presetBank = Igorski::PresetBank::acquire();
+    gainReductionHistory = new ::Limiter::GainReductionHistory();
+    levelsHistory        = new Igorski::LevelMeter::LevelsHistory();
+    stageTimingsHistory  = new Igorski::StageProfiler::TimingsHistory();
+
+    presetAmount = presetBank->getAmount();
+
+    if ( presetAmount > 0 )
+    {
+        unitInfo.id = kRootUnitId;              // always for Root Unit
+        unitInfo.parentUnitId = kNoParentUnitId; // always for Root Unit
+        Steinberg::UString( unitInfo.name, USTRINGSIZE( unitInfo.name )).assign( USTRING( "Root" ));
+        unitInfo.programListId = kProgramId;
+
+        unit = new Unit( unitInfo );
+        addUnit( unit );
+
+        // the program list parameter shares its id with the program list
+
+        ProgramList* programList = new ProgramList( USTRING( "Presets" ), kProgramId, kRootUnitId );
+
+        for ( int32 i = 0; i < presetAmount; ++i )
+        {
+            char name[ Igorski::PresetBank::NAME_LENGTH + 1 ];
+            String128 title;
 
-    unit = new Unit (unitInfo);
-    addUnitInfo (unit);*/
+            presetBank->getName( i, name, sizeof( name ));
+            Steinberg::UString( title, 128 ).fromAscii( name );
+            programList->addProgram( title );
+        }
+        addProgramList( programList );
+        parameters.addParameter( programList->getParameter() );
+    }
 
     // create a unit1
     unitInfo.id = 1;
@@ -140,6 +186,14 @@ tresult PLUGIN_API FogPadController::initialize( FUnknown* context )
         0, ParameterInfo::kCanAutomate, unitId
     ));
 
+    parameters.addParameter( createLFOShapeParameter(
+        USTRING( "Bother LFO shape" ), kLFOBitResolutionShapeId, unitId
+    ));
+
+    parameters.addParameter( createLFOSyncParameter(
+        USTRING( "Bother LFO sync" ), kLFOBitResolutionSyncId, unitId
+    ));
+
     // Filter controls
 
     parameters.addParameter( new RangeParameter(
@@ -166,6 +220,41 @@ tresult PLUGIN_API FogPadController::initialize( FUnknown* context )
         0, ParameterInfo::kCanAutomate, unitId
     ));
 
+    parameters.addParameter( createLFOShapeParameter(
+        USTRING( "Filter LFO shape" ), kLFOFilterShapeId, unitId
+    ));
+
+    parameters.addParameter( createLFOSyncParameter(
+        USTRING( "Filter LFO sync" ), kLFOFilterSyncId, unitId
+    ));
+
+    // Limiter controls
+    // not automatable as toggling lookahead changes the latency of the plugin
+
+    parameters.addParameter(
+        USTRING( "True peak limit" ), 0, 1, 0, ParameterInfo::kNoFlags, kLimiterLookaheadId, unitId
+    );
+
+    // bypass, as provided to the host
+
+    parameters.addParameter(
+        USTRING( "Bypass" ), 0, 1, 0, ParameterInfo::kCanAutomate | ParameterInfo::kIsBypass, kBypassId, unitId
+    );
+
+    // processing quality tier
+
+    parameters.addParameter( createQualityParameter(
+        USTRING( "Quality" ), kQualityId, unitId
+    ));
+
+    // ducking of the wet signal by the sidechain input
+
+    parameters.addParameter( new RangeParameter(
+        USTRING( "Sidechain duck" ), kSidechainDuckId, USTRING( "0 - 1" ),
+        0.f, 1.f, 0.f,
+        0, ParameterInfo::kCanAutomate, unitId
+    ));
+
     // initialization
 
     String str( "FOGPAD" );
@@ -175,112 +264,111 @@ tresult PLUGIN_API FogPadController::initialize( FUnknown* context )
 }
 
 //------------------------------------------------------------------------
-tresult PLUGIN_API FogPadController::terminate()
+Parameter* FogPadController::createLFOShapeParameter( const TChar* title, ParamID tag, int32 unitId )
 {
-    return EditControllerEx1::terminate ();
+    // entries must match the order of Igorski::LFO::Waveform
+
+    StringListParameter* parameter = new StringListParameter(
+        title, tag, nullptr, ParameterInfo::kCanAutomate | ParameterInfo::kIsList, unitId
+    );
+    parameter->appendString( STR16( "Sine" ));
+    parameter->appendString( STR16( "Triangle" ));
+    parameter->appendString( STR16( "Saw" ));
+    parameter->appendString( STR16( "Square" ));
+    parameter->appendString( STR16( "Random" ));
+
+    return parameter;
 }
 
 //------------------------------------------------------------------------
-tresult PLUGIN_API FogPadController::setComponentState( IBStream* state )
+Parameter* FogPadController::createLFOSyncParameter( const TChar* title, ParamID tag, int32 unitId )
 {
-    // we receive the current state of the component (processor part)
-    if ( state )
+    // entries must match the order of Igorski::VST::LFO_SYNC_QUARTER_NOTES
+
+    StringListParameter* parameter = new StringListParameter(
+        title, tag, nullptr, ParameterInfo::kCanAutomate | ParameterInfo::kIsList, unitId
+    );
+    parameter->appendString( STR16( "Free" ));
+
+    const char* noteValues[] = { "1/1", "1/2", "1/4", "1/8", "1/16", "1/32" };
+
+    for ( int32 i = 0; i < 6; ++i )
     {
-        float savedReverbSize = 1.f;
-        if ( state->read( &savedReverbSize, sizeof( float )) != kResultOk )
-            return kResultFalse;
+        char text[32];
+        String128 string;
 
-        float savedReverbWidth = 1.f;
-        if ( state->read( &savedReverbWidth, sizeof( float )) != kResultOk )
-            return kResultFalse;
+        sprintf( text, "%s", noteValues[ i ] );
+        Steinberg::UString( string, 128 ).fromAscii( text );
+        parameter->appendString( string );
 
-        float savedReverbDryMix = 1.f;
-        if ( state->read( &savedReverbDryMix, sizeof( float )) != kResultOk )
-            return kResultFalse;
+        sprintf( text, "%s dotted", noteValues[ i ] );
+        Steinberg::UString( string, 128 ).fromAscii( text );
+        parameter->appendString( string );
 
-        float savedReverbWetMix = 1.f;
-        if ( state->read( &savedReverbWetMix, sizeof( float )) != kResultOk )
-            return kResultFalse;
+        sprintf( text, "%s triplet", noteValues[ i ] );
+        Steinberg::UString( string, 128 ).fromAscii( text );
+        parameter->appendString( string );
+    }
+    return parameter;
+}
 
-        float savedReverbFreeze = 1.f;
-        if ( state->read( &savedReverbFreeze, sizeof( float )) != kResultOk )
-            return kResultFalse;
+//------------------------------------------------------------------------
+Parameter* FogPadController::createQualityParameter( const TChar* title, ParamID tag, int32 unitId )
+{
+    // entries must match the order resolved by FogPad::getQuality()
 
-        float savedReverbPlaybackRate = 1.f;
-        if ( state->read( &savedReverbPlaybackRate, sizeof( float )) != kResultOk )
-            return kResultFalse;
+    StringListParameter* parameter = new StringListParameter(
+        title, tag, nullptr, ParameterInfo::kCanAutomate | ParameterInfo::kIsList, unitId
+    );
+    parameter->appendString( STR16( "Auto" ));
+    parameter->appendString( STR16( "Eco" ));
+    parameter->appendString( STR16( "High" ));
 
-        float savedBitResolution = 1.f;
-        if ( state->read( &savedBitResolution, sizeof( float )) != kResultOk )
-            return kResultFalse;
+    return parameter;
+}
 
-        float savedBitResolutionChain = 0.f;
-        if ( state->read( &savedBitResolutionChain, sizeof( float )) != kResultOk )
-            return kResultFalse;
+//------------------------------------------------------------------------
+tresult PLUGIN_API FogPadController::terminate()
+{
+    Igorski::PresetBank::release( presetBank );
+    presetBank = nullptr;
 
-        float savedLFOBitResolution = Igorski::VST::MIN_LFO_RATE();
-        if ( state->read( &savedLFOBitResolution, sizeof( float )) != kResultOk )
-            return kResultFalse;
+    delete gainReductionHistory;
+    delete levelsHistory;
+    delete stageTimingsHistory;
+    gainReductionHistory = nullptr;
+    levelsHistory        = nullptr;
+    stageTimingsHistory  = nullptr;
 
-        float savedLFOBitResolutionDepth = 1.f;
-        if ( state->read( &savedLFOBitResolutionDepth, sizeof( float )) != kResultOk )
-            return kResultFalse;
+    return EditControllerEx1::terminate ();
+}
 
-        float savedDecimator = 1.f;
-        if ( state->read( &savedDecimator, sizeof( float )) != kResultOk )
-            return kResultFalse;
+//------------------------------------------------------------------------
+tresult PLUGIN_API FogPadController::setComponentState( IBStream* state )
+{
+    // we receive the current state of the component (processor part)
+    // which is parsed using the same PluginState parser as the processor
 
-        float savedFilterCutoff = Igorski::VST::FILTER_MAX_FREQ;
-        if ( state->read( &savedFilterCutoff, sizeof( float )) != kResultOk )
-            return kResultFalse;
+    if ( state )
+    {
+        char data[ Igorski::PluginState::MAX_SIZE ];
+        int32 size = 0;
+        state->read( data, Igorski::PluginState::MAX_SIZE, &size );
 
-        float savedFilterResonance = Igorski::VST::FILTER_MAX_RESONANCE;
-        if ( state->read( &savedFilterResonance, sizeof( float )) != kResultOk )
+        Igorski::PluginState pluginState;
+        if ( size <= 0 || !pluginState.read( data, ( size_t ) size ))
             return kResultFalse;
 
-        float savedLFOFilter = Igorski::VST::MIN_LFO_RATE();
-        if ( state->read( &savedLFOFilter, sizeof( float )) != kResultOk )
-            return kResultFalse;
+        // parameters absent in the state retain their current value
 
-        float savedLFOFilterDepth = 1.f;
-        if ( state->read( &savedLFOFilterDepth, sizeof( float )) != kResultOk )
-            return kResultFalse;
+        for ( int32 i = 0; i < Igorski::PluginState::PARAMETER_AMOUNT; ++i )
+        {
+            ParamID id = Igorski::PluginState::PARAMETER_IDS[ i ];
+            float value;
 
-#if BYTEORDER == kBigEndian
-    SWAP32( savedReverbSize )
-    SWAP32( savedReverbWidth )
-    SWAP32( savedReverbDryMix )
-    SWAP32( savedReverbWetMix )
-    SWAP32( savedReverbFreeze )
-    SWAP32( savedReverbPlaybackRate )
-    SWAP32( savedBitResolution )
-    SWAP32( savedBitResolutionChain )
-    SWAP32( savedLFOBitResolution )
-    SWAP32( savedLFOBitResolutionDepth )
-    SWAP32( savedDecimator )
-    SWAP32( savedFilterCutoff )
-    SWAP32( savedFilterResonance )
-    SWAP32( savedLFOFilter )
-    SWAP32( savedLFOFilterDepth )
-#endif
-
-        setParamNormalized( kReverbSizeId,              savedReverbSize );
-        setParamNormalized( kReverbWidthId,             savedReverbWidth );
-        setParamNormalized( kReverbDryMixId,            savedReverbDryMix );
-        setParamNormalized( kReverbWetMixId,            savedReverbWetMix );
-        setParamNormalized( kReverbFreezeId,            savedReverbFreeze );
-        setParamNormalized( kReverbPlaybackRateId,      savedReverbPlaybackRate );
-        setParamNormalized( kBitResolutionId,           savedBitResolution );
-        setParamNormalized( kBitResolutionChainId,      savedBitResolutionChain );
-        setParamNormalized( kLFOBitResolutionId,        savedLFOBitResolution );
-        setParamNormalized( kLFOBitResolutionDepthId,   savedLFOBitResolutionDepth );
-        setParamNormalized( kDecimatorId,               savedDecimator );
-        setParamNormalized( kFilterCutoffId,            savedFilterCutoff );
-        setParamNormalized( kFilterResonanceId,         savedFilterResonance );
-        setParamNormalized( kLFOFilterId,               savedLFOFilter );
-        setParamNormalized( kLFOFilterDepthId,          savedLFOFilterDepth );
-
-        state->seek( sizeof ( float ), IBStream::kIBSeekCur );
+            if ( pluginState.getValue( id, value ))
+                setParamNormalized( id, value );
+        }
     }
     return kResultOk;
 }
@@ -311,6 +399,44 @@ IController* FogPadController::createSubController( UTF8StringPtr name,
     return nullptr;
 }
 
+//------------------------------------------------------------------------
+CView* FogPadController::createCustomView( UTF8StringPtr name,
+                                           const UIAttributes& attributes,
+                                           const IUIDescription* /*description*/,
+                                           VST3Editor* /*editor*/ )
+{
+    if ( UTF8StringView( name ) == "GainReductionView" )
+    {
+        CPoint origin;
+        CPoint size;
+        attributes.getPointAttribute( "origin", origin );
+        attributes.getPointAttribute( "size",   size );
+
+        return new GainReductionView( CRect( origin, size ), this );
+    }
+
+    if ( UTF8StringView( name ) == "LevelMeterView" )
+    {
+        CPoint origin;
+        CPoint size;
+        attributes.getPointAttribute( "origin", origin );
+        attributes.getPointAttribute( "size",   size );
+
+        return new LevelMeterView( CRect( origin, size ), this );
+    }
+
+    if ( UTF8StringView( name ) == "StageTimingsView" )
+    {
+        CPoint origin;
+        CPoint size;
+        attributes.getPointAttribute( "origin", origin );
+        attributes.getPointAttribute( "size",   size );
+
+        return new StageTimingsView( CRect( origin, size ), this );
+    }
+    return nullptr;
+}
+
 //------------------------------------------------------------------------
 tresult PLUGIN_API FogPadController::setState( IBStream* state )
 {
@@ -364,14 +490,124 @@ tresult FogPadController::receiveText( const char* text )
     return kResultOk;
 }
 
+//------------------------------------------------------------------------
+tresult PLUGIN_API FogPadController::notify( IMessage* message )
+{
+    if ( !message )
+        return kInvalidArgument;
+
+    // received periodically from Component, holding the entries recorded since the previous message
+
+    if ( !strcmp( message->getMessageID(), "GainReductionHistory" ))
+    {
+        const void* data;
+        uint32 size;
+        if ( message->getAttributes()->getBinary( "entries", data, size ) == kResultOk )
+        {
+            pushHistoryEntries( gainReductionHistory, data, size );
+            return kResultOk;
+        }
+    }
+
+    if ( !strcmp( message->getMessageID(), "LevelsHistory" ))
+    {
+        const void* data;
+        uint32 size;
+        if ( message->getAttributes()->getBinary( "entries", data, size ) == kResultOk )
+        {
+            pushHistoryEntries( levelsHistory, data, size );
+            return kResultOk;
+        }
+    }
+
+    if ( !strcmp( message->getMessageID(), "StageTimingsHistory" ))
+    {
+        const void* data;
+        uint32 size;
+        if ( message->getAttributes()->getBinary( "entries", data, size ) == kResultOk )
+        {
+            pushHistoryEntries( stageTimingsHistory, data, size );
+            return kResultOk;
+        }
+    }
+    return EditControllerEx1::notify( message );
+}
+
+//------------------------------------------------------------------------
+::Limiter::GainReductionHistory* FogPadController::getGainReductionHistory()
+{
+    return gainReductionHistory;
+}
+
+//------------------------------------------------------------------------
+Igorski::LevelMeter::LevelsHistory* FogPadController::getLevelsHistory()
+{
+    return levelsHistory;
+}
+
+//------------------------------------------------------------------------
+Igorski::StageProfiler::TimingsHistory* FogPadController::getStageTimingsHistory()
+{
+    return stageTimingsHistory;
+}
+
+//------------------------------------------------------------------------
+void FogPadController::setStageProfiling( bool enabled )
+{
+    if ( IPtr<IMessage> message = owned( allocateMessage()))
+    {
+        message->setMessageID( "StageProfiling" );
+        message->getAttributes()->setInt( "enabled", enabled ? 1 : 0 );
+        sendMessage( message );
+    }
+}
+
 //------------------------------------------------------------------------
 tresult PLUGIN_API FogPadController::setParamNormalized( ParamID tag, ParamValue value )
 {
     // called from host to update our parameters state
+    bool latencyChanged = ( tag == kLimiterLookaheadId ) && ( getParamNormalized( tag ) != value );
+
+    bool programChanged = ( tag == kProgramId ) && ( getParamNormalized( tag ) != value );
+
     tresult result = EditControllerEx1::setParamNormalized( tag, value );
+
+    // selecting a program applies its preset (the processor does the same upon
+    // receiving the program change)
+
+    if ( programChanged )
+        loadPreset( value );
+
+    // toggling the lookahead limiter changes the latency of the processor
+
+    if ( latencyChanged && componentHandler )
+        componentHandler->restartComponent( kLatencyChanged );
+
     return result;
 }
 
+//------------------------------------------------------------------------
+void FogPadController::loadPreset( ParamValue value )
+{
+    if ( presetBank == nullptr || presetAmount == 0 )
+        return;
+
+    int32 index = Igorski::Calc::toIndex(( float ) value, presetAmount );
+    Igorski::PluginState pluginState;
+
+    if ( !presetBank->getPreset( index, pluginState ))
+        return;
+
+    for ( int32 i = 0; i < Igorski::PluginState::PARAMETER_AMOUNT; ++i )
+    {
+        ParamID id = Igorski::PluginState::PARAMETER_IDS[ i ];
+        float presetValue;
+
+        if ( id != kBypassId && pluginState.getValue( id, presetValue ))
+            setParamNormalized( id, presetValue );
+    }
+}
+
 //------------------------------------------------------------------------
 tresult PLUGIN_API FogPadController::getParamStringByValue( ParamID tag, ParamValue valueNormalized, String128 string )
 {
@@ -391,10 +627,13 @@ tresult PLUGIN_API FogPadController::getParamStringByValue( ParamID tag, ParamVa
         case kLFOBitResolutionDepthId:
         case kDecimatorId:
         case kLFOFilterDepthId:
+        case kLimiterLookaheadId:
+        case kBypassId:
+        case kSidechainDuckId:
         {
             char text[32];
 
-            if (( tag == kReverbFreezeId )) {
+            if (( tag == kReverbFreezeId ) || ( tag == kLimiterLookaheadId ) || ( tag == kBypassId )) {
                 sprintf( text, "%s", ( valueNormalized == 0 ) ? "Off" : "On" );
             }
             else if ( tag == kBitResolutionChainId ) {
@@ -25,6 +25,10 @@
 
 #include "vstgui/plugin-bindings/vst3editor.h"
 #include "public.sdk/source/vst/vsteditcontroller.h"
+#include "../limiter.h"
+#include "../presetbank.h"
+#include "../levelmeter.h"
+#include "../stageprofiler.h"
 
 #include <vector>
 
@@ -67,6 +71,7 @@ class FogPadController : public EditControllerEx1, public IMidiMapping, public V
 
         //---from ComponentBase-----
         tresult receiveText( const char* text ) SMTG_OVERRIDE;
+        tresult PLUGIN_API notify( IMessage* message ) SMTG_OVERRIDE;
 
         //---from IMidiMapping-----------------
         tresult PLUGIN_API getMidiControllerAssignment (int32 busIndex, int16 channel,
@@ -76,6 +81,8 @@ class FogPadController : public EditControllerEx1, public IMidiMapping, public V
         //---from VST3EditorDelegate-----------
         IController* createSubController( UTF8StringPtr name, const IUIDescription* description,
                                           VST3Editor* editor ) SMTG_OVERRIDE;
+        CView* createCustomView( UTF8StringPtr name, const UIAttributes& attributes,
+                                 const IUIDescription* description, VST3Editor* editor ) SMTG_OVERRIDE;
 
         DELEGATE_REFCOUNT ( EditController )
         tresult PLUGIN_API queryInterface( const char* iid, void** obj ) SMTG_OVERRIDE;
@@ -87,11 +94,46 @@ class FogPadController : public EditControllerEx1, public IMidiMapping, public V
         void setDefaultMessageText( String128 text );
         TChar* getDefaultMessageText();
 
+        // the gain reduction history, filled with the entries sent by the processor
+        ::Limiter::GainReductionHistory* getGainReductionHistory();
+
+        // the input and output levels, filled with the entries sent by the processor
+        Igorski::LevelMeter::LevelsHistory* getLevelsHistory();
+
+        // the per-stage timings, filled with the entries sent by the processor
+        Igorski::StageProfiler::TimingsHistory* getStageTimingsHistory();
+
+        // requests the processor to (stop to) measure the per-stage timings
+        void setStageProfiling( bool enabled );
+
     private:
+        // creates a list parameter to select an LFO waveform
+        Parameter* createLFOShapeParameter( const TChar* title, ParamID tag, int32 unitId );
+
+        // creates a list parameter to synchronize an LFO to the host tempo
+        Parameter* createLFOSyncParameter( const TChar* title, ParamID tag, int32 unitId );
+
+        // creates a list parameter to select the processing quality tier
+        Parameter* createQualityParameter( const TChar* title, ParamID tag, int32 unitId );
+
+        // applies the values of the preset selected by given normalized program
+        // change value onto the parameters (except for the bypass state)
+        void loadPreset( ParamValue value );
+
         typedef std::vector<UIMessageController*> UIMessageControllerList;
         UIMessageControllerList uiMessageControllers;
 
         String128 defaultMessageText;
+
+        ::Limiter::GainReductionHistory* gainReductionHistory = nullptr;
+        Igorski::LevelMeter::LevelsHistory* levelsHistory = nullptr;
+        Igorski::StageProfiler::TimingsHistory* stageTimingsHistory = nullptr;
+
+        // the preset bank shared by all instances, exposed as program list. The amount of
+        // programs is that of the bank when acquired (as the processor indexes its presets
+        // likewise), a user bank written afterwards does not alter the list
+        Igorski::PresetBank* presetBank = nullptr;
+        int32 presetAmount = 0;
 };
 
 //------------------------------------------------------------------------
@@ -0,0 +1,147 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "gainreductionview.h"
+#include "controller.h"
+
+#include <math.h>
+
+namespace Steinberg {
+namespace Vst {
+
+using namespace VSTGUI;
+
+constexpr float GainReductionView::RANGE_DB;
+
+//------------------------------------------------------------------------
+// GainReductionView Implementation
+//------------------------------------------------------------------------
+GainReductionView::GainReductionView( const CRect& size, FogPadController* controller )
+: CView( size )
+, controller( controller )
+, columnIndex( 0 )
+{
+    ::Limiter::GainReduction noReduction;
+    noReduction.minimum = 1.f;
+    noReduction.maximum = 1.f;
+
+    columns.resize( std::max( 1, ( int32 ) size.getWidth()), noReduction );
+}
+
+//------------------------------------------------------------------------
+bool GainReductionView::attached( CView* parent )
+{
+    if ( !CView::attached( parent ))
+        return false;
+
+    timer = owned( new CVSTGUITimer( [ this ]( CVSTGUITimer* ) { poll(); }, REFRESH_RATE_MS, true ));
+
+    return true;
+}
+
+//------------------------------------------------------------------------
+bool GainReductionView::removed( CView* parent )
+{
+    if ( timer ) {
+        timer->stop();
+        timer = nullptr;
+    }
+    return CView::removed( parent );
+}
+
+//------------------------------------------------------------------------
+void GainReductionView::poll()
+{
+    ::Limiter::GainReductionHistory* history = controller->getGainReductionHistory();
+
+    if ( history == nullptr )
+        return;
+
+    // combine all chunks recorded since the last poll into a single column
+    // the history does not move while the processor is idle
+
+    ::Limiter::GainReduction reduction;
+    ::Limiter::GainReduction column;
+    bool hasData = false;
+
+    while ( history->pop( reduction ))
+    {
+        if ( !hasData ) {
+            column  = reduction;
+            hasData = true;
+        }
+        else {
+            column.minimum = std::min( column.minimum, reduction.minimum );
+            column.maximum = std::max( column.maximum, reduction.maximum );
+        }
+    }
+
+    if ( !hasData )
+        return;
+
+    columns[ columnIndex ] = column;
+
+    if ( ++columnIndex == ( int32 ) columns.size())
+        columnIndex = 0;
+
+    invalid();
+}
+
+//------------------------------------------------------------------------
+void GainReductionView::draw( CDrawContext* context )
+{
+    const CRect& rect = getViewSize();
+
+    context->setFillColor( kBlackCColor );
+    context->drawRect( rect, kDrawFilled );
+
+    context->setFrameColor( CColor( 0x85, 0xba, 0xd7, 0xff ));
+    context->setLineWidth( 1 );
+
+    // oldest column on the left, most recent column on the right
+
+    int32 amountOfColumns = ( int32 ) columns.size();
+
+    for ( int32 i = 0; i < amountOfColumns; ++i )
+    {
+        const ::Limiter::GainReduction& column = columns[ ( columnIndex + i ) % amountOfColumns ];
+
+        CCoord x = rect.left + i + 0.5;
+        context->drawLine( CPoint( x, getY( column.maximum, rect )), CPoint( x, getY( column.minimum, rect ) + 1 ));
+    }
+    setDirty( false );
+}
+
+//------------------------------------------------------------------------
+CCoord GainReductionView::getY( float linearGain, const CRect& rect )
+{
+    // no reduction at the top, RANGE_DB of reduction (or more) at the bottom
+
+    float reductionDb = ( linearGain > 0.f ) ? -20.f * log10f( linearGain ) : RANGE_DB;
+    float position    = std::min( 1.f, std::max( 0.f, reductionDb / RANGE_DB ));
+
+    return rect.top + position * ( rect.getHeight() - 1 );
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,72 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __GAINREDUCTIONVIEW_HEADER__
+#define __GAINREDUCTIONVIEW_HEADER__
+
+#include "vstgui/vstgui.h"
+#include "../limiter.h"
+
+#include <vector>
+
+namespace Steinberg {
+namespace Vst {
+
+class FogPadController;
+
+//------------------------------------------------------------------------
+// GainReductionView
+// draws the recent gain reduction history of the limiter, where each column
+// shows the range of the gain reduction applied in between two refreshes
+//------------------------------------------------------------------------
+class GainReductionView : public VSTGUI::CView
+{
+    public:
+        GainReductionView( const VSTGUI::CRect& size, FogPadController* controller );
+
+        void draw( VSTGUI::CDrawContext* context ) override;
+
+        bool attached( VSTGUI::CView* parent ) override;
+        bool removed( VSTGUI::CView* parent ) override;
+
+    private:
+        static const uint32 REFRESH_RATE_MS = 33;
+        static constexpr float RANGE_DB     = 24.f; // the gain reduction at the bottom of the view
+
+        FogPadController* controller;
+        VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> timer;
+
+        std::vector<::Limiter::GainReduction> columns; // circular, one entry per horizontal pixel
+        int32 columnIndex;                             // index of the next column to write
+
+        // reads the recorded gain reduction since the last invocation into the next column
+        void poll();
+
+        // translates given linear gain to its vertical position within the view
+        VSTGUI::CCoord getY( float linearGain, const VSTGUI::CRect& rect );
+};
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
+
+#endif
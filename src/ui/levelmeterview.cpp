@@ -0,0 +1,172 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "levelmeterview.h"
+#include "controller.h"
+
+#include <math.h>
+
+namespace Steinberg {
+namespace Vst {
+
+using namespace VSTGUI;
+
+constexpr float LevelMeterView::RANGE_DB;
+constexpr float LevelMeterView::RELEASE;
+
+//------------------------------------------------------------------------
+// LevelMeterView Implementation
+//------------------------------------------------------------------------
+LevelMeterView::LevelMeterView( const CRect& size, FogPadController* controller )
+: CView( size )
+, controller( controller )
+{
+    levels.amountOfInputChannels  = 0;
+    levels.amountOfOutputChannels = 0;
+
+    for ( int32 c = 0; c < Igorski::VST::MAX_CHANNELS; ++c ) {
+        levels.inputPeak [ c ] = 0.f;
+        levels.inputRMS  [ c ] = 0.f;
+        levels.outputPeak[ c ] = 0.f;
+        levels.outputRMS [ c ] = 0.f;
+    }
+}
+
+//------------------------------------------------------------------------
+bool LevelMeterView::attached( CView* parent )
+{
+    if ( !CView::attached( parent ))
+        return false;
+
+    timer = owned( new CVSTGUITimer( [ this ]( CVSTGUITimer* ) { poll(); }, REFRESH_RATE_MS, true ));
+
+    return true;
+}
+
+//------------------------------------------------------------------------
+bool LevelMeterView::removed( CView* parent )
+{
+    if ( timer ) {
+        timer->stop();
+        timer = nullptr;
+    }
+    return CView::removed( parent );
+}
+
+//------------------------------------------------------------------------
+void LevelMeterView::poll()
+{
+    Igorski::LevelMeter::LevelsHistory* history = controller->getLevelsHistory();
+
+    if ( history == nullptr )
+        return;
+
+    // let the displayed levels decay, after which the levels received since the last
+    // poll are combined (the history does not move while the processor is idle)
+
+    for ( int32 c = 0; c < Igorski::VST::MAX_CHANNELS; ++c ) {
+        levels.inputPeak [ c ] *= RELEASE;
+        levels.inputRMS  [ c ] *= RELEASE;
+        levels.outputPeak[ c ] *= RELEASE;
+        levels.outputRMS [ c ] *= RELEASE;
+    }
+
+    Igorski::LevelMeter::Levels received;
+
+    while ( history->pop( received ))
+    {
+        levels.amountOfInputChannels  = received.amountOfInputChannels;
+        levels.amountOfOutputChannels = received.amountOfOutputChannels;
+
+        for ( int32 c = 0; c < Igorski::VST::MAX_CHANNELS; ++c ) {
+            levels.inputPeak [ c ] = std::max( levels.inputPeak [ c ], received.inputPeak [ c ] );
+            levels.inputRMS  [ c ] = std::max( levels.inputRMS  [ c ], received.inputRMS  [ c ] );
+            levels.outputPeak[ c ] = std::max( levels.outputPeak[ c ], received.outputPeak[ c ] );
+            levels.outputRMS [ c ] = std::max( levels.outputRMS [ c ], received.outputRMS [ c ] );
+        }
+    }
+    invalid();
+}
+
+//------------------------------------------------------------------------
+void LevelMeterView::draw( CDrawContext* context )
+{
+    const CRect& rect = getViewSize();
+
+    context->setFillColor( kBlackCColor );
+    context->drawRect( rect, kDrawFilled );
+
+    // the inputs occupy the top half, the outputs the bottom half of the view
+
+    CCoord halfHeight = rect.getHeight() / 2;
+
+    int32 amountOfInputs  = std::max( 1, levels.amountOfInputChannels );
+    int32 amountOfOutputs = std::max( 1, levels.amountOfOutputChannels );
+
+    for ( int32 c = 0; c < levels.amountOfInputChannels; ++c )
+    {
+        CCoord height = halfHeight / amountOfInputs;
+        CRect meter( rect.left, rect.top + c * height, rect.right, rect.top + ( c + 1 ) * height - 1 );
+        drawMeter( context, meter, levels.inputPeak[ c ], levels.inputRMS[ c ] );
+    }
+
+    for ( int32 c = 0; c < levels.amountOfOutputChannels; ++c )
+    {
+        CCoord height = halfHeight / amountOfOutputs;
+        CRect meter( rect.left, rect.top + halfHeight + c * height, rect.right, rect.top + halfHeight + ( c + 1 ) * height - 1 );
+        drawMeter( context, meter, levels.outputPeak[ c ], levels.outputRMS[ c ] );
+    }
+    setDirty( false );
+}
+
+//------------------------------------------------------------------------
+void LevelMeterView::drawMeter( CDrawContext* context, const CRect& rect, float peak, float rms )
+{
+    CRect bar( rect );
+    bar.right = getX( rms, rect );
+
+    context->setFillColor( CColor( 0x85, 0xba, 0xd7, 0xff ));
+    context->drawRect( bar, kDrawFilled );
+
+    // peaks exceeding full scale are drawn in red
+
+    CCoord x = getX( peak, rect );
+
+    context->setFrameColor( peak > 1.f ? kRedCColor : kWhiteCColor );
+    context->setLineWidth( 1 );
+    context->drawLine( CPoint( x, rect.top ), CPoint( x, rect.bottom ));
+}
+
+//------------------------------------------------------------------------
+CCoord LevelMeterView::getX( float level, const CRect& rect )
+{
+    // -RANGE_DB (or less) at the left, 0 dBFS at the right
+
+    float levelDb  = ( level > 0.f ) ? 20.f * log10f( level ) : -RANGE_DB;
+    float position = std::min( 1.f, std::max( 0.f, 1.f + levelDb / RANGE_DB ));
+
+    return rect.left + position * ( rect.getWidth() - 1 );
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,76 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __LEVELMETERVIEW_HEADER__
+#define __LEVELMETERVIEW_HEADER__
+
+#include "vstgui/vstgui.h"
+#include "../levelmeter.h"
+
+namespace Steinberg {
+namespace Vst {
+
+class FogPadController;
+
+//------------------------------------------------------------------------
+// LevelMeterView
+// draws a horizontal meter for each input (top half) and output (bottom half)
+// channel, where the bar shows the RMS level and the marker the peak level
+//------------------------------------------------------------------------
+class LevelMeterView : public VSTGUI::CView
+{
+    public:
+        LevelMeterView( const VSTGUI::CRect& size, FogPadController* controller );
+
+        void draw( VSTGUI::CDrawContext* context ) override;
+
+        bool attached( VSTGUI::CView* parent ) override;
+        bool removed( VSTGUI::CView* parent ) override;
+
+    private:
+        static const uint32 REFRESH_RATE_MS = 33;
+        static constexpr float RANGE_DB     = 60.f;  // the level at the left of the view
+        static constexpr float RELEASE      = .85f;  // decay of the displayed levels per refresh
+
+        FogPadController* controller;
+        VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> timer;
+
+        // the displayed levels (the maximum of the levels received since the last refresh,
+        // decaying while the levels drop)
+
+        Igorski::LevelMeter::Levels levels;
+
+        // reads the levels measured since the last invocation
+        void poll();
+
+        // draws a single meter with given levels into given rectangle
+        void drawMeter( VSTGUI::CDrawContext* context, const VSTGUI::CRect& rect, float peak, float rms );
+
+        // translates given linear level to its horizontal position within given rectangle
+        VSTGUI::CCoord getX( float level, const VSTGUI::CRect& rect );
+};
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "stagetimingsview.h"
+#include "controller.h"
+
+#include <stdio.h>
+
+namespace Steinberg {
+namespace Vst {
+
+using namespace VSTGUI;
+using Igorski::StageProfiler;
+
+//------------------------------------------------------------------------
+// StageTimingsView Implementation
+//------------------------------------------------------------------------
+StageTimingsView::StageTimingsView( const CRect& size, FogPadController* controller )
+: CView( size )
+, controller( controller )
+, active( false )
+{
+    // while hidden, the background of the editor remains visible
+    setTransparency( true );
+}
+
+//------------------------------------------------------------------------
+CMouseEventResult StageTimingsView::onMouseDown( CPoint& /*where*/, const CButtonState& buttons )
+{
+    if ( !buttons.isLeftButton() || buttons.getModifierState() != ( kShift | kAlt ))
+        return kMouseEventNotHandled;
+
+    setActive( !active );
+
+    return kMouseEventHandled;
+}
+
+//------------------------------------------------------------------------
+bool StageTimingsView::removed( CView* parent )
+{
+    setActive( false );
+
+    return CView::removed( parent );
+}
+
+//------------------------------------------------------------------------
+void StageTimingsView::setActive( bool value )
+{
+    if ( active == value )
+        return;
+
+    active = value;
+    controller->setStageProfiling( active );
+    statistics.clear();
+
+    if ( active ) {
+        timer = owned( new CVSTGUITimer( [ this ]( CVSTGUITimer* ) { poll(); }, REFRESH_RATE_MS, true ));
+    }
+    else if ( timer ) {
+        timer->stop();
+        timer = nullptr;
+    }
+    invalid();
+}
+
+//------------------------------------------------------------------------
+void StageTimingsView::poll()
+{
+    StageProfiler::TimingsHistory* history = controller->getStageTimingsHistory();
+
+    if ( history == nullptr )
+        return;
+
+    StageProfiler::Timings timings;
+
+    while ( history->pop( timings ))
+        statistics.add( timings );
+
+    invalid();
+}
+
+//------------------------------------------------------------------------
+void StageTimingsView::draw( CDrawContext* context )
+{
+    if ( !active ) {
+        setDirty( false );
+        return;
+    }
+    const CRect& rect = getViewSize();
+
+    context->setFillColor( kBlackCColor );
+    context->drawRect( rect, kDrawFilled );
+    context->setFont( kNormalFontVerySmall );
+    context->setFontColor( kWhiteCColor );
+
+    // the stages are listed in two columns (in nanoseconds per sample frame), followed by
+    // the total and the real-time load (the share of the available time spent processing)
+
+    const int32 rowsPerColumn = ( StageProfiler::STAGE_AMOUNT + 1 ) / 2;
+    const CCoord rowHeight    = rect.getHeight() / ( rowsPerColumn + 2 );
+    const CCoord columnWidth  = rect.getWidth() / 2;
+
+    char text[ 64 ];
+
+    for ( int32 column = 0; column < 2; ++column ) {
+        CRect row( rect.left + 4 + column * columnWidth, rect.top, rect.left + ( column + 1 ) * columnWidth, rect.top + rowHeight );
+        context->drawString( "stage        mean ns   p99 ns", row, kLeftText );
+    }
+
+    for ( int32 i = 0; i < StageProfiler::STAGE_AMOUNT; ++i )
+    {
+        StageProfiler::Stage stage = ( StageProfiler::Stage ) i;
+        int32 column = i / rowsPerColumn;
+        CCoord top   = rect.top + ( 1 + i % rowsPerColumn ) * rowHeight;
+        CRect row( rect.left + 4 + column * columnWidth, top, rect.left + ( column + 1 ) * columnWidth, top + rowHeight );
+
+        snprintf( text, sizeof( text ), "%-12s %7.2f  %7.2f", StageProfiler::STAGE_NAMES[ i ],
+                  statistics.getMean( stage ), statistics.getPercentile( stage, .99f ));
+        context->drawString( text, row, kLeftText );
+    }
+
+    CCoord top = rect.top + ( rowsPerColumn + 1 ) * rowHeight;
+    CRect row( rect.left + 4, top, rect.right, top + rowHeight );
+
+    snprintf( text, sizeof( text ), "total %.2f ns (p99 %.2f), load %.1f %% (p99 %.1f %%), %d cycles",
+              statistics.getTotalMean(), statistics.getTotalPercentile( .99f ),
+              statistics.getLoadMean() * 100.f, statistics.getLoadPercentile( .99f ) * 100.f,
+              statistics.getAmount() );
+    context->drawString( text, row, kLeftText );
+
+    setDirty( false );
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,71 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __STAGETIMINGSVIEW_HEADER__
+#define __STAGETIMINGSVIEW_HEADER__
+
+#include "vstgui/vstgui.h"
+#include "../stageprofiler.h"
+
+namespace Steinberg {
+namespace Vst {
+
+class FogPadController;
+
+//------------------------------------------------------------------------
+// StageTimingsView
+// hidden diagnostics panel listing the mean and 99th percentile of the time
+// spent in each processing stage. Shift + Alt clicking the view toggles its
+// visibility, the processor only measures the timings while it is visible
+//------------------------------------------------------------------------
+class StageTimingsView : public VSTGUI::CView
+{
+    public:
+        StageTimingsView( const VSTGUI::CRect& size, FogPadController* controller );
+
+        void draw( VSTGUI::CDrawContext* context ) override;
+
+        VSTGUI::CMouseEventResult onMouseDown( VSTGUI::CPoint& where, const VSTGUI::CButtonState& buttons ) override;
+
+        bool removed( VSTGUI::CView* parent ) override;
+
+    private:
+        static const uint32 REFRESH_RATE_MS = 250;
+
+        FogPadController* controller;
+        VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> timer;
+
+        Igorski::StageProfiler::Statistics statistics;
+        bool active;
+
+        // shows (enabling the profiling of the processor) or hides the panel
+        void setActive( bool value );
+
+        // reads the timings measured since the last invocation
+        void poll();
+};
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
+
+#endif
@@ -24,6 +24,8 @@
 #include "vst.h"
 #include "paramids.h"
 #include "calc.h"
+#include "pluginstate.h"
+#include "processmodel.h"
 
 #include "public.sdk/source/vst/vstaudioprocessoralgo.h"
 
@@ -37,6 +39,18 @@
 
 namespace Igorski {
 
+// pops the entries recorded in given history (by the audio thread) into given list
+
+template <typename T, int CAPACITY>
+static void drainHistory( RingBuffer<T, CAPACITY>* history, std::vector<T>& entries )
+{
+    T entry;
+    entries.clear();
+
+    while ( entries.size() < ( size_t ) CAPACITY && history->pop( entry ))
+        entries.push_back( entry );
+}
+
 //------------------------------------------------------------------------
 // FogPad Implementation
 //------------------------------------------------------------------------
@@ -56,15 +70,31 @@ FogPad::FogPad()
 , fFilterResonance( 1.f )
 , fLFOFilter( 0.f )
 , fLFOFilterDepth( 0.5f )
+, fLFOFilterShape( 0.f )
+, fLFOBitResolutionShape( 0.f )
+, fLFOFilterSync( 0.f )
+, fLFOBitResolutionSync( 0.f )
+, fLimiterLookahead( 0.f )
+, fBypass( 0.f )
+, fQuality( 0.f )
+, fSidechainDuck( 0.f )
 , reverbProcess( nullptr )
 , outputGainOld( 0.f )
 , currentProcessMode( -1 ) // -1 means not initialized
+, stageProfiling( false )
 {
     // register its editor class (the same as used in vstentry.cpp)
     setControllerClass( VST::FogPadControllerUID );
 
+    gainReductionHistory = new Limiter::GainReductionHistory();
+    levelsHistory        = new LevelMeter::LevelsHistory();
+    stageTimingsHistory  = new StageProfiler::TimingsHistory();
+
     // should be created on setupProcessing, this however doesn't fire for Audio Unit using auval?
     reverbProcess = new ReverbProcess( 2 );
+    reverbProcess->limiter->setGainReductionHistory( gainReductionHistory );
+    reverbProcess->levelMeter->setHistory( levelsHistory );
+    reverbProcess->profiler->setHistory( stageTimingsHistory );
 }
 
 //------------------------------------------------------------------------
@@ -72,6 +102,9 @@ FogPad::~FogPad()
 {
     // free all allocated resources
     delete reverbProcess;
+    delete gainReductionHistory;
+    delete levelsHistory;
+    delete stageTimingsHistory;
 }
 
 //------------------------------------------------------------------------
@@ -87,16 +120,30 @@ tresult PLUGIN_API FogPad::initialize( FUnknown* context )
     addAudioInput ( STR16( "Stereo In" ),  SpeakerArr::kStereo );
     addAudioOutput( STR16( "Stereo Out" ), SpeakerArr::kStereo );
 
+    //---create the optional sidechain input (inactive until enabled in the host)------
+    setSidechainArrangement( SpeakerArr::kStereo );
+
     //---create Event In/Out buses (1 bus with only 1 channel)------
     addEventInput( STR16( "Event In" ), 1 );
 
+    // copy the presets, this touches all pages of the mapped bank outside of the audio thread
+
+    PresetBank* presetBank = PresetBank::acquire();
+    presets.resize( presetBank->getAmount() );
+
+    for ( size_t i = 0; i < presets.size(); ++i )
+        presetBank->getPreset(( int ) i, presets[ i ] );
+
+    PresetBank::release( presetBank );
+
     return kResultOk;
 }
 
 //------------------------------------------------------------------------
 tresult PLUGIN_API FogPad::terminate()
 {
-    // nothing to do here yet...except calling our parent terminate
+    presets.clear();
+
     return AudioEffect::terminate();
 }
 
@@ -218,6 +265,51 @@ tresult PLUGIN_API FogPad::process( ProcessData& data )
                             fLFOFilterDepth = ( float ) value;
                         break;
 
+                    case kLFOFilterShapeId:
+                        if ( paramQueue->getPoint( numPoints - 1, sampleOffset, value ) == kResultTrue )
+                            fLFOFilterShape = ( float ) value;
+                        break;
+
+                    case kLFOBitResolutionShapeId:
+                        if ( paramQueue->getPoint( numPoints - 1, sampleOffset, value ) == kResultTrue )
+                            fLFOBitResolutionShape = ( float ) value;
+                        break;
+
+                    case kLFOFilterSyncId:
+                        if ( paramQueue->getPoint( numPoints - 1, sampleOffset, value ) == kResultTrue )
+                            fLFOFilterSync = ( float ) value;
+                        break;
+
+                    case kLFOBitResolutionSyncId:
+                        if ( paramQueue->getPoint( numPoints - 1, sampleOffset, value ) == kResultTrue )
+                            fLFOBitResolutionSync = ( float ) value;
+                        break;
+
+                    case kLimiterLookaheadId:
+                        if ( paramQueue->getPoint( numPoints - 1, sampleOffset, value ) == kResultTrue )
+                            fLimiterLookahead = ( float ) value;
+                        break;
+
+                    case kBypassId:
+                        if ( paramQueue->getPoint( numPoints - 1, sampleOffset, value ) == kResultTrue )
+                            fBypass = ( float ) value;
+                        break;
+
+                    case kQualityId:
+                        if ( paramQueue->getPoint( numPoints - 1, sampleOffset, value ) == kResultTrue )
+                            fQuality = ( float ) value;
+                        break;
+
+                    case kSidechainDuckId:
+                        if ( paramQueue->getPoint( numPoints - 1, sampleOffset, value ) == kResultTrue )
+                            fSidechainDuck = ( float ) value;
+                        break;
+
+                    case kProgramId:
+                        if ( paramQueue->getPoint( numPoints - 1, sampleOffset, value ) == kResultTrue )
+                            loadPreset(( float ) value );
+                        break;
+
                 }
                 syncModel();
             }
@@ -227,6 +319,20 @@ tresult PLUGIN_API FogPad::process( ProcessData& data )
     //---2) Read input events-------------
 //    IEventList* eventList = data.inputEvents;
 
+    // synchronize the tempo synced oscillators with the host transport. The position
+    // is only provided while playing so the oscillators keep moving when stopped
+
+    ProcessContext* processContext = data.processContext;
+    if ( processContext )
+    {
+        if ( processContext->state & ProcessContext::kTempoValid )
+            reverbProcess->setTempo( processContext->tempo );
+
+        if (( processContext->state & ProcessContext::kPlaying ) &&
+            ( processContext->state & ProcessContext::kProjectTimeMusicValid ))
+            reverbProcess->setPosition( processContext->projectTimeMusic );
+    }
+
     //-------------------------------------
     //---3) Process Audio---------------------
     //-------------------------------------
@@ -241,10 +347,23 @@ tresult PLUGIN_API FogPad::process( ProcessData& data )
     int32 numOutChannels = data.outputs[ 0 ].numChannels;
 
     // --- get audio buffers----------------
-    uint32 sampleFramesSize = getSampleFramesSizeInBytes( processSetup, data.numSamples );
     void** in  = getChannelBuffersPointer( processSetup, data.inputs [ 0 ] );
     void** out = getChannelBuffersPointer( processSetup, data.outputs[ 0 ] );
 
+    // the sidechain buffers (when the sidechain bus is active)
+
+    void** sidechain = nullptr;
+    int32 numSidechainChannels = 0;
+
+    if ( data.numInputs > 1 && data.inputs[ 1 ].numChannels > 0 && audioInputs.at( 1 )->isActive() ) {
+        sidechain = getChannelBuffersPointer( processSetup, data.inputs[ 1 ] );
+        numSidechainChannels = data.inputs[ 1 ].numChannels;
+    }
+
+    // apply the profiling request of the controller (see notify())
+
+    reverbProcess->profiler->setEnabled( stageProfiling.load( std::memory_order_relaxed ));
+
     // process the incoming sound!
 
     bool isDoublePrecision = ( data.symbolicSampleSize == kSample64 );
@@ -253,14 +372,14 @@ tresult PLUGIN_API FogPad::process( ProcessData& data )
         // 64-bit samples, e.g. Reaper64
         reverbProcess->process<double>(
             ( double** ) in, ( double** ) out, numInChannels, numOutChannels,
-            data.numSamples, sampleFramesSize
+            data.numSamples, ( double** ) sidechain, numSidechainChannels
         );
     }
     else {
         // 32-bit samples, e.g. Ableton Live, Bitwig Studio... (oddly enough also when 64-bit?)
         reverbProcess->process<float>(
             ( float** ) in, ( float** ) out, numInChannels, numOutChannels,
-            data.numSamples, sampleFramesSize
+            data.numSamples, ( float** ) sidechain, numSidechainChannels
         );
     }
 
@@ -273,7 +392,9 @@ tresult PLUGIN_API FogPad::process( ProcessData& data )
     IParameterChanges* outParamChanges = data.outputParameterChanges;
     // a new value of VuMeter will be sent to the host
     // (the host will send it back in sync to our controller for updating our editor)
-    if ( !isDoublePrecision && outParamChanges && outputGainOld != outputGain ) {
+    // the levels of the input and output are provided through the levels history
+    // (both are measured for single as well as double precision processing)
+    if ( outParamChanges && outputGainOld != outputGain ) {
         int32 index = 0;
         IParamValueQueue* paramQueue = outParamChanges->addParameterData( kVuPPMId, index );
         if ( paramQueue )
@@ -298,100 +419,17 @@ tresult FogPad::receiveText( const char* text )
 tresult PLUGIN_API FogPad::setState( IBStream* state )
 {
     // called when we load a preset, the model has to be reloaded
+    // the state is read in full and parsed by the shared PluginState parser
 
-    float savedReverbSize = 0.f;
-    if ( state->read( &savedReverbSize, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedReverbWidth = 0.f;
-    if ( state->read( &savedReverbWidth, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedReverbDryMix = 0.f;
-    if ( state->read( &savedReverbDryMix, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedReverbWetMix = 0.f;
-    if ( state->read( &savedReverbWetMix, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedReverbFreeze = 0.f;
-    if ( state->read( &savedReverbFreeze, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedReverbPlaybackRate = 0.f;
-    if ( state->read( &savedReverbPlaybackRate, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedBitResolution = 0.f;
-    if ( state->read( &savedBitResolution, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedBitResolutionChain = 0.f;
-    if ( state->read( &savedBitResolutionChain, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedLFOBitResolution = 0.f;
-    if ( state->read( &savedLFOBitResolution, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedLFOBitResolutionDepth = 0.f;
-    if ( state->read( &savedLFOBitResolutionDepth, sizeof ( float )) != kResultOk )
-        return kResultFalse;
+    char data[ PluginState::MAX_SIZE ];
+    int32 size = 0;
+    state->read( data, PluginState::MAX_SIZE, &size );
 
-    float savedDecimator = 0.f;
-    if ( state->read( &savedDecimator, sizeof ( float )) != kResultOk )
+    PluginState pluginState;
+    if ( size <= 0 || !pluginState.read( data, ( size_t ) size ))
         return kResultFalse;
 
-    float savedFilterCutoff = 0.f;
-    if ( state->read( &savedFilterCutoff, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedFilterResonance = 0.f;
-    if ( state->read( &savedFilterResonance, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedLFOFilter = 0.f;
-    if ( state->read( &savedLFOFilter, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-    float savedLFOFilterDepth = 0.f;
-    if ( state->read( &savedLFOFilterDepth, sizeof ( float )) != kResultOk )
-        return kResultFalse;
-
-#if BYTEORDER == kBigEndian
-    SWAP32( savedReverbSize )
-    SWAP32( savedReverbWidth )
-    SWAP32( savedReverbDryMix )
-    SWAP32( savedReverbWetMix )
-    SWAP32( savedReverbFreeze )
-    SWAP32( savedReverbPlaybackRate )
-    SWAP32( savedBitResolution )
-    SWAP32( savedBitResolutionChain )
-    SWAP32( savedLFOBitResolution )
-    SWAP32( savedLFOBitResolutionDepth )
-    SWAP32( savedDecimator )
-    SWAP32( savedFilterCutoff )
-    SWAP32( savedFilterResonance )
-    SWAP32( savedLFOFilter )
-    SWAP32( savedLFOFilterDepth )
-#endif
-
-    fReverbSize             = savedReverbSize;
-    fReverbWidth            = savedReverbWidth;
-    fReverbDryMix           = savedReverbDryMix;
-    fReverbWetMix           = savedReverbWetMix;
-    fReverbFreeze           = savedReverbFreeze,
-    fReverbPlaybackRate     = savedReverbPlaybackRate;
-    fBitResolution          = savedBitResolution;
-    fBitResolutionChain     = savedBitResolutionChain;
-    fLFOBitResolution       = savedLFOBitResolution;
-    fLFOBitResolutionDepth  = savedLFOBitResolutionDepth;
-    fDecimator              = savedDecimator;
-    fFilterCutoff           = savedFilterCutoff;
-    fFilterResonance        = savedFilterResonance;
-    fLFOFilter              = savedLFOFilter;
-    fLFOFilterDepth         = savedLFOFilterDepth;
+    applyState( pluginState );
 
     syncModel();
 
@@ -433,55 +471,16 @@ tresult PLUGIN_API FogPad::getState( IBStream* state )
 {
     // here we need to save the model
 
-    float toSaveReverbSize            = fReverbSize;
-    float toSaveReverbWidth           = fReverbWidth;
-    float toSaveReverbDryMix          = fReverbDryMix;
-    float toSaveReverbWetMix          = fReverbWetMix;
-    float toSaveReverbFreeze          = fReverbFreeze;
-    float toSaveReverbPlaybackRate    = fReverbPlaybackRate;
-    float toSaveBitResolution         = fBitResolution;
-    float toSaveBitResolutionChain    = fBitResolutionChain;
-    float toSaveLFOBitResolution      = fLFOBitResolution;
-    float toSaveLFOBitResolutionDepth = fLFOBitResolutionDepth;
-    float toSaveDecimator             = fDecimator;
-    float toSaveFilterCutoff          = fFilterCutoff;
-    float toSaveFilterResonance       = fFilterResonance;
-    float toSaveLFOFilter             = fLFOFilter;
-    float toSaveLFOFilterDepth        = fLFOFilterDepth;
-
-#if BYTEORDER == kBigEndian
-    SWAP32( toSaveReverbSize );
-    SWAP32( toSaveReverbWidth );
-    SWAP32( toSaveReverbDryMix );
-    SWAP32( toSaveReverbWetMix );
-    SWAP32( toSaveReverbFreeze );
-    SWAP32( toSaveReverbPlaybackRate );
-    SWAP32( toSaveBitResolution );
-    SWAP32( toSaveBitResolutionChain );
-    SWAP32( toSaveLFOBitResolution );
-    SWAP32( toSaveLFOBitResolutionDepth );
-    SWAP32( toSaveDecimator );
-    SWAP32( toSaveFilterCutoff );
-    SWAP32( toSaveFilterResonance );
-    SWAP32( toSaveLFOFilter );
-    SWAP32( toSaveLFOFilterDepth );
-#endif
-
-    state->write( &toSaveReverbSize            , sizeof( float ));
-    state->write( &toSaveReverbWidth           , sizeof( float ));
-    state->write( &toSaveReverbDryMix          , sizeof( float ));
-    state->write( &toSaveReverbWetMix          , sizeof( float ));
-    state->write( &toSaveReverbFreeze          , sizeof( float ));
-    state->write( &toSaveReverbPlaybackRate    , sizeof( float ));
-    state->write( &toSaveBitResolution         , sizeof( float ));
-    state->write( &toSaveBitResolutionChain    , sizeof( float ));
-    state->write( &toSaveLFOBitResolution      , sizeof( float ));
-    state->write( &toSaveLFOBitResolutionDepth , sizeof( float ));
-    state->write( &toSaveDecimator             , sizeof( float ));
-    state->write( &toSaveFilterCutoff          , sizeof( float ));
-    state->write( &toSaveFilterResonance       , sizeof( float ));
-    state->write( &toSaveLFOFilter             , sizeof( float ));
-    state->write( &toSaveLFOFilterDepth        , sizeof( float ));
+    PluginState pluginState;
+    storeState( pluginState );
+
+    // written in a single write
+
+    char data[ PluginState::MAX_SIZE ];
+    size_t size = pluginState.write( data, PluginState::MAX_SIZE );
+
+    if ( size == 0 || state->write( data, ( int32 ) size ) != kResultOk )
+        return kResultFalse;
 
     return kResultOk;
 }
@@ -503,7 +502,11 @@ tresult PLUGIN_API FogPad::setupProcessing( ProcessSetup& newSetup )
 
     // TODO: creating a bunch of extra channels for no apparent reason?
     // get the correct channel amount and don't allocate more than necessary...
-    reverbProcess = new ReverbProcess( 6 );
+    reverbProcess = new ReverbProcess( 6, newSetup.maxSamplesPerBlock );
+    reverbProcess->limiter->setGainReductionHistory( gainReductionHistory );
+    reverbProcess->levelMeter->setHistory( levelsHistory );
+    reverbProcess->profiler->setHistory( stageTimingsHistory );
+    reverbProcess->profiler->setEnabled( stageProfiling.load() );
 
     syncModel();
 
@@ -514,56 +517,97 @@ tresult PLUGIN_API FogPad::setupProcessing( ProcessSetup& newSetup )
 tresult PLUGIN_API FogPad::setBusArrangements( SpeakerArrangement* inputs,  int32 numIns,
                                                SpeakerArrangement* outputs, int32 numOuts )
 {
-    if ( numIns == 1 && numOuts == 1 )
+    // the first input is the main input, the optional second input is the sidechain
+
+    if (( numIns != 1 && numIns != 2 ) || numOuts != 1 )
+        return kResultFalse;
+
+    tresult result = setMainBusArrangement( inputs[ 0 ], outputs[ 0 ] );
+
+    // the sidechain accepts a mono or stereo signal (remaining stereo when unspecified), note it
+    // is also reapplied when the main buses were recreated (which removes all input buses)
+
+    SpeakerArrangement sidechain = ( numIns == 2 ) ? inputs[ 1 ] : SpeakerArr::kStereo;
+
+    if ( SpeakerArr::getChannelCount( sidechain ) > 2 ) {
+        sidechain = SpeakerArr::kStereo;
+        result    = kResultFalse;
+    }
+    setSidechainArrangement( sidechain );
+
+    return result;
+}
+
+//------------------------------------------------------------------------
+tresult FogPad::setMainBusArrangement( SpeakerArrangement input, SpeakerArrangement output )
+{
+    // the host wants Mono => Mono (or 1 channel -> 1 channel)
+    if ( SpeakerArr::getChannelCount( input )  == 1 &&
+         SpeakerArr::getChannelCount( output ) == 1 )
     {
-        // the host wants Mono => Mono (or 1 channel -> 1 channel)
-        if ( SpeakerArr::getChannelCount( inputs[0])  == 1 &&
-             SpeakerArr::getChannelCount( outputs[0]) == 1 )
+        AudioBus* bus = FCast<AudioBus>( audioInputs.at( 0 ));
+        if ( bus )
         {
-            AudioBus* bus = FCast<AudioBus>( audioInputs.at( 0 ));
-            if ( bus )
+            // check if we are Mono => Mono, if not we need to recreate the buses
+            if ( bus->getArrangement() != input )
             {
-                // check if we are Mono => Mono, if not we need to recreate the buses
-                if ( bus->getArrangement() != inputs[0])
-                {
-                    removeAudioBusses();
-                    addAudioInput ( STR16( "Mono In" ),  inputs[0] );
-                    addAudioOutput( STR16( "Mono Out" ), inputs[0] );
-                }
-                return kResultOk;
+                removeAudioBusses();
+                addAudioInput ( STR16( "Mono In" ),  input );
+                addAudioOutput( STR16( "Mono Out" ), input );
             }
+            return kResultOk;
         }
-        // the host wants something else than Mono => Mono, in this case we are always Stereo => Stereo
-        else
+    }
+    // the host wants something else than Mono => Mono, in this case we are always Stereo => Stereo
+    else
+    {
+        AudioBus* bus = FCast<AudioBus>( audioInputs.at(0));
+        if ( bus )
         {
-            AudioBus* bus = FCast<AudioBus>( audioInputs.at(0));
-            if ( bus )
-            {
-                tresult result = kResultFalse;
+            tresult result = kResultFalse;
 
-                // the host wants 2->2 (could be LsRs -> LsRs)
-                if ( SpeakerArr::getChannelCount(inputs[0]) == 2 && SpeakerArr::getChannelCount( outputs[0]) == 2 )
-                {
-                    removeAudioBusses();
-                    addAudioInput  ( STR16( "Stereo In"),  inputs[0] );
-                    addAudioOutput ( STR16( "Stereo Out"), outputs[0]);
-                    result = kResultTrue;
-                }
-                // the host want something different than 1->1 or 2->2 : in this case we want stereo
-                else if ( bus->getArrangement() != SpeakerArr::kStereo )
-                {
-                    removeAudioBusses();
-                    addAudioInput ( STR16( "Stereo In"),  SpeakerArr::kStereo );
-                    addAudioOutput( STR16( "Stereo Out"), SpeakerArr::kStereo );
-                    result = kResultFalse;
-                }
-                return result;
+            // the host wants 2->2 (could be LsRs -> LsRs)
+            if ( SpeakerArr::getChannelCount( input ) == 2 && SpeakerArr::getChannelCount( output ) == 2 )
+            {
+                removeAudioBusses();
+                addAudioInput  ( STR16( "Stereo In"),  input );
+                addAudioOutput ( STR16( "Stereo Out"), output );
+                result = kResultTrue;
             }
+            // the host want something different than 1->1 or 2->2 : in this case we want stereo
+            else if ( bus->getArrangement() != SpeakerArr::kStereo )
+            {
+                removeAudioBusses();
+                addAudioInput ( STR16( "Stereo In"),  SpeakerArr::kStereo );
+                addAudioOutput( STR16( "Stereo Out"), SpeakerArr::kStereo );
+                result = kResultFalse;
+            }
+            return result;
         }
     }
     return kResultFalse;
 }
 
+//------------------------------------------------------------------------
+void FogPad::setSidechainArrangement( SpeakerArrangement arrangement )
+{
+    AudioBus* bus = audioInputs.size() > 1 ? FCast<AudioBus>( audioInputs.at( 1 )) : nullptr;
+
+    if ( bus )
+        bus->setArrangement( arrangement );
+    else
+        addAudioInput( STR16( "Sidechain In" ), arrangement, kAux, 0 );
+}
+
+//------------------------------------------------------------------------
+uint32 PLUGIN_API FogPad::getLatencySamples()
+{
+    // the lookahead limiter delays the output, the controller requests
+    // the host to query this value again whenever lookahead is toggled
+
+    return ( uint32 ) reverbProcess->limiter->getLatencySamples();
+}
+
 //------------------------------------------------------------------------
 tresult PLUGIN_API FogPad::canProcessSampleSize( int32 symbolicSampleSize )
 {
@@ -599,30 +643,166 @@ tresult PLUGIN_API FogPad::notify( IMessage* message )
         }
     }
 
+    // sent by the controller while the diagnostics are shown
+
+    if ( !strcmp( message->getMessageID(), "StageProfiling" ))
+    {
+        int64 enabled;
+        if ( message->getAttributes()->getInt( "enabled", enabled ) == kResultOk )
+        {
+            stageProfiling.store( enabled != 0 );
+            return kResultOk;
+        }
+    }
+
     return AudioEffect::notify( message );
 }
 
-void FogPad::syncModel()
+//------------------------------------------------------------------------
+tresult PLUGIN_API FogPad::connect( IConnectionPoint* other )
 {
-    reverbProcess->setRoomSize( fReverbSize );
-    reverbProcess->setWidth( fReverbWidth );
-    reverbProcess->setDry( fReverbDryMix );
-    reverbProcess->setWet( fReverbWetMix );
-    reverbProcess->setMode( fReverbFreeze );
-    reverbProcess->setPlaybackRate( fReverbPlaybackRate );
+    tresult result = AudioEffect::connect( other );
+
+    if ( result == kResultOk )
+        historyTimer = owned( Timer::create( this, HISTORY_INTERVAL_MS ));
 
-    reverbProcess->bitCrusherPostMix = Calc::toBool( fBitResolutionChain );
+    return result;
+}
 
-    reverbProcess->bitCrusher->setAmount( fBitResolution );
-    reverbProcess->bitCrusher->setLFO( fLFOBitResolution, fLFOBitResolutionDepth );
+//------------------------------------------------------------------------
+tresult PLUGIN_API FogPad::disconnect( IConnectionPoint* other )
+{
+    if ( historyTimer ) {
+        historyTimer->stop();
+        historyTimer = nullptr;
+    }
+
+    return AudioEffect::disconnect( other );
+}
+
+//------------------------------------------------------------------------
+void FogPad::onTimer( Timer* /* timer */ )
+{
+    // the histories are filled by the audio thread, send their entries as a copy
+    // so the controller doesn't depend on the memory of this processor
 
-    // invert the decimator range 0 == max bits (no distortion), 1 == min bits (severely distorted)
-    float scaledDecimator = abs( fDecimator - 1.0f );
-    int decimation = ( int )( scaledDecimator * 32.f );
-    reverbProcess->decimator->setBits( decimation );
-    reverbProcess->decimator->setRate( scaledDecimator );
+    drainHistory( gainReductionHistory, gainReductions );
+
+    if ( !gainReductions.empty() )
+        sendHistoryEntries( "GainReductionHistory", gainReductions.data(),
+                            ( uint32 )( gainReductions.size() * sizeof( Limiter::GainReduction )));
+
+    drainHistory( levelsHistory, levels );
+
+    if ( !levels.empty() )
+        sendHistoryEntries( "LevelsHistory", levels.data(),
+                            ( uint32 )( levels.size() * sizeof( LevelMeter::Levels )));
+
+    drainHistory( stageTimingsHistory, stageTimings );
+
+    if ( !stageTimings.empty() )
+        sendHistoryEntries( "StageTimingsHistory", stageTimings.data(),
+                            ( uint32 )( stageTimings.size() * sizeof( StageProfiler::Timings )));
+}
+
+//------------------------------------------------------------------------
+void FogPad::sendHistoryEntries( const char* messageId, const void* entries, uint32 size )
+{
+    if ( IPtr<IMessage> message = owned( allocateMessage()))
+    {
+        message->setMessageID( messageId );
+        message->getAttributes()->setBinary( "entries", entries, size );
+        sendMessage( message );
+    }
+}
+
+void FogPad::applyState( const PluginState& pluginState )
+{
+    // values absent in the state (e.g. added after it was saved) remain unchanged
+
+    pluginState.getValue( kReverbSizeId,            fReverbSize );
+    pluginState.getValue( kReverbWidthId,           fReverbWidth );
+    pluginState.getValue( kReverbDryMixId,          fReverbDryMix );
+    pluginState.getValue( kReverbWetMixId,          fReverbWetMix );
+    pluginState.getValue( kReverbFreezeId,          fReverbFreeze );
+    pluginState.getValue( kReverbPlaybackRateId,    fReverbPlaybackRate );
+    pluginState.getValue( kBitResolutionId,         fBitResolution );
+    pluginState.getValue( kBitResolutionChainId,    fBitResolutionChain );
+    pluginState.getValue( kLFOBitResolutionId,      fLFOBitResolution );
+    pluginState.getValue( kLFOBitResolutionDepthId, fLFOBitResolutionDepth );
+    pluginState.getValue( kDecimatorId,             fDecimator );
+    pluginState.getValue( kFilterCutoffId,          fFilterCutoff );
+    pluginState.getValue( kFilterResonanceId,       fFilterResonance );
+    pluginState.getValue( kLFOFilterId,             fLFOFilter );
+    pluginState.getValue( kLFOFilterDepthId,        fLFOFilterDepth );
+    pluginState.getValue( kLFOFilterShapeId,        fLFOFilterShape );
+    pluginState.getValue( kLFOBitResolutionShapeId, fLFOBitResolutionShape );
+    pluginState.getValue( kLFOFilterSyncId,         fLFOFilterSync );
+    pluginState.getValue( kLFOBitResolutionSyncId,  fLFOBitResolutionSync );
+    pluginState.getValue( kLimiterLookaheadId,      fLimiterLookahead );
+    pluginState.getValue( kBypassId,                fBypass );
+    pluginState.getValue( kQualityId,               fQuality );
+    pluginState.getValue( kSidechainDuckId,         fSidechainDuck );
+}
+
+void FogPad::storeState( PluginState& pluginState )
+{
+    pluginState.setValue( kReverbSizeId,            fReverbSize );
+    pluginState.setValue( kReverbWidthId,           fReverbWidth );
+    pluginState.setValue( kReverbDryMixId,          fReverbDryMix );
+    pluginState.setValue( kReverbWetMixId,          fReverbWetMix );
+    pluginState.setValue( kReverbFreezeId,          fReverbFreeze );
+    pluginState.setValue( kReverbPlaybackRateId,    fReverbPlaybackRate );
+    pluginState.setValue( kBitResolutionId,         fBitResolution );
+    pluginState.setValue( kBitResolutionChainId,    fBitResolutionChain );
+    pluginState.setValue( kLFOBitResolutionId,      fLFOBitResolution );
+    pluginState.setValue( kLFOBitResolutionDepthId, fLFOBitResolutionDepth );
+    pluginState.setValue( kDecimatorId,             fDecimator );
+    pluginState.setValue( kFilterCutoffId,          fFilterCutoff );
+    pluginState.setValue( kFilterResonanceId,       fFilterResonance );
+    pluginState.setValue( kLFOFilterId,             fLFOFilter );
+    pluginState.setValue( kLFOFilterDepthId,        fLFOFilterDepth );
+    pluginState.setValue( kLFOFilterShapeId,        fLFOFilterShape );
+    pluginState.setValue( kLFOBitResolutionShapeId, fLFOBitResolutionShape );
+    pluginState.setValue( kLFOFilterSyncId,         fLFOFilterSync );
+    pluginState.setValue( kLFOBitResolutionSyncId,  fLFOBitResolutionSync );
+    pluginState.setValue( kLimiterLookaheadId,      fLimiterLookahead );
+    pluginState.setValue( kBypassId,                fBypass );
+    pluginState.setValue( kQualityId,               fQuality );
+    pluginState.setValue( kSidechainDuckId,         fSidechainDuck );
+}
+
+void FogPad::loadPreset( float value )
+{
+    if ( presets.empty() )
+        return;
+
+    float bypass = fBypass;
+    applyState( presets[ Calc::toIndex( value, ( int ) presets.size() )]);
+    fBypass = bypass;
+}
+
+VST::Quality FogPad::getQuality()
+{
+    // entries match the order of the quality list parameter (see controller.cpp)
+    switch ( Calc::toIndex( fQuality, 3 ))
+    {
+        default:
+        case 0:
+            return ( currentProcessMode == kOffline ) ? VST::QUALITY_HIGH : VST::QUALITY_ECO;
+        case 1:
+            return VST::QUALITY_ECO;
+        case 2:
+            return VST::QUALITY_HIGH;
+    }
+}
+
+void FogPad::syncModel()
+{
+    PluginState model;
+    storeState( model );
 
-    reverbProcess->filter->updateProperties( fFilterCutoff, fFilterResonance, fLFOFilter, fLFOFilterDepth );
+    ProcessModel::apply( reverbProcess, model, getQuality() );
 }
 
 }
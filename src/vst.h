@@ -24,14 +24,21 @@
 #define __VST_HEADER__
 
 #include "public.sdk/source/vst/vstaudioeffect.h"
+#include "base/source/timer.h"
 #include "reverbprocess.h"
+#include "pluginstate.h"
+#include "presetbank.h"
 #include "global.h"
+#include "pluginids.h"
+
+#include <atomic>
+#include <vector>
 
 using namespace Steinberg::Vst;
 
 namespace Igorski {
 
-class FogPad : public AudioEffect
+class FogPad : public AudioEffect, public ITimerCallback
 {
     public:
         FogPad ();
@@ -73,12 +80,25 @@ class FogPad : public AudioEffect
                                                SpeakerArrangement* outputs,
                                                int32 numOuts ) SMTG_OVERRIDE;
 
+        /** Gets the current Latency in samples. */
+        uint32 PLUGIN_API getLatencySamples() SMTG_OVERRIDE;
+
         /** Asks if a given sample size is supported see \ref SymbolicSampleSizes. */
         tresult PLUGIN_API canProcessSampleSize( int32 symbolicSampleSize ) SMTG_OVERRIDE;
 
         /** We want to receive message. */
         tresult PLUGIN_API notify( IMessage* message ) SMTG_OVERRIDE;
 
+        //--- ---------------------------------------------------------------------
+        // ITimerCallback:
+        //--- ---------------------------------------------------------------------
+        /** Sends the entries recorded in the histories to the controller */
+        void onTimer( Timer* timer ) SMTG_OVERRIDE;
+
+        /** Connects / disconnects the controller */
+        tresult PLUGIN_API connect( IConnectionPoint* other ) SMTG_OVERRIDE;
+        tresult PLUGIN_API disconnect( IConnectionPoint* other ) SMTG_OVERRIDE;
+
     //------------------------------------------------------------------------
     protected:
         //==============================================================================
@@ -104,6 +124,14 @@ class FogPad : public AudioEffect
         float fFilterResonance;
         float fLFOFilter;
         float fLFOFilterDepth;
+        float fLFOFilterShape;
+        float fLFOBitResolutionShape;
+        float fLFOFilterSync;
+        float fLFOBitResolutionSync;
+        float fLimiterLookahead;
+        float fBypass;
+        float fQuality;
+        float fSidechainDuck;
 
         float outputGainOld; // for visualizing output gain in DAW
 
@@ -111,9 +139,68 @@ class FogPad : public AudioEffect
 
         Igorski::ReverbProcess* reverbProcess;
 
+        // gain reduction history recorded by the limiter, sent to the controller for
+        // visualization (lives as long as this processor, across ReverbProcess instances)
+
+        Limiter::GainReductionHistory* gainReductionHistory;
+        std::vector<Limiter::GainReduction> gainReductions; // entries drained for sending
+
+        // input and output levels of each process cycle, sent to the controller for metering
+
+        LevelMeter::LevelsHistory* levelsHistory;
+        std::vector<LevelMeter::Levels> levels; // entries drained for sending
+
+        // per-stage timings of each process cycle, sent to the controller for diagnostics
+        // profiling is only enabled while requested by the controller (see notify()), the request
+        // is applied onto the profiler by process() as the ReverbProcess can be replaced meanwhile
+
+        StageProfiler::TimingsHistory* stageTimingsHistory;
+        std::vector<StageProfiler::Timings> stageTimings; // entries drained for sending
+        std::atomic<bool> stageProfiling;
+
+        // the presets of the bank shared by all instances, copied upon initialization as reading
+        // the mapped bank on the audio thread can page fault (see loadPreset()). The amount of
+        // presets is that of the bank when acquired, as is the program list of the controller
+
+        std::vector<PluginState> presets;
+
+        // applies the parameter values contained in given state onto the model
+
+        void applyState( const PluginState& pluginState );
+
+        // stores the parameter values of the model into given state
+
+        void storeState( PluginState& pluginState );
+
+        // applies the preset selected by given normalized program change value
+        // the bypass state is not part of the preset and remains unchanged
+
+        void loadPreset( float value );
+
+        // drains the histories into messages for the controller outside of the audio thread
+        // (runs while connected to the controller)
+
+        static const uint32 HISTORY_INTERVAL_MS = 33;
+        IPtr<Timer> historyTimer;
+
+        // sends given entries of a history (identified by messageId) to the controller
+
+        void sendHistoryEntries( const char* messageId, const void* entries, uint32 size );
+
+        // applies the arrangements requested by setBusArrangements() onto the main buses
+        // (recreating these when required) and onto the sidechain bus (creating it when absent)
+
+        tresult setMainBusArrangement( SpeakerArrangement input, SpeakerArrangement output );
+        void setSidechainArrangement( SpeakerArrangement arrangement );
+
         // synchronize the processors model with UI led changes
 
         void syncModel();
+
+        // resolves the quality tier to process at, when set to "Auto" offline
+        // rendering uses the high quality tier and realtime processing the eco tier
+
+        VST::Quality getQuality();
 };
 
 }
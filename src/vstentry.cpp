@@ -23,7 +23,9 @@
 #include "vst.h"
 #include "ui/controller.h"
 #include "global.h"
+#include "pluginids.h"
 #include "version.h"
+#include "kernels/kernels.h"
 
 #include "public.sdk/source/main/pluginfactoryvst3.h"
 
@@ -38,6 +40,9 @@ using namespace Igorski;
 // called after library was loaded
 bool InitModule ()
 {
+    // select the processing kernels best suited to the CPU, once for all instances
+    Kernels::select();
+
     return true;
 }
 
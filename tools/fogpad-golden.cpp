@@ -0,0 +1,704 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "global.h"
+#include "calc.h"
+#include "pluginstate.h"
+#include "processmodel.h"
+#include "reverbprocess.h"
+#include "kernels/kernels.h"
+#include "parameternames.h"
+#include "presetbank.h"
+#include "wavefile.h"
+#include <cmath>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using namespace Igorski;
+
+/**
+ * fogpad-golden guards the sound of the plugin against unintended changes (e.g. when optimizing
+ * the processing kernels). It renders fixed stimuli through the ReverbProcess for a matrix of
+ * parameter settings and sample rates. In write mode the renders are stored as reference files,
+ * in verify mode the renders are compared against previously written references, where each
+ * setting defines its own tolerance (either bit-exactness or a maximum absolute deviation and
+ * a minimum signal-to-noise ratio of the difference).
+ *
+ * The references are 32-bit floating point WAV files and are as such exact. As floating point
+ * results differ between compilers and instruction sets, write the references with a build
+ * of the baseline revision, on the same machine and with the same build configuration.
+ *
+ * As the references are too large to be kept in the repository, the repository keeps a
+ * fingerprint of each render instead (see tools/golden/fingerprints.txt): the RMS of each channel
+ * over consecutive windows. Their tolerance derives from the minimum signal-to-noise ratio
+ * of the setting, relative to the loudest window of the render.
+ *
+ * In preset check mode the presets of a bank are rendered and required to differ from the
+ * render of the first (Init) preset, which guards against presets that have no audible effect.
+ */
+
+static const int BLOCK_SIZE           = 512; // block dependent properties (e.g. ramps) require a fixed size
+static const int AMOUNT_OF_CHANNELS   = 2;
+static const float STIMULUS_SECONDS   = .5f;
+static const float RENDER_SECONDS     = 1.5f; // the stimulus followed by the tail
+static const double TEMPO             = 120.0;
+static const float NO_MAX_DEVIATION   = -1.f;
+static const int FINGERPRINT_WINDOWS  = 30; // windows over RENDER_SECONDS (50 ms each)
+
+static const int SAMPLE_RATES[] = { 44100, 48000, 96000 };
+
+enum Stimulus {
+    IMPULSE = 0,
+    NOISE,
+    SWEEP,
+    STIMULUS_AMOUNT
+};
+static const char* STIMULUS_NAMES[ STIMULUS_AMOUNT ] = { "impulse", "noise", "sweep" };
+
+// a parameter setting, the values are "name=value" pairs (see parameternames.h)
+// a maximum deviation of 0 requires the render to be bit-exact
+
+struct Setting {
+    const char* name;
+    const char* values;
+    float maxDeviation;
+    float minSNR; // in dB
+};
+
+static const Setting SETTINGS[] = {
+    { "default",      "",                                                                   1e-5f, 100.f },
+    { "large-room",   "size=0.9 width=0.5 dry=0.2 wet=0.8",                                 1e-5f, 100.f },
+    { "freeze",       "freeze=1",                                                           1e-5f, 100.f },
+    { "drift",        "wobble=0.2",                                                         1e-4f,  80.f },
+    { "filtered",     "cutoff=0.3 resonance=0.8 filter-lfo=0.4 filter-lfo-depth=0.7",       1e-4f,  80.f },
+    { "filtered-eco", "cutoff=0.3 resonance=0.8 filter-lfo=0.4 filter-lfo-depth=0.7 quality=0.5", 1e-4f, 80.f },
+    // quantization amplifies minute deviations into full steps, only the difference in energy is meaningful
+    { "crushed",      "bits=0.7 bits-lfo=0.3 bits-chain=1 decimator=0.4",                   NO_MAX_DEVIATION, 40.f },
+    { "limited",      "dry=1 wet=1 lookahead=1",                                            1e-5f, 100.f },
+};
+static const int SETTING_AMOUNT = sizeof( SETTINGS ) / sizeof( Setting );
+
+enum Mode {
+    NONE = 0,
+    WRITE,
+    VERIFY,
+    WRITE_FINGERPRINTS,
+    VERIFY_FINGERPRINTS,
+    CHECK_PRESETS
+};
+
+struct Options {
+    Mode mode  = NONE;
+    bool exact = false;
+    std::string path; // the directory, fingerprint file or bank of the mode
+    std::string filter;
+    std::string isa;
+};
+
+static void printUsage()
+{
+    fprintf( stderr,
+        "usage: fogpad-golden [options] --write <directory>\n"
+        "       fogpad-golden [options] --verify <directory>\n"
+        "       fogpad-golden [options] --write-fingerprints <file>\n"
+        "       fogpad-golden [options] --verify-fingerprints <file>\n"
+        "       fogpad-golden [options] --check-presets <bank>\n\n"
+        "  --write <directory>   renders the references into given directory\n"
+        "  --verify <directory>  compares the renders against the references in given directory\n"
+        "  --write-fingerprints <file>   writes the fingerprints of the renders into given file\n"
+        "  --verify-fingerprints <file>  compares the fingerprints of the renders against those in given file\n"
+        "  --check-presets <bank> verifies that each preset in given bank renders differently from the first preset\n"
+        "  --filter <name>       only renders the cases containing given name (e.g. \"crushed\" or \"96000\")\n"
+        "  --exact               requires all renders to be bit-exact, regardless of their tolerance\n"
+        "  --isa <name>          renders using the kernels of given instruction set (baseline, avx2 or avx512)\n"
+        "                        instead of the best instruction set supported by the CPU\n"
+        "  --list                lists the cases and their tolerances\n"
+    );
+}
+
+static std::string getCaseName( const Setting& setting, int stimulus, int sampleRate )
+{
+    return std::string( setting.name ) + "-" + STIMULUS_NAMES[ stimulus ] + "-" + std::to_string( sampleRate );
+}
+
+static bool createDirectory( const std::string& path )
+{
+#ifdef _WIN32
+    _mkdir( path.c_str() );
+#else
+    mkdir( path.c_str(), 0755 );
+#endif
+    struct stat info;
+    return stat( path.c_str(), &info ) == 0 && ( info.st_mode & S_IFDIR );
+}
+
+static bool applySetting( const Setting& setting, PluginState& state )
+{
+    std::string values = setting.values;
+    size_t start = 0;
+
+    while ( start < values.size() )
+    {
+        size_t end = values.find( ' ', start );
+        if ( end == std::string::npos )
+            end = values.size();
+
+        std::string assignment = values.substr( start, end - start );
+        size_t separator = assignment.find( '=' );
+        uint32_t paramId;
+
+        if ( separator == std::string::npos || !ParameterNames::getId( assignment.substr( 0, separator ).c_str(), paramId )) {
+            fprintf( stderr, "setting \"%s\" has unknown parameter assignment \"%s\"\n", setting.name, assignment.c_str() );
+            return false;
+        }
+        state.setValue( paramId, Calc::cap(( float ) atof( assignment.c_str() + separator + 1 )));
+        start = end + 1;
+    }
+    return true;
+}
+
+// generates given stimulus into the channel buffers. The right channel is a slightly
+// altered version of the left so the stereo processing (e.g. the width) is exercised
+
+static void generateStimulus( Stimulus stimulus, int sampleRate, std::vector<float>* channels, size_t frames )
+{
+    size_t stimulusFrames = ( size_t )( STIMULUS_SECONDS * sampleRate );
+
+    for ( int c = 0; c < AMOUNT_OF_CHANNELS; ++c )
+        channels[ c ].assign( frames, 0.f );
+
+    switch ( stimulus )
+    {
+        case IMPULSE:
+            channels[ 0 ][ 0 ]  = 1.f;
+            channels[ 1 ][ 16 ] = 1.f;
+            break;
+
+        case NOISE:
+        {
+            uint32_t seed = 1; // a linear congruential generator yields identical noise on every platform
+
+            for ( size_t i = 0; i < stimulusFrames; ++i ) {
+                for ( int c = 0; c < AMOUNT_OF_CHANNELS; ++c ) {
+                    seed = seed * 1664525u + 1013904223u;
+                    channels[ c ][ i ] = (( float )( seed >> 8 ) / 16777216.f - .5f );
+                }
+            }
+            break;
+        }
+
+        case SWEEP:
+        {
+            // exponential sine sweep from 20 Hz up to 20 kHz (or 90 % of the Nyquist frequency)
+
+            double startFrequency = 20.0;
+            double endFrequency   = std::min( 20000.0, sampleRate * .45 );
+            double duration       = STIMULUS_SECONDS;
+            double rate           = log( endFrequency / startFrequency );
+
+            for ( size_t i = 0; i < stimulusFrames; ++i ) {
+                double time  = ( double ) i / sampleRate;
+                double phase = 2.0 * VST::PI * startFrequency * duration / rate * ( exp( time / duration * rate ) - 1.0 );
+
+                channels[ 0 ][ i ] = ( float )( .5 * sin( phase ));
+                channels[ 1 ][ i ] = ( float )( .5 * cos( phase ));
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+// renders given stimulus through the ReverbProcess configured for given state
+
+static void render( const PluginState& state, Stimulus stimulus, int sampleRate, std::vector<float>* output )
+{
+    size_t frames = ( size_t )( RENDER_SECONDS * sampleRate );
+
+    std::vector<float> input[ AMOUNT_OF_CHANNELS ];
+    generateStimulus( stimulus, sampleRate, input, frames );
+
+    float quality = ProcessModel::getDefault( kQualityId );
+    state.getValue( kQualityId, quality );
+
+    VST::SAMPLE_RATE = ( float ) sampleRate;
+
+    ReverbProcess* process = new ReverbProcess( AMOUNT_OF_CHANNELS, BLOCK_SIZE );
+    ProcessModel::apply( process, state, Calc::toIndex( quality, 3 ) == 1 ? VST::QUALITY_ECO : VST::QUALITY_HIGH );
+
+    float* inBuffer [ AMOUNT_OF_CHANNELS ];
+    float* outBuffer[ AMOUNT_OF_CHANNELS ];
+
+    for ( int c = 0; c < AMOUNT_OF_CHANNELS; ++c )
+        output[ c ].assign( frames, 0.f );
+
+    for ( size_t offset = 0; offset < frames; offset += BLOCK_SIZE )
+    {
+        int blockFrames = ( int ) std::min(( size_t ) BLOCK_SIZE, frames - offset );
+
+        for ( int c = 0; c < AMOUNT_OF_CHANNELS; ++c ) {
+            inBuffer [ c ] = &input [ c ][ offset ];
+            outBuffer[ c ] = &output[ c ][ offset ];
+        }
+        process->setTempo( TEMPO );
+        process->setPosition(( double ) offset / sampleRate * TEMPO / 60.0 );
+        process->process<float>( inBuffer, outBuffer, AMOUNT_OF_CHANNELS, AMOUNT_OF_CHANNELS, blockFrames );
+    }
+    delete process;
+}
+
+// renders given stimulus through the ReverbProcess configured for given setting
+
+static bool render( const Setting& setting, Stimulus stimulus, int sampleRate, std::vector<float>* output )
+{
+    PluginState state;
+
+    if ( !applySetting( setting, state ))
+        return false;
+
+    render( state, stimulus, sampleRate, output );
+
+    return true;
+}
+
+// renders the noise stimulus through each preset of the bank at given path and requires
+// the render to differ from the render of the first (Init) preset, returns the amount of failures
+
+static int checkPresets( const std::string& path )
+{
+    PresetBank bank( path );
+    int amount = bank.getAmount();
+
+    if ( amount == 0 ) {
+        fprintf( stderr, "\"%s\" is not a valid preset bank\n", path.c_str() );
+        return 1;
+    }
+    const int sampleRate = 44100;
+    const float minDeviation = 1e-4f; // below this the difference is considered inaudible
+
+    std::vector<float> initOutput[ AMOUNT_OF_CHANNELS ];
+    std::vector<float> output[ AMOUNT_OF_CHANNELS ];
+    PluginState state;
+    char name[ PresetBank::NAME_LENGTH + 1 ];
+    int failures = 0;
+
+    bank.getPreset( 0, state );
+    render( state, NOISE, sampleRate, initOutput );
+
+    for ( int i = 1; i < amount; ++i )
+    {
+        PluginState presetState;
+        bank.getPreset( i, presetState );
+        bank.getName( i, name, sizeof( name ));
+        render( presetState, NOISE, sampleRate, output );
+
+        float deviation = 0.f;
+        for ( int c = 0; c < AMOUNT_OF_CHANNELS; ++c ) {
+            for ( size_t j = 0; j < output[ c ].size(); ++j )
+                deviation = std::max( deviation, std::abs( output[ c ][ j ] - initOutput[ c ][ j ] ));
+        }
+        bool passed = deviation >= minDeviation;
+
+        if ( !passed )
+            ++failures;
+
+        printf( "%s %-28s max deviation from Init %.3g\n", passed ? "PASS" : "FAIL", name, deviation );
+    }
+    printf( "%d of %d presets differ from Init\n", amount - 1 - failures, amount - 1 );
+
+    return failures;
+}
+
+static bool writeReference( const std::string& path, int sampleRate, std::vector<float>* output )
+{
+    WaveFile file;
+    size_t frames = output[ 0 ].size();
+
+    if ( !file.create( path, AMOUNT_OF_CHANNELS, sampleRate, WaveFile::FLOAT_32, frames ))
+        return false;
+
+    float* buffers[ AMOUNT_OF_CHANNELS ];
+    for ( int c = 0; c < AMOUNT_OF_CHANNELS; ++c )
+        buffers[ c ] = output[ c ].data();
+
+    file.write( buffers, 0, ( int ) frames );
+
+    return file.close( frames );
+}
+
+// compares the render against the reference at given path, returns whether it lies within the tolerance
+
+static bool verifyReference( const std::string& path, const Setting& setting, int sampleRate,
+                             std::vector<float>* output, bool exact, std::string& report )
+{
+    WaveFile file;
+
+    if ( !file.open( path )) {
+        report = "missing reference";
+        return false;
+    }
+    size_t frames = output[ 0 ].size();
+
+    if ( file.getFormat() != WaveFile::FLOAT_32 || file.getAmountOfChannels() != AMOUNT_OF_CHANNELS ||
+         file.getSampleRate() != sampleRate || file.getFrames() != frames ) {
+        report = "reference has a different format or length";
+        return false;
+    }
+    std::vector<float> reference[ AMOUNT_OF_CHANNELS ];
+    float* buffers[ AMOUNT_OF_CHANNELS ];
+
+    for ( int c = 0; c < AMOUNT_OF_CHANNELS; ++c ) {
+        reference[ c ].resize( frames );
+        buffers[ c ] = reference[ c ].data();
+    }
+    file.read( buffers, 0, ( int ) frames );
+    file.close();
+
+    double signal    = 0.0;
+    double noise     = 0.0;
+    float deviation  = 0.f;
+    bool isFinite    = true;
+
+    for ( int c = 0; c < AMOUNT_OF_CHANNELS; ++c ) {
+        for ( size_t i = 0; i < frames; ++i ) {
+            float difference = output[ c ][ i ] - reference[ c ][ i ];
+
+            isFinite  = isFinite && std::isfinite( output[ c ][ i ] );
+            deviation = std::max( deviation, std::abs( difference ));
+            signal   += ( double ) reference[ c ][ i ] * reference[ c ][ i ];
+            noise    += ( double ) difference * difference;
+        }
+    }
+    double snr = ( noise == 0.0 ) ? INFINITY : 10.0 * log10( signal / noise );
+
+    char buffer[ 128 ];
+    snprintf( buffer, sizeof( buffer ), "max deviation %.3g, SNR %.1f dB", deviation, snr );
+    report = buffer;
+
+    if ( !isFinite )
+        return false;
+
+    if ( exact || setting.maxDeviation == 0.f )
+        return deviation == 0.f;
+
+    return ( setting.maxDeviation == NO_MAX_DEVIATION || deviation <= setting.maxDeviation ) && snr >= setting.minSNR;
+}
+
+// calculates the fingerprint of a render: the RMS of each channel over consecutive windows
+
+static void calculateFingerprint( std::vector<float>* output, std::vector<float>& fingerprint )
+{
+    size_t windowFrames = output[ 0 ].size() / FINGERPRINT_WINDOWS;
+
+    fingerprint.clear();
+
+    for ( int c = 0; c < AMOUNT_OF_CHANNELS; ++c ) {
+        for ( int w = 0; w < FINGERPRINT_WINDOWS; ++w ) {
+            double sum = 0.0;
+            for ( size_t i = w * windowFrames, l = i + windowFrames; i < l; ++i )
+                sum += ( double ) output[ c ][ i ] * output[ c ][ i ];
+
+            fingerprint.push_back(( float ) sqrt( sum / windowFrames ));
+        }
+    }
+}
+
+// reads the fingerprints from given file, each line holding a case name followed by its
+// fingerprint (lines starting with a "#" are comments)
+
+static bool readFingerprints( const std::string& path, std::map<std::string, std::vector<float>>& fingerprints )
+{
+    FILE* file = fopen( path.c_str(), "r" );
+
+    if ( file == nullptr )
+        return false;
+
+    char name[ 128 ];
+
+    while ( fscanf( file, "%127s", name ) == 1 )
+    {
+        if ( name[ 0 ] == '#' ) {
+            fscanf( file, "%*[^\n]" );
+            continue;
+        }
+        std::vector<float>& fingerprint = fingerprints[ name ];
+        float value;
+
+        for ( int i = 0; i < FINGERPRINT_WINDOWS * AMOUNT_OF_CHANNELS && fscanf( file, "%f", &value ) == 1; ++i )
+            fingerprint.push_back( value );
+    }
+    fclose( file );
+
+    return true;
+}
+
+static bool writeFingerprint( FILE* file, const std::string& name, const std::vector<float>& fingerprint )
+{
+    fprintf( file, "%s", name.c_str() );
+
+    for ( float value : fingerprint )
+        fprintf( file, " %.9g", value ); // sufficient digits to restore the exact value
+
+    return fprintf( file, "\n" ) > 0;
+}
+
+// compares the fingerprint of a render against its reference, returns whether it lies within the tolerance
+
+static bool verifyFingerprint( const std::vector<float>& fingerprint, const std::vector<float>* reference,
+                               const Setting& setting, bool exact, std::string& report )
+{
+    if ( reference == nullptr || reference->size() != fingerprint.size() ) {
+        report = "missing fingerprint";
+        return false;
+    }
+    float peak      = 0.f;
+    float deviation = 0.f;
+    bool isFinite   = true;
+
+    for ( size_t i = 0; i < fingerprint.size(); ++i ) {
+        isFinite  = isFinite && std::isfinite( fingerprint[ i ] );
+        peak      = std::max( peak, ( *reference )[ i ] );
+        deviation = std::max( deviation, std::abs( fingerprint[ i ] - ( *reference )[ i ] ));
+    }
+    float tolerance = peak * ( float ) pow( 10.0, -setting.minSNR / 20.0 );
+
+    char buffer[ 128 ];
+    snprintf( buffer, sizeof( buffer ), "max window deviation %.3g (tolerance %.3g)", deviation, tolerance );
+    report = buffer;
+
+    if ( !isFinite )
+        return false;
+
+    if ( exact || setting.maxDeviation == 0.f )
+        return deviation == 0.f;
+
+    return deviation <= tolerance;
+}
+
+static void list()
+{
+    for ( int i = 0; i < SETTING_AMOUNT; ++i ) {
+        const Setting& setting = SETTINGS[ i ];
+
+        if ( setting.maxDeviation == 0.f )
+            printf( "%-14s bit-exact", setting.name );
+        else if ( setting.maxDeviation == NO_MAX_DEVIATION )
+            printf( "%-14s SNR >= %.f dB", setting.name, setting.minSNR );
+        else
+            printf( "%-14s max deviation %.0e, SNR >= %.f dB", setting.name, setting.maxDeviation, setting.minSNR );
+
+        printf( "  [%s]\n", setting.values[ 0 ] == '\0' ? "defaults" : setting.values );
+    }
+    printf( "stimuli: impulse, noise, sweep\nsample rates: 44100, 48000, 96000\n" );
+}
+
+// selects the kernels of given instruction set (the best supported when empty)
+
+static bool selectKernels( const std::string& name )
+{
+    if ( name.empty() ) {
+        Kernels::select();
+    }
+    else {
+        int isa = 0;
+        while ( isa < Kernels::ISA_AMOUNT && name != Kernels::ISA_NAMES[ isa ] )
+            ++isa;
+
+        if ( isa == Kernels::ISA_AMOUNT || !Kernels::select(( Kernels::ISA ) isa )) {
+            fprintf( stderr, "instruction set \"%s\" is not supported\n", name.c_str() );
+            return false;
+        }
+    }
+    printf( "using the %s kernels\n", Kernels::ISA_NAMES[ Kernels::getSelected() ] );
+
+    return true;
+}
+
+int main( int argc, char** argv )
+{
+    Options options;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        std::string argument = argv[ i ];
+        bool hasValue = ( i + 1 ) < argc;
+        Mode mode     = NONE;
+
+        if ( argument == "--write" )
+            mode = WRITE;
+        else if ( argument == "--verify" )
+            mode = VERIFY;
+        else if ( argument == "--write-fingerprints" )
+            mode = WRITE_FINGERPRINTS;
+        else if ( argument == "--verify-fingerprints" )
+            mode = VERIFY_FINGERPRINTS;
+        else if ( argument == "--check-presets" )
+            mode = CHECK_PRESETS;
+
+        if ( mode != NONE && hasValue && options.mode == NONE ) {
+            options.mode = mode;
+            options.path = argv[ ++i ];
+        }
+        else if ( argument == "--filter" && hasValue )
+            options.filter = argv[ ++i ];
+        else if ( argument == "--exact" )
+            options.exact = true;
+        else if ( argument == "--isa" && hasValue )
+            options.isa = argv[ ++i ];
+        else if ( argument == "--list" ) {
+            list();
+            return 0;
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if ( options.mode == NONE ) {
+        printUsage();
+        return 1;
+    }
+
+    if ( !selectKernels( options.isa ))
+        return 1;
+
+    if ( options.mode == CHECK_PRESETS )
+        return checkPresets( options.path ) == 0 ? 0 : 1;
+
+    bool isWriting = options.mode == WRITE || options.mode == WRITE_FINGERPRINTS;
+
+    if ( options.mode == WRITE && !createDirectory( options.path )) {
+        fprintf( stderr, "could not create directory \"%s\"\n", options.path.c_str() );
+        return 1;
+    }
+
+    FILE* fingerprintFile = nullptr;
+    std::map<std::string, std::vector<float>> referenceFingerprints;
+
+    if ( options.mode == WRITE_FINGERPRINTS ) {
+        fingerprintFile = fopen( options.path.c_str(), "w" );
+        if ( fingerprintFile == nullptr ) {
+            fprintf( stderr, "could not write \"%s\"\n", options.path.c_str() );
+            return 1;
+        }
+        fprintf( fingerprintFile, "# written by fogpad-golden --write-fingerprints, each line lists the RMS of %d windows\n"
+                                  "# of the left channel followed by those of the right channel\n", FINGERPRINT_WINDOWS );
+    }
+    else if ( options.mode == VERIFY_FINGERPRINTS && !readFingerprints( options.path, referenceFingerprints )) {
+        fprintf( stderr, "could not read \"%s\"\n", options.path.c_str() );
+        return 1;
+    }
+
+    int amount   = 0;
+    int failures = 0;
+
+    std::vector<float> output[ AMOUNT_OF_CHANNELS ];
+    std::vector<float> fingerprint;
+
+    for ( int s = 0; s < SETTING_AMOUNT; ++s ) {
+        for ( int stimulus = 0; stimulus < STIMULUS_AMOUNT; ++stimulus ) {
+            for ( int sampleRate : SAMPLE_RATES )
+            {
+                const Setting& setting = SETTINGS[ s ];
+                std::string name = getCaseName( setting, stimulus, sampleRate );
+
+                if ( !options.filter.empty() && name.find( options.filter ) == std::string::npos )
+                    continue;
+
+                if ( !render( setting, ( Stimulus ) stimulus, sampleRate, output ))
+                    return 1;
+
+                std::string path = options.path + "/" + name + ".wav";
+                std::string report;
+                bool passed = true;
+                ++amount;
+
+                switch ( options.mode )
+                {
+                    default:
+                    case WRITE:
+                        if ( !writeReference( path, sampleRate, output )) {
+                            fprintf( stderr, "could not write \"%s\"\n", path.c_str() );
+                            return 1;
+                        }
+                        break;
+
+                    case WRITE_FINGERPRINTS:
+                        calculateFingerprint( output, fingerprint );
+                        writeFingerprint( fingerprintFile, name, fingerprint );
+                        break;
+
+                    case VERIFY:
+                        passed = verifyReference( path, setting, sampleRate, output, options.exact, report );
+                        break;
+
+                    case VERIFY_FINGERPRINTS:
+                    {
+                        auto reference = referenceFingerprints.find( name );
+                        calculateFingerprint( output, fingerprint );
+                        passed = verifyFingerprint( fingerprint, reference == referenceFingerprints.end() ? nullptr : &reference->second,
+                                                    setting, options.exact, report );
+                        break;
+                    }
+                }
+
+                if ( isWriting ) {
+                    printf( "wrote %s\n", name.c_str() );
+                    continue;
+                }
+
+                if ( !passed )
+                    ++failures;
+
+                printf( "%s %-28s %s\n", passed ? "PASS" : "FAIL", name.c_str(), report.c_str() );
+            }
+        }
+    }
+
+    if ( fingerprintFile != nullptr && fclose( fingerprintFile ) != 0 ) {
+        fprintf( stderr, "could not write \"%s\"\n", options.path.c_str() );
+        return 1;
+    }
+
+    if ( amount == 0 ) {
+        fprintf( stderr, "no cases match \"%s\" (see --list)\n", options.filter.c_str() );
+        return 1;
+    }
+
+    if ( !isWriting )
+        printf( "%d of %d cases passed\n", amount - failures, amount );
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,359 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "global.h"
+#include "calc.h"
+#include "levelmeter.h"
+#include "pluginstate.h"
+#include "presetbank.h"
+#include "processmodel.h"
+#include "reverbprocess.h"
+#include "stageprofiler.h"
+#include "kernels/kernels.h"
+#include "parameternames.h"
+#include "wavefile.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace Igorski;
+
+/**
+ * fogpad-render applies the FogPad processing onto a WAV file without requiring a host.
+ * The input and output files are memory-mapped, the interleaved samples are converted into
+ * planar buffers that are processed in large blocks. After the input has been processed, the
+ * reverb tail is rendered until it has faded out (or the maximum tail duration has elapsed).
+ */
+
+static const int DEFAULT_BLOCK_SIZE     = 8192;
+static const float DEFAULT_TAIL_SECONDS = 10.f;
+static const double DEFAULT_TEMPO       = 120.0;
+static const float TAIL_SILENCE         = 0.00003f; // roughly -90 dB
+
+static void printUsage()
+{
+    fprintf( stderr,
+        "usage: fogpad-render [options] <input.wav> <output.wav>\n\n"
+        "  --preset <file>       preset bank to read the parameters from\n"
+        "  --program <index>     index (or name) of the preset within the bank (default 0)\n"
+        "  --set <name>=<value>  normalized (0 - 1) value of a parameter, applied after the preset\n"
+        "  --tail <seconds>      maximum duration of the reverb tail (default %.f)\n"
+        "  --block <frames>      amount of frames processed at once (default %d)\n"
+        "  --tempo <bpm>         tempo of the tempo synced oscillators (default %.f)\n"
+        "  --format <format>     output format: s16, s24, s32 or f32 (default: that of the input)\n"
+        "  --profile             reports the time spent in each processing stage\n"
+        "  --list                lists the parameter names and presets\n",
+        DEFAULT_TAIL_SECONDS, DEFAULT_BLOCK_SIZE, DEFAULT_TEMPO
+    );
+}
+
+static bool parseFormat( const char* value, WaveFile::Format& format )
+{
+    const char* names[] = { "s16", "s24", "s32", "f32" };
+
+    for ( int i = 0; i < 4; ++i ) {
+        if ( strcmp( value, names[ i ] ) == 0 ) {
+            format = ( WaveFile::Format ) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// applies the preset at given index (or with given name) of given bank onto given state
+
+static bool loadPreset( const char* path, const char* program, PluginState& state )
+{
+    PresetBank bank( path );
+
+    if ( bank.getAmount() == 0 ) {
+        fprintf( stderr, "could not read preset bank \"%s\"\n", path );
+        return false;
+    }
+    char* end;
+    int index = ( int ) strtol( program, &end, 10 );
+
+    if ( *end != '\0' ) {
+        char name[ PresetBank::NAME_LENGTH + 1 ];
+
+        for ( index = 0; index < bank.getAmount(); ++index ) {
+            if ( bank.getName( index, name, sizeof( name )) && strcmp( name, program ) == 0 )
+                break;
+        }
+    }
+
+    if ( !bank.getPreset( index, state )) {
+        fprintf( stderr, "preset bank \"%s\" contains no preset \"%s\"\n", path, program );
+        return false;
+    }
+    return true;
+}
+
+// prints the mean and 99th percentile of the time spent in each stage (in nanoseconds per frame)
+
+static void printProfile( const StageProfiler::Statistics& statistics )
+{
+    fprintf( stderr, "%-12s %12s %12s\n", "stage", "mean ns", "p99 ns" );
+
+    for ( int i = 0; i < StageProfiler::STAGE_AMOUNT; ++i ) {
+        StageProfiler::Stage stage = ( StageProfiler::Stage ) i;
+        fprintf( stderr, "%-12s %12.2f %12.2f\n", StageProfiler::STAGE_NAMES[ i ],
+                 statistics.getMean( stage ), statistics.getPercentile( stage, .99f ));
+    }
+    fprintf( stderr, "%-12s %12.2f %12.2f\n", "total", statistics.getTotalMean(), statistics.getTotalPercentile( .99f ));
+    fprintf( stderr, "(per frame, over the last %d blocks, using the %s kernels)\n", statistics.getAmount(),
+             Kernels::ISA_NAMES[ Kernels::getSelected() ] );
+}
+
+static void list( const char* presetPath )
+{
+    printf( "parameters:\n" );
+
+    for ( int i = 0; i < ParameterNames::AMOUNT; ++i )
+        printf( "  %-18s (default %.2f)\n", ParameterNames::ENTRIES[ i ].name,
+                ProcessModel::getDefault( ParameterNames::ENTRIES[ i ].id ));
+
+    if ( presetPath == nullptr )
+        return;
+
+    PresetBank bank( presetPath );
+    char name[ PresetBank::NAME_LENGTH + 1 ];
+
+    printf( "presets:\n" );
+
+    for ( int i = 0; i < bank.getAmount(); ++i ) {
+        if ( bank.getName( i, name, sizeof( name )))
+            printf( "  %2d %s\n", i, name );
+    }
+}
+
+int main( int argc, char** argv )
+{
+    const char* presetPath = nullptr;
+    const char* program    = "0";
+    const char* inputPath  = nullptr;
+    const char* outputPath = nullptr;
+    float tailSeconds      = DEFAULT_TAIL_SECONDS;
+    int blockSize          = DEFAULT_BLOCK_SIZE;
+    double tempo           = DEFAULT_TEMPO;
+    bool hasFormat         = false;
+    bool listOnly          = false;
+    bool profile           = false;
+    WaveFile::Format format = WaveFile::PCM_16;
+
+    std::vector<std::string> assignments;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        std::string argument = argv[ i ];
+        bool hasValue = ( i + 1 ) < argc;
+
+        if ( argument == "--preset" && hasValue )
+            presetPath = argv[ ++i ];
+        else if ( argument == "--program" && hasValue )
+            program = argv[ ++i ];
+        else if ( argument == "--set" && hasValue )
+            assignments.push_back( argv[ ++i ] );
+        else if ( argument == "--tail" && hasValue )
+            tailSeconds = std::max( 0.f, ( float ) atof( argv[ ++i ] ));
+        else if ( argument == "--block" && hasValue )
+            blockSize = std::max( 1, atoi( argv[ ++i ] ));
+        else if ( argument == "--tempo" && hasValue )
+            tempo = std::max( 1.0, atof( argv[ ++i ] ));
+        else if ( argument == "--format" && hasValue ) {
+            if ( !parseFormat( argv[ ++i ], format )) {
+                fprintf( stderr, "unsupported output format \"%s\"\n", argv[ i ] );
+                return 1;
+            }
+            hasFormat = true;
+        }
+        else if ( argument == "--profile" )
+            profile = true;
+        else if ( argument == "--list" )
+            listOnly = true;
+        else if ( argument.compare( 0, 2, "--" ) != 0 && inputPath == nullptr )
+            inputPath = argv[ i ];
+        else if ( argument.compare( 0, 2, "--" ) != 0 && outputPath == nullptr )
+            outputPath = argv[ i ];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if ( listOnly ) {
+        list( presetPath );
+        return 0;
+    }
+
+    if ( inputPath == nullptr || outputPath == nullptr ) {
+        printUsage();
+        return 1;
+    }
+
+    // collect the parameter values
+
+    PluginState state;
+
+    if ( presetPath != nullptr && !loadPreset( presetPath, program, state ))
+        return 1;
+
+    for ( const std::string& assignment : assignments )
+    {
+        size_t separator = assignment.find( '=' );
+        uint32_t paramId;
+
+        if ( separator == std::string::npos || !ParameterNames::getId( assignment.substr( 0, separator ).c_str(), paramId )) {
+            fprintf( stderr, "unknown parameter assignment \"%s\" (see --list)\n", assignment.c_str() );
+            return 1;
+        }
+        state.setValue( paramId, Calc::cap(( float ) atof( assignment.c_str() + separator + 1 )));
+    }
+
+    // open the input and create the output, able to hold the input and the maximum tail
+
+    WaveFile input;
+
+    if ( !input.open( inputPath )) {
+        fprintf( stderr, "could not read \"%s\" (expected 16, 24, 32-bit PCM or 32-bit float WAV)\n", inputPath );
+        return 1;
+    }
+    int amountOfChannels = input.getAmountOfChannels();
+    int sampleRate       = input.getSampleRate();
+    size_t inputFrames   = input.getFrames();
+    size_t tailFrames    = ( size_t )( tailSeconds * sampleRate );
+
+    if ( amountOfChannels > VST::MAX_CHANNELS ) {
+        fprintf( stderr, "\"%s\" has %d channels, at most %d are supported\n", inputPath, amountOfChannels, VST::MAX_CHANNELS );
+        return 1;
+    }
+
+    WaveFile output;
+
+    if ( !output.create( outputPath, amountOfChannels, sampleRate, hasFormat ? format : input.getFormat(), inputFrames + tailFrames )) {
+        fprintf( stderr, "could not create \"%s\"\n", outputPath );
+        return 1;
+    }
+
+    // offline rendering processes at the highest quality, unless explicitly set to eco
+
+    float quality = ProcessModel::getDefault( kQualityId );
+    state.getValue( kQualityId, quality );
+
+    VST::SAMPLE_RATE = ( float ) sampleRate;
+
+    Kernels::select();
+
+    ReverbProcess* process = new ReverbProcess( amountOfChannels, blockSize );
+    ProcessModel::apply( process, state, Calc::toIndex( quality, 3 ) == 1 ? VST::QUALITY_ECO : VST::QUALITY_HIGH );
+
+    StageProfiler::TimingsHistory* timingsHistory = new StageProfiler::TimingsHistory();
+    StageProfiler::Statistics* statistics         = new StageProfiler::Statistics();
+    StageProfiler::Timings timings;
+
+    process->profiler->setEnabled( profile );
+    process->profiler->setHistory( timingsHistory );
+
+    // the lookahead limiter delays the output, the first frames are discarded to compensate
+
+    size_t latency = ( size_t ) process->limiter->getLatencySamples();
+
+    std::vector<float> memory(( size_t ) amountOfChannels * blockSize * 2 );
+    float* inBuffer [ VST::MAX_CHANNELS ];
+    float* outBuffer[ VST::MAX_CHANNELS ];
+    float* writeBuffer[ VST::MAX_CHANNELS ];
+
+    for ( int c = 0; c < amountOfChannels; ++c ) {
+        inBuffer [ c ] = &memory[( size_t ) c * blockSize ];
+        outBuffer[ c ] = &memory[( size_t )( amountOfChannels + c ) * blockSize ];
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    size_t processed = 0; // frames provided to the process (including the silence rendering the tail)
+    size_t written   = 0; // frames written to the output
+    size_t maxFrames = inputFrames + latency + tailFrames;
+
+    while ( processed < maxFrames )
+    {
+        int frames = ( int ) std::min(( size_t ) blockSize, maxFrames - processed );
+
+        input.read( inBuffer, processed, frames );
+
+        process->setTempo( tempo );
+        process->setPosition(( double ) processed / sampleRate * tempo / 60.0 );
+        process->process<float>( inBuffer, outBuffer, amountOfChannels, amountOfChannels, frames );
+
+        while ( timingsHistory->pop( timings ))
+            statistics->add( timings );
+
+        int skip = ( int ) std::min(( size_t ) frames, latency - std::min( latency, processed ));
+
+        for ( int c = 0; c < amountOfChannels; ++c )
+            writeBuffer[ c ] = outBuffer[ c ] + skip;
+
+        output.write( writeBuffer, written, frames - skip );
+
+        written   += frames - skip;
+        processed += frames;
+
+        // once the input has been processed, stop when the tail has faded out
+
+        if ( processed >= inputFrames + latency )
+        {
+            float peak = 0.f;
+
+            for ( int c = 0; c < amountOfChannels; ++c ) {
+                float channelPeak = 0.f;
+                double sumOfSquares = 0.0;
+                LevelMeter::reduce( outBuffer[ c ], frames, channelPeak, sumOfSquares );
+                peak = std::max( peak, channelPeak );
+            }
+            if ( peak < TAIL_SILENCE )
+                break;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+    delete process;
+    input.close();
+
+    if ( !output.close( written )) {
+        fprintf( stderr, "could not write \"%s\"\n", outputPath );
+        return 1;
+    }
+
+    fprintf( stderr, "rendered %zu frames (%.2f seconds of audio) in %.3f seconds, %.1fx realtime\n",
+             written, ( double ) written / sampleRate, seconds, (( double ) processed / sampleRate ) / std::max( seconds, 1e-9 ));
+
+    if ( profile )
+        printProfile( *statistics );
+
+    delete statistics;
+    delete timingsHistory;
+
+    return 0;
+}
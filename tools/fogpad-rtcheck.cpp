@@ -0,0 +1,397 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "global.h"
+#include "calc.h"
+#include "pluginstate.h"
+#include "presetbank.h"
+#include "processmodel.h"
+#include "reverbprocess.h"
+#include "kernels/kernels.h"
+#include "parameternames.h"
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#if defined( __GLIBC__ )
+#include <dlfcn.h>
+#include <pthread.h>
+#define FOGPAD_INTERPOSE_LIBC 1
+#endif
+
+using namespace Igorski;
+
+/**
+ * fogpad-rtcheck verifies that the audio path is real-time safe: it processes a randomized
+ * automation stream (parameter changes, preset changes, varying block sizes, precisions and
+ * sidechain activity) the way FogPad::process() does, and fails when memory is allocated or
+ * freed, or a mutex is (un)locked while doing so.
+ *
+ * The global operator new and delete are replaced on all platforms. When running against glibc,
+ * malloc(), calloc(), realloc(), free() and the pthread mutex functions are interposed as well.
+ */
+
+enum Violation {
+    VIOLATION_NEW = 0,
+    VIOLATION_DELETE,
+    VIOLATION_MALLOC,
+    VIOLATION_FREE,
+    VIOLATION_MUTEX,
+    VIOLATION_AMOUNT
+};
+static const char* VIOLATION_NAMES[ VIOLATION_AMOUNT ] = {
+    "operator new", "operator delete", "malloc/calloc/realloc", "free", "mutex lock/unlock"
+};
+
+// the state of the checker is plain data, the hooks themselves must not allocate
+
+static volatile bool isRealtime = false;
+static long violations[ VIOLATION_AMOUNT ];
+static long firstViolationBlock = -1;
+static long currentBlock        = 0;
+
+static inline void registerViolation( Violation violation )
+{
+    if ( !isRealtime )
+        return;
+
+    ++violations[ violation ];
+
+    if ( firstViolationBlock < 0 )
+        firstViolationBlock = currentBlock;
+}
+
+// marks the scope of a block of the audio path
+
+struct RealtimeScope {
+    RealtimeScope()  { isRealtime = true; }
+    ~RealtimeScope() { isRealtime = false; }
+};
+
+/* replaced allocation functions */
+
+#ifdef FOGPAD_INTERPOSE_LIBC
+
+extern "C" {
+    void* __libc_malloc( size_t size );
+    void* __libc_calloc( size_t amount, size_t size );
+    void* __libc_realloc( void* pointer, size_t size );
+    void  __libc_free( void* pointer );
+
+    void* malloc( size_t size )
+    {
+        registerViolation( VIOLATION_MALLOC );
+        return __libc_malloc( size );
+    }
+
+    void* calloc( size_t amount, size_t size )
+    {
+        registerViolation( VIOLATION_MALLOC );
+        return __libc_calloc( amount, size );
+    }
+
+    void* realloc( void* pointer, size_t size )
+    {
+        registerViolation( VIOLATION_MALLOC );
+        return __libc_realloc( pointer, size );
+    }
+
+    void free( void* pointer )
+    {
+        if ( pointer != nullptr )
+            registerViolation( VIOLATION_FREE );
+
+        __libc_free( pointer );
+    }
+
+    // the mutex functions forward to the next definition (that of libc), resolved prior to checking
+
+    typedef int ( *MutexFunction )( pthread_mutex_t* );
+
+    static MutexFunction nextLock    = nullptr;
+    static MutexFunction nextTryLock = nullptr;
+    static MutexFunction nextUnlock  = nullptr;
+
+    int pthread_mutex_lock( pthread_mutex_t* mutex )
+    {
+        registerViolation( VIOLATION_MUTEX );
+        return nextLock( mutex );
+    }
+
+    int pthread_mutex_trylock( pthread_mutex_t* mutex )
+    {
+        registerViolation( VIOLATION_MUTEX );
+        return nextTryLock( mutex );
+    }
+
+    int pthread_mutex_unlock( pthread_mutex_t* mutex )
+    {
+        registerViolation( VIOLATION_MUTEX );
+        return nextUnlock( mutex );
+    }
+}
+
+static bool resolveMutexFunctions()
+{
+    nextLock    = ( MutexFunction ) dlsym( RTLD_NEXT, "pthread_mutex_lock" );
+    nextTryLock = ( MutexFunction ) dlsym( RTLD_NEXT, "pthread_mutex_trylock" );
+    nextUnlock  = ( MutexFunction ) dlsym( RTLD_NEXT, "pthread_mutex_unlock" );
+
+    return nextLock != nullptr && nextTryLock != nullptr && nextUnlock != nullptr;
+}
+
+static void* allocate( size_t size ) { return __libc_malloc( size == 0 ? 1 : size ); }
+static void release( void* pointer ) { __libc_free( pointer ); }
+
+#else
+
+static bool resolveMutexFunctions() { return true; }
+
+static void* allocate( size_t size ) { return malloc( size == 0 ? 1 : size ); }
+static void release( void* pointer ) { free( pointer ); }
+
+#endif
+
+void* operator new( size_t size )
+{
+    registerViolation( VIOLATION_NEW );
+
+    void* pointer = allocate( size );
+    if ( pointer == nullptr )
+        throw std::bad_alloc();
+
+    return pointer;
+}
+
+void* operator new[]( size_t size )
+{
+    return operator new( size );
+}
+
+void* operator new( size_t size, const std::nothrow_t& ) noexcept
+{
+    registerViolation( VIOLATION_NEW );
+    return allocate( size );
+}
+
+void* operator new[]( size_t size, const std::nothrow_t& ) noexcept
+{
+    registerViolation( VIOLATION_NEW );
+    return allocate( size );
+}
+
+void operator delete( void* pointer ) noexcept
+{
+    if ( pointer != nullptr )
+        registerViolation( VIOLATION_DELETE );
+
+    release( pointer );
+}
+
+void operator delete[]( void* pointer ) noexcept                         { operator delete( pointer ); }
+void operator delete( void* pointer, size_t ) noexcept                   { operator delete( pointer ); }
+void operator delete[]( void* pointer, size_t ) noexcept                 { operator delete( pointer ); }
+void operator delete( void* pointer, const std::nothrow_t& ) noexcept    { operator delete( pointer ); }
+void operator delete[]( void* pointer, const std::nothrow_t& ) noexcept  { operator delete( pointer ); }
+
+/* automation */
+
+static const int DEFAULT_BLOCKS         = 20000;
+static const int DEFAULT_MAX_BLOCK_SIZE = 1024;
+static const int AMOUNT_OF_CHANNELS     = 6; // as allocated by FogPad::setupProcessing()
+static const int MAX_CHANGES            = 4; // maximum amount of parameter changes per block
+static const int BUFFER_CAPACITY        = 8192; // the capacity of each channel buffer (the maximum block size)
+
+// a linear congruential generator (the standard library engines are not guaranteed to be allocation free)
+
+static uint32_t seed = 1;
+
+static inline uint32_t getRandom( uint32_t range )
+{
+    seed = seed * 1664525u + 1013904223u;
+    return ( seed >> 8 ) % range;
+}
+
+static inline float randomValue()
+{
+    return ( float ) getRandom( 16777216 ) / 16777215.f;
+}
+
+static void printUsage()
+{
+    fprintf( stderr,
+        "usage: fogpad-rtcheck [options]\n\n"
+        "  --blocks <amount>     amount of processed blocks (default %d)\n"
+        "  --max-block <frames>  maximum block size, block sizes vary up to this size (default %d)\n"
+        "  --seed <value>        seed of the random automation (default 1)\n"
+        "  --preset <file>       preset bank to randomly apply program changes from\n",
+        DEFAULT_BLOCKS, DEFAULT_MAX_BLOCK_SIZE
+    );
+}
+
+// the per-block part of FogPad::process(): the parameter changes of the block are applied
+// onto the model, which is synchronized with the ReverbProcess, after which the audio is processed
+
+template <typename SampleType>
+static void processBlock( ReverbProcess* process, PluginState& model, const PresetBank* bank,
+                          std::vector<SampleType>& memory, int numInChannels, int numOutChannels,
+                          int bufferSize, bool hasSidechain )
+{
+    int changes = ( int ) getRandom( MAX_CHANGES + 1 );
+
+    for ( int i = 0; i < changes; ++i )
+    {
+        // program changes retain the bypass state (see FogPad::loadPreset())
+
+        if ( bank != nullptr && getRandom( 16 ) == 0 ) {
+            float bypass = 0.f;
+            model.getValue( kBypassId, bypass );
+            bank->getPreset(( int ) getRandom(( uint32_t ) bank->getAmount() ), model );
+            model.setValue( kBypassId, bypass );
+        }
+        else {
+            model.setValue( ParameterNames::ENTRIES[ getRandom( ParameterNames::AMOUNT ) ].id, randomValue() );
+        }
+        float quality = 0.f;
+        model.getValue( kQualityId, quality );
+        ProcessModel::apply( process, model, Calc::toIndex( quality, 3 ) == 2 ? VST::QUALITY_HIGH : VST::QUALITY_ECO );
+    }
+
+    SampleType* in[ VST::MAX_CHANNELS ], *out[ VST::MAX_CHANNELS ], *sidechain[ VST::MAX_CHANNELS ];
+
+    for ( int c = 0; c < AMOUNT_OF_CHANNELS; ++c ) {
+        in [ c ]       = &memory[( size_t ) c * BUFFER_CAPACITY ];
+        out[ c ]       = in [ c ] + BUFFER_CAPACITY * AMOUNT_OF_CHANNELS;
+        sidechain[ c ] = out[ c ] + BUFFER_CAPACITY * AMOUNT_OF_CHANNELS;
+    }
+
+    process->setTempo( 60.0 + getRandom( 120 ));
+    process->setPosition(( double ) currentBlock );
+    process->process<SampleType>( in, out, numInChannels, numOutChannels, bufferSize,
+                                  hasSidechain ? sidechain : nullptr, hasSidechain ? 2 : 0 );
+
+    // the output meters are read after processing
+
+    volatile float gainReduction = process->limiter->getLinearGR();
+    ( void ) gainReduction;
+}
+
+int main( int argc, char** argv )
+{
+    long blocks          = DEFAULT_BLOCKS;
+    int maxBlockSize     = DEFAULT_MAX_BLOCK_SIZE;
+    const char* presetPath = nullptr;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        std::string argument = argv[ i ];
+        bool hasValue = ( i + 1 ) < argc;
+
+        if ( argument == "--blocks" && hasValue )
+            blocks = std::max( 1L, atol( argv[ ++i ] ));
+        else if ( argument == "--max-block" && hasValue )
+            maxBlockSize = std::max( 1, std::min( BUFFER_CAPACITY, atoi( argv[ ++i ] )));
+        else if ( argument == "--seed" && hasValue )
+            seed = ( uint32_t ) strtoul( argv[ ++i ], nullptr, 10 );
+        else if ( argument == "--preset" && hasValue )
+            presetPath = argv[ ++i ];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if ( !resolveMutexFunctions() ) {
+        fprintf( stderr, "could not resolve the mutex functions\n" );
+        return 1;
+    }
+
+    // all memory is allocated up front (as in FogPad::setupProcessing())
+
+    PresetBank* bank = nullptr;
+
+    if ( presetPath != nullptr ) {
+        bank = new PresetBank( presetPath );
+
+        if ( bank->getAmount() == 0 ) {
+            fprintf( stderr, "could not read preset bank \"%s\"\n", presetPath );
+            return 1;
+        }
+    }
+
+    VST::SAMPLE_RATE = 44100.f;
+
+    Kernels::select();
+
+    ReverbProcess* process = new ReverbProcess( AMOUNT_OF_CHANNELS, maxBlockSize );
+    PluginState model;
+    ProcessModel::apply( process, model, VST::QUALITY_ECO );
+
+    size_t samples = ( size_t ) BUFFER_CAPACITY * AMOUNT_OF_CHANNELS * 3;
+    std::vector<float>  floatMemory ( samples );
+    std::vector<double> doubleMemory( samples );
+
+    for ( size_t i = 0; i < samples; ++i ) {
+        floatMemory[ i ]  = randomValue() - .5f;
+        doubleMemory[ i ] = floatMemory[ i ];
+    }
+
+    for ( currentBlock = 0; currentBlock < blocks; ++currentBlock )
+    {
+        // hosts may provide blocks of any size up to the maximum, with a varying amount of channels
+
+        int bufferSize     = 1 + ( int ) getRandom(( uint32_t ) maxBlockSize );
+        int numInChannels  = 1 + ( int ) getRandom( 2 );
+        int numOutChannels = 1 + ( int ) getRandom( 2 );
+        bool hasSidechain  = getRandom( 2 ) == 0;
+        bool isDouble      = getRandom( 4 ) == 0;
+
+        RealtimeScope scope;
+
+        if ( isDouble )
+            processBlock<double>( process, model, bank, doubleMemory, numInChannels, numOutChannels, bufferSize, hasSidechain );
+        else
+            processBlock<float>( process, model, bank, floatMemory, numInChannels, numOutChannels, bufferSize, hasSidechain );
+    }
+
+    delete process;
+    delete bank;
+
+    long total = 0;
+    for ( int i = 0; i < VIOLATION_AMOUNT; ++i )
+        total += violations[ i ];
+
+    if ( total == 0 ) {
+        printf( "processed %ld blocks without allocations or locks\n", blocks );
+        return 0;
+    }
+
+    printf( "the audio path is not real-time safe, first violation in block %ld:\n", firstViolationBlock );
+
+    for ( int i = 0; i < VIOLATION_AMOUNT; ++i ) {
+        if ( violations[ i ] > 0 )
+            printf( "  %-22s %ld calls\n", VIOLATION_NAMES[ i ], violations[ i ] );
+    }
+    return 1;
+}
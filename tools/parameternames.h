@@ -0,0 +1,82 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __PARAMETERNAMES_H_INCLUDED__
+#define __PARAMETERNAMES_H_INCLUDED__
+
+#include "paramids.h"
+#include <stdint.h>
+#include <string.h>
+
+namespace Igorski {
+namespace ParameterNames {
+
+    // the names by which the command line tools address the plugin parameters
+
+    struct Entry {
+        const char* name;
+        uint32_t id;
+    };
+
+    static const int AMOUNT = 23;
+    static const Entry ENTRIES[ AMOUNT ] = {
+        { "size",                kReverbSizeId },
+        { "width",               kReverbWidthId },
+        { "dry",                 kReverbDryMixId },
+        { "wet",                 kReverbWetMixId },
+        { "freeze",              kReverbFreezeId },
+        { "wobble",              kReverbPlaybackRateId },
+        { "bits",                kBitResolutionId },
+        { "bits-chain",          kBitResolutionChainId },
+        { "bits-lfo",            kLFOBitResolutionId },
+        { "bits-lfo-depth",      kLFOBitResolutionDepthId },
+        { "bits-lfo-shape",      kLFOBitResolutionShapeId },
+        { "bits-lfo-sync",       kLFOBitResolutionSyncId },
+        { "decimator",           kDecimatorId },
+        { "cutoff",              kFilterCutoffId },
+        { "resonance",           kFilterResonanceId },
+        { "filter-lfo",          kLFOFilterId },
+        { "filter-lfo-depth",    kLFOFilterDepthId },
+        { "filter-lfo-shape",    kLFOFilterShapeId },
+        { "filter-lfo-sync",     kLFOFilterSyncId },
+        { "lookahead",           kLimiterLookaheadId },
+        { "bypass",              kBypassId },
+        { "quality",             kQualityId },
+        { "duck",                kSidechainDuckId }
+    };
+
+    // retrieves the id of the parameter with given name, returns false when it doesn't exist
+
+    inline bool getId( const char* name, uint32_t& id )
+    {
+        for ( int i = 0; i < AMOUNT; ++i ) {
+            if ( strcmp( ENTRIES[ i ].name, name ) == 0 ) {
+                id = ENTRIES[ i ].id;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+}
+
+#endif
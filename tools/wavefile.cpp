@@ -0,0 +1,440 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "wavefile.h"
+#include "byteorder.h"
+#include <algorithm>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Igorski {
+
+using namespace ByteOrder;
+
+static const uint16_t FORMAT_PCM        = 1;
+static const uint16_t FORMAT_IEEE_FLOAT = 3;
+static const uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+
+/* constructor / destructor */
+
+WaveFile::WaveFile()
+{
+    _data             = nullptr;
+    _size             = 0;
+    _handle           = nullptr;
+    _writable         = false;
+    _samples          = nullptr;
+    _frames           = 0;
+    _amountOfChannels = 0;
+    _sampleRate       = 0;
+    _format           = PCM_16;
+}
+
+WaveFile::~WaveFile()
+{
+    close( _frames );
+}
+
+/* public methods */
+
+bool WaveFile::open( const std::string& path )
+{
+    close();
+
+    if ( !map( path, 0, false ))
+        return false;
+
+    if ( !parse() ) {
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+bool WaveFile::create( const std::string& path, int amountOfChannels, int sampleRate, Format format, size_t maxFrames )
+{
+    close();
+
+    if ( amountOfChannels <= 0 || sampleRate <= 0 )
+        return false;
+
+    size_t frameSize = ( size_t ) amountOfChannels * getSampleSize( format );
+
+    if ( !map( path, HEADER_SIZE + maxFrames * frameSize, true ))
+        return false;
+
+    _samples          = _data + HEADER_SIZE;
+    _frames           = maxFrames;
+    _amountOfChannels = amountOfChannels;
+    _sampleRate       = sampleRate;
+    _format           = format;
+
+    return true;
+}
+
+bool WaveFile::close( size_t frames )
+{
+    if ( _data == nullptr )
+        return false;
+
+    if ( !_writable ) {
+        unmap();
+        return true;
+    }
+
+    // finalize the header for the written amount of frames
+
+    frames = std::min( frames, _frames );
+
+    uint16_t sampleSize = ( uint16_t ) getSampleSize( _format );
+    uint16_t blockAlign = ( uint16_t )( sampleSize * _amountOfChannels );
+    uint32_t dataSize   = ( uint32_t )( frames * blockAlign );
+
+    memcpy( _data, "RIFF", 4 );
+    writeUint32( _data + 4, 36 + dataSize );
+    memcpy( _data + 8, "WAVEfmt ", 8 );
+    writeUint32( _data + 16, 16 );
+    writeUint16( _data + 20, _format == FLOAT_32 ? FORMAT_IEEE_FLOAT : FORMAT_PCM );
+    writeUint16( _data + 22, ( uint16_t ) _amountOfChannels );
+    writeUint32( _data + 24, ( uint32_t ) _sampleRate );
+    writeUint32( _data + 28, ( uint32_t ) _sampleRate * blockAlign );
+    writeUint16( _data + 32, blockAlign );
+    writeUint16( _data + 34, ( uint16_t )( sampleSize * 8 ));
+    memcpy( _data + 36, "data", 4 );
+    writeUint32( _data + 40, dataSize );
+
+    std::string path = _path;
+    unmap();
+
+    // truncate the file to the written size
+
+    size_t size = HEADER_SIZE + ( size_t ) dataSize;
+#ifdef _WIN32
+    HANDLE file = CreateFileA( path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+    if ( file == INVALID_HANDLE_VALUE )
+        return false;
+
+    LARGE_INTEGER position;
+    position.QuadPart = ( LONGLONG ) size;
+
+    bool truncated = SetFilePointerEx( file, position, nullptr, FILE_BEGIN ) && SetEndOfFile( file );
+    CloseHandle( file );
+
+    return truncated;
+#else
+    return truncate( path.c_str(), ( off_t ) size ) == 0;
+#endif
+}
+
+int WaveFile::getAmountOfChannels() const
+{
+    return _amountOfChannels;
+}
+
+int WaveFile::getSampleRate() const
+{
+    return _sampleRate;
+}
+
+WaveFile::Format WaveFile::getFormat() const
+{
+    return _format;
+}
+
+size_t WaveFile::getFrames() const
+{
+    return _frames;
+}
+
+void WaveFile::read( float** buffers, size_t offset, int frames ) const
+{
+    int available = ( int ) std::max(( int64_t ) 0, std::min(( int64_t ) frames, ( int64_t ) _frames - ( int64_t ) offset ));
+    int sampleSize = getSampleSize( _format );
+
+    for ( int c = 0; c < _amountOfChannels; ++c )
+    {
+        float* buffer      = buffers[ c ];
+        const char* source = _samples + ( offset * _amountOfChannels + c ) * sampleSize;
+        size_t stride      = ( size_t ) _amountOfChannels * sampleSize;
+        int i = 0;
+
+        switch ( _format )
+        {
+            case PCM_16:
+                for ( ; i < available; ++i, source += stride )
+                    buffer[ i ] = ( float )( int16_t ) readUint16( source ) / 32768.f;
+                break;
+
+            case PCM_24:
+                for ( ; i < available; ++i, source += stride ) {
+                    int32_t sample = ( int32_t )(( uint32_t )( unsigned char ) source[ 0 ] << 8  |
+                                                 ( uint32_t )( unsigned char ) source[ 1 ] << 16 |
+                                                 ( uint32_t )( unsigned char ) source[ 2 ] << 24 );
+                    buffer[ i ] = ( float )( sample >> 8 ) / 8388608.f;
+                }
+                break;
+
+            case PCM_32:
+                for ( ; i < available; ++i, source += stride )
+                    buffer[ i ] = ( float )(( double )( int32_t ) readUint32( source ) / 2147483648.0 );
+                break;
+
+            case FLOAT_32:
+                for ( ; i < available; ++i, source += stride )
+                    buffer[ i ] = readFloat( source );
+                break;
+        }
+        // frames beyond the end of the file are silent (e.g. when rendering the tail)
+        std::fill( buffer + i, buffer + frames, 0.f );
+    }
+}
+
+void WaveFile::write( float** buffers, size_t offset, int frames )
+{
+    if ( !_writable || offset >= _frames )
+        return;
+
+    frames = ( int ) std::min(( size_t ) frames, _frames - offset );
+
+    int sampleSize = getSampleSize( _format );
+
+    for ( int c = 0; c < _amountOfChannels; ++c )
+    {
+        const float* buffer = buffers[ c ];
+        char* target        = _samples + ( offset * _amountOfChannels + c ) * sampleSize;
+        size_t stride       = ( size_t ) _amountOfChannels * sampleSize;
+
+        switch ( _format )
+        {
+            case PCM_16:
+                for ( int i = 0; i < frames; ++i, target += stride ) {
+                    float sample = std::min( 1.f, std::max( -1.f, buffer[ i ] ));
+                    writeUint16( target, ( uint16_t )( int16_t ) std::min( 32767.f, sample * 32768.f ));
+                }
+                break;
+
+            case PCM_24:
+                for ( int i = 0; i < frames; ++i, target += stride ) {
+                    float sample = std::min( 1.f, std::max( -1.f, buffer[ i ] ));
+                    int32_t value = ( int32_t ) std::min( 8388607.f, sample * 8388608.f );
+                    target[ 0 ] = ( char )( value & 0xFF );
+                    target[ 1 ] = ( char )(( value >> 8 ) & 0xFF );
+                    target[ 2 ] = ( char )(( value >> 16 ) & 0xFF );
+                }
+                break;
+
+            case PCM_32:
+                for ( int i = 0; i < frames; ++i, target += stride ) {
+                    double sample = std::min( 1.0, std::max( -1.0, ( double ) buffer[ i ] ));
+                    writeUint32( target, ( uint32_t )( int32_t ) std::min( 2147483647.0, sample * 2147483648.0 ));
+                }
+                break;
+
+            case FLOAT_32:
+                for ( int i = 0; i < frames; ++i, target += stride )
+                    writeFloat( target, buffer[ i ] );
+                break;
+        }
+    }
+}
+
+int WaveFile::getSampleSize( Format format )
+{
+    switch ( format )
+    {
+        default:
+        case PCM_16:
+            return 2;
+        case PCM_24:
+            return 3;
+        case PCM_32:
+        case FLOAT_32:
+            return 4;
+    }
+}
+
+/* private methods */
+
+bool WaveFile::map( const std::string& path, size_t size, bool writable )
+{
+#ifdef _WIN32
+    HANDLE file = writable ?
+        CreateFileA( path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr ) :
+        CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+
+    if ( file == INVALID_HANDLE_VALUE )
+        return false;
+
+    if ( !writable ) {
+        LARGE_INTEGER fileSize;
+        size = GetFileSizeEx( file, &fileSize ) ? ( size_t ) fileSize.QuadPart : 0;
+    }
+
+    // a writable mapping extends the file to the requested size
+
+    HANDLE mapping = nullptr;
+
+    if ( size > 0 )
+        mapping = CreateFileMappingA( file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                      ( DWORD )(( uint64_t ) size >> 32 ), ( DWORD )( size & 0xFFFFFFFF ), nullptr );
+    CloseHandle( file );
+
+    if ( mapping == nullptr )
+        return false;
+
+    _data = ( char* ) MapViewOfFile( mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0 );
+
+    if ( _data == nullptr ) {
+        CloseHandle( mapping );
+        return false;
+    }
+    _handle = mapping;
+#else
+    int file = writable ? ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 ) : ::open( path.c_str(), O_RDONLY );
+
+    if ( file < 0 )
+        return false;
+
+    struct stat fileInfo;
+
+    if ( writable ) {
+        if ( ftruncate( file, ( off_t ) size ) != 0 ) {
+            ::close( file );
+            return false;
+        }
+    }
+    else {
+        size = ( fstat( file, &fileInfo ) == 0 ) ? ( size_t ) fileInfo.st_size : 0;
+    }
+
+    void* data = MAP_FAILED;
+
+    if ( size > 0 )
+        data = mmap( nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0 );
+
+    ::close( file );
+
+    if ( data == MAP_FAILED )
+        return false;
+
+    // the input is read front to back, the kernel can read ahead aggressively
+    madvise( data, size, MADV_SEQUENTIAL );
+
+    _data = ( char* ) data;
+#endif
+    _path     = path;
+    _size     = size;
+    _writable = writable;
+
+    return true;
+}
+
+void WaveFile::unmap()
+{
+    if ( _data != nullptr ) {
+#ifdef _WIN32
+        UnmapViewOfFile( _data );
+        CloseHandle(( HANDLE ) _handle );
+#else
+        munmap( _data, _size );
+#endif
+    }
+    _data     = nullptr;
+    _handle   = nullptr;
+    _size     = 0;
+    _samples  = nullptr;
+    _frames   = 0;
+    _writable = false;
+}
+
+bool WaveFile::parse()
+{
+    if ( _size < 12 || memcmp( _data, "RIFF", 4 ) != 0 || memcmp( _data + 8, "WAVE", 4 ) != 0 )
+        return false;
+
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t sampleRate = 0;
+    const char* samples = nullptr;
+    size_t dataSize     = 0;
+    size_t position     = 12;
+
+    // walk the chunks (which are padded to an even size)
+
+    while ( position + 8 <= _size )
+    {
+        const char* chunk  = _data + position;
+        size_t chunkSize   = readUint32( chunk + 4 );
+        size_t available   = _size - position - 8;
+
+        if ( memcmp( chunk, "fmt ", 4 ) == 0 && chunkSize >= 16 && available >= 16 )
+        {
+            format     = readUint16( chunk + 8 );
+            channels   = readUint16( chunk + 10 );
+            sampleRate = readUint32( chunk + 12 );
+            bits       = readUint16( chunk + 22 );
+
+            // the extensible format specifies the actual format in its sub format identifier
+
+            if ( format == FORMAT_EXTENSIBLE && chunkSize >= 40 && available >= 40 )
+                format = readUint16( chunk + 32 );
+        }
+        else if ( memcmp( chunk, "data", 4 ) == 0 )
+        {
+            samples  = chunk + 8;
+            dataSize = std::min( chunkSize, available ); // tolerate truncated files
+            break;
+        }
+        position += 8 + chunkSize + ( chunkSize & 1 );
+    }
+
+    if ( samples == nullptr || channels == 0 || sampleRate == 0 )
+        return false;
+
+    if ( format == FORMAT_PCM && bits == 16 )
+        _format = PCM_16;
+    else if ( format == FORMAT_PCM && bits == 24 )
+        _format = PCM_24;
+    else if ( format == FORMAT_PCM && bits == 32 )
+        _format = PCM_32;
+    else if ( format == FORMAT_IEEE_FLOAT && bits == 32 )
+        _format = FLOAT_32;
+    else
+        return false;
+
+    _samples          = ( char* ) samples;
+    _amountOfChannels = channels;
+    _sampleRate       = ( int ) sampleRate;
+    _frames           = dataSize / (( size_t ) channels * getSampleSize( _format ));
+
+    return true;
+}
+
+}
@@ -0,0 +1,108 @@
+/**
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2019 Igor Zinken - https://www.igorski.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __WAVEFILE_H_INCLUDED__
+#define __WAVEFILE_H_INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Igorski {
+
+/**
+ * WaveFile provides memory-mapped access to the sample data of a RIFF WAVE file. Existing files
+ * are mapped read-only, created files are mapped read-write at their maximum size (the file is
+ * truncated to the amount of written frames when closed). Samples are converted between the
+ * interleaved file format and planar float buffers, as processed by ReverbProcess.
+ *
+ * Supported formats are 16, 24 and 32-bit integer PCM and 32-bit floating point.
+ */
+class WaveFile {
+
+    public:
+        enum Format {
+            PCM_16 = 0,
+            PCM_24,
+            PCM_32,
+            FLOAT_32
+        };
+
+        WaveFile();
+        ~WaveFile();
+
+        // maps an existing file, returns false when it cannot be read or has an unsupported format
+
+        bool open( const std::string& path );
+
+        // creates (or overwrites) a file able to hold given amount of frames
+
+        bool create( const std::string& path, int amountOfChannels, int sampleRate, Format format, size_t maxFrames );
+
+        // unmaps the file, a created file is truncated to given amount of
+        // frames (clamped to the maximum amount) and its header is finalized
+
+        bool close( size_t frames = 0 );
+
+        int getAmountOfChannels() const;
+        int getSampleRate() const;
+        Format getFormat() const;
+        size_t getFrames() const;
+
+        // converts given amount of frames starting at given offset into the planar buffers
+        // (one per channel). Frames beyond the end of the file are read as silence
+
+        void read( float** buffers, size_t offset, int frames ) const;
+
+        // converts given amount of frames from the planar buffers into the file at given offset
+        // (clipping integer formats at full scale). Frames beyond the maximum size are discarded
+
+        void write( float** buffers, size_t offset, int frames );
+
+        // the size of a sample of given format in bytes
+
+        static int getSampleSize( Format format );
+
+    private:
+        static const int HEADER_SIZE = 44; // the header of created files
+
+        std::string _path;
+        char* _data;          // the mapping of the whole file
+        size_t _size;
+        void* _handle;        // platform specific handle of the mapping
+        bool _writable;
+
+        char* _samples;       // the start of the sample data within the mapping
+        size_t _frames;
+        int _amountOfChannels;
+        int _sampleRate;
+        Format _format;
+
+        bool map( const std::string& path, size_t size, bool writable );
+        void unmap();
+
+        // locates the format and data chunks of a mapped file
+        bool parse();
+};
+}
+
+#endif